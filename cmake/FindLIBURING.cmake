@@ -0,0 +1,31 @@
+# - Try to find liburing
+# Once done this will define
+#  LIBURING_FOUND - System has liburing
+#  LIBURING_INCLUDE_DIRS - The liburing include directories
+#  LIBURING_LIBRARIES - The libraries needed to use liburing
+
+FIND_PATH(WITH_LIBURING_PREFIX
+        NAMES include/liburing.h
+        )
+
+FIND_LIBRARY(LIBURING_LIBRARIES
+        NAMES liburing.so
+        HINTS ${WITH_LIBURING_PREFIX}/lib
+        )
+
+FIND_PATH(LIBURING_INCLUDE_DIRS
+        NAMES liburing.h
+        HINTS ${WITH_LIBURING_PREFIX}/include
+        )
+
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LIBURING DEFAULT_MSG
+        LIBURING_LIBRARIES
+        LIBURING_INCLUDE_DIRS
+        )
+
+# Hide these vars from ccmake GUI
+MARK_AS_ADVANCED(
+        LIBURING_LIBRARIES
+        LIBURING_INCLUDE_DIRS
+)
\ No newline at end of file
@@ -0,0 +1,242 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+Written by Mark C. Miller
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <macsio_agg.h>
+#include <macsio_log.h>
+
+/*!
+\addtogroup MACSIO_AGG
+@{
+*/
+
+#ifdef HAVE_MPI
+
+/*! \brief Alignment of piece data within a segment */
+#define MACSIO_AGG_ALIGN 64
+
+#define MACSIO_AGG_ROUNDUP(N) ((((N) + MACSIO_AGG_ALIGN - 1) / MACSIO_AGG_ALIGN) * MACSIO_AGG_ALIGN)
+
+/*! \brief Header at the start of each task's segment of the shared window */
+typedef struct _MACSIO_AGG_header_t
+{
+    int npieces;                /**< Number of pieces placed so far */
+    int maxPieces;              /**< Room for this many piece descriptors */
+    size_t dataOffset;          /**< Offset of the data area from the start of the segment */
+    size_t dataUsed;            /**< Bytes of the data area used so far */
+    size_t dataSize;            /**< Size of the data area */
+} MACSIO_AGG_header_t;
+
+/*! \struct _MACSIO_AGG_t */
+typedef struct _MACSIO_AGG_t
+{
+    MPI_Comm nodeComm;          /**< Tasks of the parent comm on this node */
+    MPI_Comm writerComm;        /**< One task per node or MPI_COMM_NULL on non-writers */
+    MPI_Win win;                /**< The shared memory window */
+    int nodeRank;               /**< Rank of this task on the node */
+    int nodeSize;               /**< Number of tasks on the node */
+    char *mySeg;                /**< This task's segment of the window */
+    char **segs;                /**< On writers, every node-local task's segment */
+} MACSIO_AGG_t;
+
+MACSIO_AGG_t *
+MACSIO_AGG_Init(
+    MPI_Comm comm,
+    int maxPieces,
+    size_t nbytes
+)
+{
+    int i, rankInComm;
+    MPI_Aint segSize;
+    MACSIO_AGG_header_t *hdr;
+    MACSIO_AGG_t *ret = (MACSIO_AGG_t *) calloc(1, sizeof(MACSIO_AGG_t));
+
+    MPI_Comm_rank(comm, &rankInComm);
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rankInComm, MPI_INFO_NULL, &ret->nodeComm);
+    MPI_Comm_rank(ret->nodeComm, &ret->nodeRank);
+    MPI_Comm_size(ret->nodeComm, &ret->nodeSize);
+
+    /* Lowest rank on each node is the node's writer */
+    MPI_Comm_split(comm, ret->nodeRank == 0 ? 0 : MPI_UNDEFINED, rankInComm, &ret->writerComm);
+
+    /* Each piece's data starts aligned, so each may waste up to ALIGN-1 bytes */
+    segSize = (MPI_Aint) (MACSIO_AGG_ROUNDUP(sizeof(MACSIO_AGG_header_t) +
+                                             maxPieces * sizeof(MACSIO_AGG_piece_t)) +
+                          MACSIO_AGG_ROUNDUP(nbytes) + maxPieces * (MACSIO_AGG_ALIGN - 1));
+    mpi_errno = MPI_Win_allocate_shared(segSize, 1, MPI_INFO_NULL, ret->nodeComm,
+                                        &ret->mySeg, &ret->win);
+    if (mpi_errno != MPI_SUCCESS)
+        MACSIO_LOG_MSG(Die, ("Unable to allocate shared window of %lld bytes", (long long) segSize));
+
+    hdr = (MACSIO_AGG_header_t *) ret->mySeg;
+    hdr->npieces = 0;
+    hdr->maxPieces = maxPieces;
+    hdr->dataOffset = MACSIO_AGG_ROUNDUP(sizeof(MACSIO_AGG_header_t) +
+                                         maxPieces * sizeof(MACSIO_AGG_piece_t));
+    hdr->dataUsed = 0;
+    hdr->dataSize = (size_t) segSize - hdr->dataOffset;
+
+    /* Writers need direct pointers into every node-local segment */
+    if (ret->nodeRank == 0)
+    {
+        ret->segs = (char **) malloc(ret->nodeSize * sizeof(char *));
+        for (i = 0; i < ret->nodeSize; i++)
+        {
+            MPI_Aint size;
+            int disp_unit;
+            MPI_Win_shared_query(ret->win, i, &size, &disp_unit, &ret->segs[i]);
+        }
+    }
+
+    /* Passive target epoch lasts for the life of the window */
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, ret->win);
+
+    return ret;
+}
+
+MPI_Comm
+MACSIO_AGG_WriterComm(
+    MACSIO_AGG_t const *agg
+)
+{
+    return agg->writerComm;
+}
+
+int
+MACSIO_AGG_AddPiece(
+    MACSIO_AGG_t *agg,
+    int id,
+    int ndims,
+    long long const *starts,
+    long long const *counts,
+    void const *buf,
+    size_t nbytes
+)
+{
+    int i;
+    MACSIO_AGG_header_t *hdr = (MACSIO_AGG_header_t *) agg->mySeg;
+    MACSIO_AGG_piece_t *piece = (MACSIO_AGG_piece_t *) (agg->mySeg + sizeof(MACSIO_AGG_header_t));
+
+    if (hdr->npieces >= hdr->maxPieces || hdr->dataUsed + nbytes > hdr->dataSize)
+        return 1;
+
+    piece += hdr->npieces;
+    piece->id = id;
+    piece->ndims = ndims;
+    for (i = 0; i < 3; i++)
+    {
+        piece->starts[i] = i < ndims ? starts[i] : 0;
+        piece->counts[i] = i < ndims ? counts[i] : 1;
+    }
+    piece->offset = hdr->dataOffset + hdr->dataUsed;
+    piece->nbytes = nbytes;
+    if (buf && nbytes)
+        memcpy(agg->mySeg + piece->offset, buf, nbytes);
+
+    hdr->dataUsed += MACSIO_AGG_ROUNDUP(nbytes);
+    hdr->npieces++;
+
+    return 0;
+}
+
+void
+MACSIO_AGG_Sync(
+    MACSIO_AGG_t *agg
+)
+{
+    MPI_Win_sync(agg->win);
+    MPI_Barrier(agg->nodeComm);
+    MPI_Win_sync(agg->win);
+}
+
+int
+MACSIO_AGG_IsWriter(
+    MACSIO_AGG_t const *agg
+)
+{
+    return agg->nodeRank == 0;
+}
+
+int
+MACSIO_AGG_NodeSize(
+    MACSIO_AGG_t const *agg
+)
+{
+    return agg->nodeSize;
+}
+
+MACSIO_AGG_piece_t const *
+MACSIO_AGG_GetPieces(
+    MACSIO_AGG_t const *agg,
+    int nodeRank,
+    int *npieces
+)
+{
+    char const *seg;
+
+    *npieces = 0;
+    if (!agg->segs || nodeRank < 0 || nodeRank >= agg->nodeSize)
+        return 0;
+
+    seg = agg->segs[nodeRank];
+    *npieces = ((MACSIO_AGG_header_t const *) seg)->npieces;
+    return (MACSIO_AGG_piece_t const *) (seg + sizeof(MACSIO_AGG_header_t));
+}
+
+void const *
+MACSIO_AGG_PieceData(
+    MACSIO_AGG_t const *agg,
+    int nodeRank,
+    MACSIO_AGG_piece_t const *piece
+)
+{
+    if (!agg->segs || nodeRank < 0 || nodeRank >= agg->nodeSize)
+        return 0;
+    return agg->segs[nodeRank] + piece->offset;
+}
+
+void
+MACSIO_AGG_Finish(
+    MACSIO_AGG_t *agg
+)
+{
+    /* Keep every segment alive until the node's writer is done with it */
+    MPI_Barrier(agg->nodeComm);
+    MPI_Win_unlock_all(agg->win);
+    MPI_Win_free(&agg->win);
+    if (agg->writerComm != MPI_COMM_NULL)
+        MPI_Comm_free(&agg->writerComm);
+    MPI_Comm_free(&agg->nodeComm);
+    free(agg->segs);
+    free(agg);
+}
+
+#endif /* #ifdef HAVE_MPI */
+
+/*!@}*/
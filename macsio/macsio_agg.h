@@ -0,0 +1,203 @@
+#ifndef _MACSIO_AGG_H
+#define _MACSIO_AGG_H
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+Written by Mark C. Miller
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include <stdlib.h>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+\defgroup MACSIO_AGG MACSIO_AGG
+\brief Node-level aggregation of data through MPI shared memory windows
+
+Ranks on the same node place the data they would otherwise write (or send to
+an aggregator) into their segment of an MPI-3 shared memory window. One rank
+per node, the \em writer, then reads every node-local segment directly and
+issues the I/O on behalf of the whole node. Only writers participate in the
+I/O itself and they do so over a reduced communicator holding one rank per node.
+
+Each piece of data placed in the window is described by a small, fixed size
+record holding its plugin-defined identifier and its logical placement (e.g. a
+hyperslab in a global array). The writer uses these records to issue the I/O.
+
+The basic coding structure is as follows...
+
+\code
+    MACSIO_AGG_t *agg = MACSIO_AGG_Init(comm, npieces, nbytes);
+    for (each piece of data this rank has)
+        MACSIO_AGG_AddPiece(agg, id, ndims, starts, counts, buf, piece_nbytes);
+    MACSIO_AGG_Sync(agg);
+    if (MACSIO_AGG_IsWriter(agg))
+    {
+        for (i = 0; i < MACSIO_AGG_NodeSize(agg); i++)
+        {
+            MACSIO_AGG_piece_t const *pieces = MACSIO_AGG_GetPieces(agg, i, &n);
+            ... write MACSIO_AGG_PieceData(agg, i, &pieces[j]) over MACSIO_AGG_WriterComm(agg) ...
+        }
+    }
+    MACSIO_AGG_Finish(agg);
+\endcode
+
+@{
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Descriptor for one piece of data placed in the shared window */
+typedef struct _MACSIO_AGG_piece_t
+{
+    int id;                  /**< Plugin-defined identifier (e.g. variable index) */
+    int ndims;               /**< Number of logical dimensions of the piece */
+    long long starts[3];     /**< Logical starts of the piece (e.g. in a global array) */
+    long long counts[3];     /**< Logical counts of the piece */
+    size_t offset;           /**< Offset of the piece's data from the start of its owner's segment */
+    size_t nbytes;           /**< Size of the piece's data in bytes */
+} MACSIO_AGG_piece_t;
+
+/*! \brief Opaque struct holding private implementation of MACSIO_AGG_t */
+typedef struct _MACSIO_AGG_t MACSIO_AGG_t;
+
+/* Node-level aggregation requires MPI-3 shared memory windows */
+#ifdef HAVE_MPI
+/*!
+\brief Initialize node-level aggregation
+
+All tasks in \c comm call this collectively. Tasks of \c comm sharing a node
+are grouped and each allocates its segment of a shared window large enough for
+\c maxPieces descriptors and \c nbytes of data. The lowest ranked task on each
+node becomes the node's writer.
+
+\returns The MACSIO_AGG handle
+*/
+extern MACSIO_AGG_t *
+MACSIO_AGG_Init(
+    MPI_Comm comm,     /**< [in] Communicator of all tasks taking part */
+    int maxPieces,     /**< [in] Maximum number of pieces this task will add */
+    size_t nbytes      /**< [in] Total bytes of data this task will add */
+);
+
+/*!
+\brief Communicator of the writers
+
+\returns The communicator holding one writer per node or \c MPI_COMM_NULL
+on tasks that are not writers.
+*/
+extern MPI_Comm
+MACSIO_AGG_WriterComm(
+    MACSIO_AGG_t const *agg /**< [in] The MACSIO_AGG handle */
+);
+
+/*!
+\brief Place a piece of data in this task's segment of the window
+
+The data is copied once into shared memory. No messages are sent.
+
+\returns Zero on success, non-zero if there is no room left in the segment.
+*/
+extern int
+MACSIO_AGG_AddPiece(
+    MACSIO_AGG_t *agg,          /**< [in] The MACSIO_AGG handle */
+    int id,                     /**< [in] Plugin-defined identifier of the piece */
+    int ndims,                  /**< [in] Number of logical dimensions of the piece */
+    long long const *starts,    /**< [in] Logical starts of the piece */
+    long long const *counts,    /**< [in] Logical counts of the piece */
+    void const *buf,            /**< [in] The piece's data */
+    size_t nbytes               /**< [in] Size of the piece's data in bytes */
+);
+
+/*!
+\brief Make all pieces on a node visible to the node's writer
+
+All tasks in \c comm argument to \c MACSIO_AGG_Init() call this collectively
+after adding all of their pieces.
+*/
+extern void
+MACSIO_AGG_Sync(
+    MACSIO_AGG_t *agg /**< [in] The MACSIO_AGG handle */
+);
+
+/*! \brief Is the calling task its node's writer */
+extern int
+MACSIO_AGG_IsWriter(
+    MACSIO_AGG_t const *agg /**< [in] The MACSIO_AGG handle */
+);
+
+/*! \brief Number of tasks on the calling task's node */
+extern int
+MACSIO_AGG_NodeSize(
+    MACSIO_AGG_t const *agg /**< [in] The MACSIO_AGG handle */
+);
+
+/*!
+\brief Get the pieces placed in the window by a task on this node
+
+\returns A pointer directly into shared memory to the piece descriptors of
+the task whose rank on the node is \c nodeRank.
+*/
+extern MACSIO_AGG_piece_t const *
+MACSIO_AGG_GetPieces(
+    MACSIO_AGG_t const *agg, /**< [in] The MACSIO_AGG handle */
+    int nodeRank,            /**< [in] Rank of the task on the node */
+    int *npieces             /**< [out] Number of pieces the task placed */
+);
+
+/*!
+\brief Get a pointer to the data of a piece
+
+\returns A pointer directly into shared memory. No copy is made.
+*/
+extern void const *
+MACSIO_AGG_PieceData(
+    MACSIO_AGG_t const *agg,         /**< [in] The MACSIO_AGG handle */
+    int nodeRank,                    /**< [in] Rank on the node of the task owning the piece */
+    MACSIO_AGG_piece_t const *piece  /**< [in] The piece */
+);
+
+/*!
+\brief End node-level aggregation and free resources
+
+All tasks in \c comm argument to \c MACSIO_AGG_Init() call this collectively.
+Tasks that are not writers wait here until their node's writer is done with
+their data.
+*/
+extern void
+MACSIO_AGG_Finish(
+    MACSIO_AGG_t *agg /**< [in] The MACSIO_AGG handle */
+);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/*!@}*/
+
+#endif /* #ifndef _MACSIO_AGG_H */
@@ -55,6 +55,7 @@ extern "C" {
 #include <macsio_iface.h>
 #include <macsio_log.h>
 #include <macsio_main.h>
+#include <macsio_mif.h>
 #include <macsio_timing.h>
 #include <macsio_utils.h>
 #include <macsio_work.h>
@@ -191,6 +192,16 @@ static json_object *ProcessCommandLine(int argc, char *argv[], int *plugin_argi)
             "It will produce the specified number of files by grouping ranks in the\n"
             "the same way MIF does, but I/O within each group will be to a single,\n"
             "shared file using SIF mode.",
+        "--mif_baton_order %s", "rank",
+            "Specify the order in which the baton is passed among the ranks of each\n"
+            "MIF group. The options are 'rank', 'largest' and 'interleave'. For 'rank',\n"
+            "the default, the baton is passed in rank order. For 'largest', the byte\n"
+            "counts of the ranks in a group are gathered within the group and the\n"
+            "baton is passed from the rank with the most data to the rank with the\n"
+            "least. For 'interleave', each group uses the 'largest' order but rotated\n"
+            "by the group's index so that the largest writers of different groups do\n"
+            "not all write at the same time. The miftmpl plugin records each rank's\n"
+            "position in the chain in its root file.",
         "--avg_num_parts %f", "1",
             "The average number of mesh parts per MPI rank. Non-integral values\n"
             "are acceptable. For example, a value that is half-way between two\n"
@@ -291,6 +302,11 @@ static json_object *ProcessCommandLine(int argc, char *argv[], int *plugin_argi)
             "(https://computation.llnl.gov/project/scr/library) to marshal\n"
             "files. Note that this works only in MIFFPP mode. A request to exercise\n"
             "SCR in any other mode will be ignored and en error message generated.",
+#endif
+#ifdef HAVE_MPI
+        "--mpi_thread_multiple", "",
+            "Initialize MPI with MPI_THREAD_MULTIPLE. Some plugin features need it\n"
+            "(e.g. the HDF5 plugin's --subfiling).",
 #endif
         "--compute_work_intensity %d", "1",
             "Add some work in between I/O phases. There are three levels of 'compute'\n"
@@ -324,15 +340,21 @@ static json_object *ProcessCommandLine(int argc, char *argv[], int *plugin_argi)
             "Specify the name of the timings file. Passing an empty string, \"\"\n"
             "will disable the creation of a timings file.",
         MACSIO_CLARGS_ARG_GROUP_END(Log File Options),
-        "--alignment %d", MACSIO_CLARGS_NODEFAULT,
-            "Not currently documented",
+        "--alignment %d", "0",
+            "Align file objects at least as big as a plugin's threshold on multiples\n"
+            "of this many bytes (e.g. the file system block or stripe size). Zero\n"
+            "means no alignment. Currently honored by the HDF5 plugin.",
+        "--mpi_hints %s", MACSIO_CLARGS_NODEFAULT,
+            "Comma-separated list of key=value MPI-IO hints passed to MPI_File_open\n"
+            "by plugins that use MPI-IO (e.g. \"cb_nodes=8,cb_buffer_size=16777216,\n"
+            "romio_cb_write=enable,striping_factor=16\").",
         "--filebase %s", "macsio",
             "Basename of generated file(s).",
         "--fileext %s", "",
             "Extension of generated file(s).",
         "--read_path %s", MACSIO_CLARGS_NODEFAULT,
             "Specify a path name (file or dir) to start reading for a read test.",
-        "--num_loads %d", MACSIO_CLARGS_NODEFAULT,
+        "--num_loads %d", "1",
             "Number of loads in succession to test.",
         "--no_validate_read", "",
             "Don't validate data on read.",
@@ -705,7 +727,7 @@ main(int argc, char *argv[])
     json_object *clargs_obj = 0;
     MACSIO_TIMING_GroupMask_t main_grp;
     MACSIO_TIMING_TimerId_t main_tid;
-    int i, argi, exercise_scr = 0;
+    int i, argi, exercise_scr = 0, thread_multiple = 0;
     double currtime;
     unsigned ucurrtim;
 
@@ -713,6 +735,10 @@ main(int argc, char *argv[])
     for (i = 0; i < argc && !exercise_scr; i++)
         exercise_scr = !strcmp("exercise_scr", argv[i]);
 
+    /* and for the thread level MPI must be initialized with */
+    for (i = 0; i < argc && !thread_multiple; i++)
+        thread_multiple = !strcmp("--mpi_thread_multiple", argv[i]);
+
 #ifdef HAVE_CALIPER
 #ifdef HAVE_MPI
     /* Ensures Caliper's MPI runtime lib is loaded */
@@ -723,7 +749,13 @@ main(int argc, char *argv[])
 
 ////#warning SHOULD WE BE USING MPI-3 API
 #ifdef HAVE_MPI
-    MPI_Init(&argc, &argv);
+    if (thread_multiple)
+    {
+        int provided;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    }
+    else
+        MPI_Init(&argc, &argv);
 #ifdef HAVE_SCR
 ////#warning SANITY CHECK WITH MIFFPP
     if (exercise_scr)
@@ -763,6 +795,10 @@ main(int argc, char *argv[])
 ////#warning THESE INITIALIZATIONS SHOULD BE IN MACSIO_LOG
     MACSIO_LOG_DebugLevel = JsonGetInt(clargs_obj, "debug_level");
 
+    /* Plugins ask for this with MACSIO_MIF_ORDER_DEFAULT */
+    MACSIO_MIF_SetDefaultOrderPolicy(
+        MACSIO_MIF_OrderPolicyFromString(JsonGetStr(clargs_obj, "mif_baton_order")));
+
     /* Setup parallel information */
     json_object_object_add(parallel_obj, "mpi_size", json_object_new_int(MACSIO_MAIN_Size));
     json_object_object_add(parallel_obj, "mpi_rank", json_object_new_int(MACSIO_MAIN_Rank));
@@ -25,6 +25,7 @@ Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef HAVE_SCR
 #ifdef __cplusplus
@@ -62,6 +63,7 @@ typedef struct _MACSIO_MIF_baton_t
     int rankInGroup;            /**< Rank of this processor within its group */
     int procBeforeMe;           /**< Rank of processor before this processor in the group */
     int procAfterMe;            /**< Rank of processor after this processor in the group */
+    int posInChain;             /**< Position of this processor in the group's baton chain */
     mutable int mifErr;         /**< MIF error value */
     mutable int mpiErr;         /**< MPI error value */
     int mpiTag;                 /**< MPI message tag used for all messages here */
@@ -140,6 +142,7 @@ MACSIO_MIF_Init(
     ret->rankInGroup = rankInGroup;
     ret->procBeforeMe = procBeforeMe;
     ret->procAfterMe = procAfterMe;
+    ret->posInChain = rankInGroup;
     ret->mifErr = MACSIO_MIF_BATON_OK;
 #ifdef HAVE_MPI
     ret->mpiErr = MPI_SUCCESS;
@@ -317,3 +320,142 @@ MACSIO_MIF_RankInGroup(
 
     return retval;
 }
+
+int
+MACSIO_MIF_IsLastInGroup(
+    MACSIO_MIF_baton_t const *Bat
+)
+{
+    return Bat->procAfterMe == -1;
+}
+
+/*! \brief A task's byte count used to sort the baton chain */
+typedef struct _MACSIO_MIF_chainEntry_t
+{
+    unsigned long long nbytes; /**< Number of bytes the task will write */
+    int rankInComm;            /**< Rank of the task in the MPI comm */
+} MACSIO_MIF_chainEntry_t;
+
+/* Largest first with ties broken by rank to keep the order deterministic */
+static int
+CompareChainEntries(void const *a, void const *b)
+{
+    MACSIO_MIF_chainEntry_t const *ea = (MACSIO_MIF_chainEntry_t const *) a;
+    MACSIO_MIF_chainEntry_t const *eb = (MACSIO_MIF_chainEntry_t const *) b;
+
+    if (ea->nbytes > eb->nbytes) return -1;
+    if (ea->nbytes < eb->nbytes) return 1;
+    return ea->rankInComm - eb->rankInComm;
+}
+
+static int DefaultOrderPolicy = MACSIO_MIF_ORDER_RANK;
+
+void
+MACSIO_MIF_SetDefaultOrderPolicy(
+    int policy
+)
+{
+    if (policy != MACSIO_MIF_ORDER_DEFAULT)
+        DefaultOrderPolicy = policy;
+}
+
+int
+MACSIO_MIF_OrderPolicyFromString(
+    char const *policyStr
+)
+{
+    if (!policyStr) return MACSIO_MIF_ORDER_RANK;
+    if (!strcmp(policyStr, "largest")) return MACSIO_MIF_ORDER_LARGEST;
+    if (!strcmp(policyStr, "interleave")) return MACSIO_MIF_ORDER_INTERLEAVE;
+    return MACSIO_MIF_ORDER_RANK;
+}
+
+int
+MACSIO_MIF_SetBatonOrder(
+    MACSIO_MIF_baton_t *Bat,
+    int policy,
+    unsigned long long nbytes
+)
+{
+    if (!Bat) return 1;
+    if (policy == MACSIO_MIF_ORDER_DEFAULT)
+        policy = DefaultOrderPolicy;
+    if (policy != MACSIO_MIF_ORDER_LARGEST && policy != MACSIO_MIF_ORDER_INTERLEAVE)
+        return 0;
+
+#ifdef HAVE_MPI
+    {
+        int i, n, shift, myGroupSize, groupStart;
+        MPI_Comm groupComm;
+        unsigned long long *allBytes;
+        MACSIO_MIF_chainEntry_t *chain;
+
+        if (Bat->groupRank < Bat->numGroupsWithExtraProc)
+        {
+            myGroupSize = Bat->groupSize + 1;
+            groupStart = Bat->groupRank * myGroupSize;
+        }
+        else
+        {
+            myGroupSize = Bat->groupSize;
+            groupStart = Bat->commSplit +
+                         (Bat->groupRank - Bat->numGroupsWithExtraProc) * Bat->groupSize;
+        }
+
+        /* Gather byte counts within the group only */
+        allBytes = (unsigned long long *) malloc(myGroupSize * sizeof(unsigned long long));
+        chain = (MACSIO_MIF_chainEntry_t *) malloc(myGroupSize * sizeof(MACSIO_MIF_chainEntry_t));
+        Bat->mpiErr = MPI_Comm_split(Bat->mpiComm, Bat->groupRank, Bat->rankInGroup, &groupComm);
+        if (Bat->mpiErr == MPI_SUCCESS)
+        {
+            Bat->mpiErr = MPI_Allgather(&nbytes, 1, MPI_UNSIGNED_LONG_LONG,
+                                        allBytes, 1, MPI_UNSIGNED_LONG_LONG, groupComm);
+            MPI_Comm_free(&groupComm);
+        }
+        if (Bat->mpiErr != MPI_SUCCESS)
+        {
+            Bat->mifErr = MACSIO_MIF_BATON_ERR;
+            free(allBytes);
+            free(chain);
+            return 1;
+        }
+
+        for (i = 0; i < myGroupSize; i++)
+        {
+            chain[i].nbytes = allBytes[i];
+            chain[i].rankInComm = groupStart + i;
+        }
+        qsort(chain, myGroupSize, sizeof(MACSIO_MIF_chainEntry_t), CompareChainEntries);
+
+        /* Stagger the start of the chain from one group to the next */
+        shift = policy == MACSIO_MIF_ORDER_INTERLEAVE ? Bat->groupRank % myGroupSize : 0;
+
+        Bat->procBeforeMe = -1;
+        Bat->procAfterMe = -1;
+        for (i = 0; i < myGroupSize; i++)
+        {
+            n = (i + shift) % myGroupSize;
+            if (chain[n].rankInComm != Bat->rankInComm) continue;
+            Bat->posInChain = i;
+            if (i > 0)
+                Bat->procBeforeMe = chain[(n + myGroupSize - 1) % myGroupSize].rankInComm;
+            if (i < myGroupSize - 1)
+                Bat->procAfterMe = chain[(n + 1) % myGroupSize].rankInComm;
+            break;
+        }
+
+        free(allBytes);
+        free(chain);
+    }
+#endif
+
+    return 0;
+}
+
+int
+MACSIO_MIF_PositionInChain(
+    MACSIO_MIF_baton_t const *Bat
+)
+{
+    return Bat->posInChain;
+}
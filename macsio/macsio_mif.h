@@ -45,6 +45,11 @@ extern "C" {
 #define MACSIO_MIF_READ  0
 #define MACSIO_MIF_WRITE 1
 
+#define MACSIO_MIF_ORDER_RANK       0 /**< Baton passes in rank order (the default) */
+#define MACSIO_MIF_ORDER_LARGEST    1 /**< Baton passes from largest to smallest writer */
+#define MACSIO_MIF_ORDER_INTERLEAVE 2 /**< Largest first but staggered from group to group */
+#define MACSIO_MIF_ORDER_DEFAULT   -1 /**< Whatever MACSIO_MIF_SetDefaultOrderPolicy() last set */
+
 /*!
 \brief Bit Field struct for I/O flags
 */
@@ -183,6 +188,80 @@ MACSIO_MIF_RankInGroup(
     int rankInComm                 /**< [in] The (global) rank of a task for which it's rank in a group is desired */
 );
 
+/*!
+\brief Whether the calling task is the last in its group's baton chain
+
+Once the last task of a group hands off the baton, no other task touches the
+group's file. That task may therefore leave work on the file in flight.
+
+\returns Non-zero if the calling task is last in its group's chain.
+*/
+extern int
+MACSIO_MIF_IsLastInGroup(
+    MACSIO_MIF_baton_t const *Bat  /**< [in] The MACSIO_MIF baton handle */
+);
+
+/*!
+\brief Re-order the baton chain within each group according to dump sizes
+
+All tasks in \c mpiComm argument to \c MACSIO_MIF_Init() call this function
+collectively and before any task calls \c MACSIO_MIF_WaitForBaton(). The byte
+counts of all tasks in a group are gathered within the group and the order in
+which the baton is passed is then determined by \c policy.
+
+For \c MACSIO_MIF_ORDER_LARGEST, the task with the most data goes first. For
+\c MACSIO_MIF_ORDER_INTERLEAVE, each group uses the largest first order but
+rotated by the group's rank so that the largest writers of different groups
+do not all hit the filesystem at the same moment. \c MACSIO_MIF_ORDER_RANK
+leaves the default order unchanged.
+
+The task first in the chain creates the group's file. Group membership and,
+therefore, \c MACSIO_MIF_RankOfGroup() are unaffected.
+
+\returns Zero on success, non-zero otherwise.
+*/
+extern int
+MACSIO_MIF_SetBatonOrder(
+    MACSIO_MIF_baton_t *Bat,  /**< [in] The MACSIO_MIF baton handle */
+    int policy,               /**< [in] One of the MACSIO_MIF_ORDER_XXX values */
+    unsigned long long nbytes /**< [in] The number of bytes this task will write */
+);
+
+/*!
+\brief Set the policy \c MACSIO_MIF_ORDER_DEFAULT stands for
+
+MACSio main calls this once with the policy given by \c --mif_baton_order so
+that plugins need not look it up. Until then, the default is
+\c MACSIO_MIF_ORDER_RANK.
+*/
+extern void
+MACSIO_MIF_SetDefaultOrderPolicy(
+    int policy /**< [in] One of the MACSIO_MIF_ORDER_XXX values other than \c MACSIO_MIF_ORDER_DEFAULT */
+);
+
+/*!
+\brief Map an ordering policy name to a MACSIO_MIF_ORDER_XXX value
+
+Recognizes "rank", "largest" and "interleave". Any other string (including a
+null pointer) maps to \c MACSIO_MIF_ORDER_RANK.
+*/
+extern int
+MACSIO_MIF_OrderPolicyFromString(
+    char const *policyStr /**< [in] The policy name */
+);
+
+/*!
+\brief Position of this task in its group's baton chain
+
+With the default ordering, this is the same as the task's rank in its group.
+The miftmpl plugin records this in its root file so that readers can determine
+the order in which parts landed in a group's file.
+*/
+extern int
+MACSIO_MIF_PositionInChain(
+    MACSIO_MIF_baton_t const *Bat /**< [in] The MACSIO_MIF baton handle */
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,12 +24,15 @@ this program; if not, write to the Free Software Foundation, Inc., 59 Temple
 Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
+#include <errno.h>
 #include <float.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <strings.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <macsio_utils.h>
 
@@ -498,3 +501,158 @@ unsigned long long MACSIO_UTILS_StatFiles(int dump_num)
     free(buf);
     return dump_bytes;
 }
+
+int MACSIO_UTILS_VarIsSelected(char const *list, char const *name)
+{
+    int selected = 0;
+    char *list_copy, *tok, *save;
+
+    if (!list || !strcmp(list, "null") || !strcmp(list, "all"))
+        return 1;
+
+    list_copy = strdup(list);
+    for (tok = strtok_r(list_copy, ", ", &save); tok && !selected; tok = strtok_r(0, ", ", &save))
+        selected = !strcmp(tok, name);
+    free(list_copy);
+
+    return selected;
+}
+
+size_t MACSIO_UTILS_ExtarrValSize(enum json_extarr_type type)
+{
+    switch (type)
+    {
+        case json_extarr_type_byt08: return 1;
+        case json_extarr_type_int32: return 4;
+        case json_extarr_type_int64: return 8;
+        case json_extarr_type_flt32: return 4;
+        case json_extarr_type_flt64: return 8;
+        default: break;
+    }
+    return 0;
+}
+
+static void for_each_extarr(json_object *obj, char const *path,
+    MACSIO_UTILS_ExtarrVisitor_t visit, void *data)
+{
+    char subpath[256];
+    int i;
+
+    if (!obj)
+        return;
+
+    switch (json_object_get_type(obj))
+    {
+        case json_type_extarr:
+        {
+            visit(obj, path, data);
+            break;
+        }
+        case json_type_object:
+        {
+            json_object_object_foreach(obj, key, val)
+            {
+                snprintf(subpath, sizeof(subpath), "%s%s%s", path, *path ? "/" : "", key);
+                for_each_extarr(val, subpath, visit, data);
+            }
+            break;
+        }
+        case json_type_array:
+        {
+            for (i = 0; i < json_object_array_length(obj); i++)
+            {
+                snprintf(subpath, sizeof(subpath), "%s%s%d", path, *path ? "/" : "", i);
+                for_each_extarr(json_object_array_get_idx(obj, i), subpath, visit, data);
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+void MACSIO_UTILS_ForEachExtarr(json_object *obj, MACSIO_UTILS_ExtarrVisitor_t visit, void *data)
+{
+    for_each_extarr(obj, "", visit, data);
+}
+
+int MACSIO_UTILS_PwriteAll(int fd, void const *buf, size_t len, off_t off)
+{
+    char const *p = (char const *) buf;
+
+    while (len > 0)
+    {
+        ssize_t n = pwrite(fd, p, len, off);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+        {
+            errno = EIO;
+            return -1;
+        }
+        p += n;
+        len -= (size_t) n;
+        off += n;
+    }
+    return 0;
+}
+
+int MACSIO_UTILS_GroupFileName(char const *path, char const *tag, int i,
+    char *name, int namesize)
+{
+    char const *p, *group = 0;
+    int j;
+
+    for (p = strstr(path, tag); p; p = strstr(p + 1, tag))
+        group = p + strlen(tag);
+
+    for (j = 0; group && j < 5; j++)
+        if (group[j] < '0' || group[j] > '9') group = 0;
+
+    if (group && group[5] == '_')
+    {
+        snprintf(name, namesize, "%.*s%05d%s", (int) (group - path), path, i, group + 5);
+        return 1;
+    }
+
+    snprintf(name, namesize, "%s", path);
+    return 0;
+}
+
+#ifdef HAVE_MPI
+MPI_Info MACSIO_UTILS_MPIInfoFromHints(char const *hints)
+{
+    MPI_Info info = MPI_INFO_NULL;
+    char *hints_copy, *tok, *save;
+
+    if (!hints || !strlen(hints) || !strcmp(hints, "null"))
+        return MPI_INFO_NULL;
+
+    hints_copy = strdup(hints);
+    for (tok = strtok_r(hints_copy, ", ", &save); tok; tok = strtok_r(0, ", ", &save))
+    {
+        char *eq = strchr(tok, '=');
+        if (!eq || eq == tok || !eq[1])
+            continue;
+        *eq = '\0';
+        if (info == MPI_INFO_NULL)
+            MPI_Info_create(&info);
+        MPI_Info_set(info, tok, eq+1);
+    }
+    free(hints_copy);
+
+    return info;
+}
+
+long long MACSIO_UTILS_ExscanOffset(long long nbytes, MPI_Comm comm)
+{
+    long long before = 0;
+    int rank;
+
+    /* MPI_Exscan leaves rank 0's result undefined */
+    MPI_Exscan(&nbytes, &before, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    MPI_Comm_rank(comm, &rank);
+    return rank ? before : 0;
+}
+#endif
@@ -26,8 +26,14 @@ this program; if not, write to the Free Software Foundation, Inc., 59 Temple
 Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
+#include <sys/types.h>
+
 #include <json-cwx/json.h>
 
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -102,6 +108,42 @@ extern void MACSIO_UTILS_RecordOutputFiles(int dump_num, char *filename);
 extern void MACSIO_UTILS_CleanupFileStore();
 extern unsigned long long MACSIO_UTILS_StatFiles(int dump_num);
 
+/* Whether name is in a comma or space separated list of variable names (e.g. the
+   --read_vars command-line argument). A null list, "null" or "all" selects all. */
+extern int MACSIO_UTILS_VarIsSelected(char const *list, char const *name);
+
+/* Size, in bytes, of one value of an extarr type, or 0 if the type is unknown */
+extern size_t MACSIO_UTILS_ExtarrValSize(enum json_extarr_type type);
+
+/* Visitor called by MACSIO_UTILS_ForEachExtarr with an extarr, its path below
+   the object walked (e.g. Mesh/Coords/XAxisCoords, array members named by their
+   index) and the caller's data */
+typedef void (*MACSIO_UTILS_ExtarrVisitor_t)(json_object *extarr, char const *path, void *data);
+
+/* Call visit on every extarr under obj, in depth-first order */
+extern void MACSIO_UTILS_ForEachExtarr(json_object *obj, MACSIO_UTILS_ExtarrVisitor_t visit, void *data);
+
+/* pwrite all len bytes of buf at offset off, retrying short and interrupted
+   writes. Returns 0 on success or -1, with errno set, on failure. */
+extern int MACSIO_UTILS_PwriteAll(int fd, void const *buf, size_t len, off_t off);
+
+/* Name of the i'th file of a set of files named <filebase><tag><group>_<rest>,
+   where <group> is five digits, given the name of any one of them. Returns
+   non-zero if path is one of such a set. Otherwise, path is copied as is. */
+extern int MACSIO_UTILS_GroupFileName(char const *path, char const *tag, int i,
+    char *name, int namesize);
+
+#ifdef HAVE_MPI
+/* Make an MPI_Info from a comma or space separated list of key=value hints
+   (e.g. the --mpi_hints command-line argument). Returns MPI_INFO_NULL if there
+   are none. Otherwise, the caller must MPI_Info_free the result. */
+extern MPI_Info MACSIO_UTILS_MPIInfoFromHints(char const *hints);
+
+/* Where this task's range starts in a shared file holding every task's range in
+   rank order, i.e. an exclusive scan of the range sizes over comm. Collective. */
+extern long long MACSIO_UTILS_ExscanOffset(long long nbytes, MPI_Comm comm);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
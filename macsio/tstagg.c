@@ -0,0 +1,102 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+Written by Mark C. Miller
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+end-of-copyright-header */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <macsio_agg.h>
+
+#include <mpi.h>
+
+#define NPIECES 3
+#define NVALS 101 /* 808 bytes of doubles, not a multiple of the alignment */
+
+int main (int argc, char **argv)
+{
+    int i, j, k, n, rank, err = 0;
+    double vals[NPIECES][NVALS];
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MACSIO_AGG_t *agg;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(comm, &rank);
+
+    /* Several odd-sized pieces must all fit in a segment sized for their total */
+    agg = MACSIO_AGG_Init(comm, NPIECES, sizeof(vals));
+    for (i = 0; i < NPIECES; i++)
+    {
+        long long start = (long long) i * NVALS, count = NVALS;
+        for (j = 0; j < NVALS; j++)
+            vals[i][j] = rank * 10000 + i * 1000 + j;
+        if (MACSIO_AGG_AddPiece(agg, i, 1, &start, &count, vals[i], sizeof(vals[i])))
+        {
+            fprintf(stderr, "rank %d could not add piece %d\n", rank, i);
+            err = 1;
+        }
+    }
+    MACSIO_AGG_Sync(agg);
+
+    /* The node's writer sees every node-local task's pieces intact */
+    if (MACSIO_AGG_IsWriter(agg))
+    {
+        for (k = 0; k < MACSIO_AGG_NodeSize(agg); k++)
+        {
+            MACSIO_AGG_piece_t const *pieces = MACSIO_AGG_GetPieces(agg, k, &n);
+            for (i = 0; i < n; i++)
+            {
+                double const *data = (double const *) MACSIO_AGG_PieceData(agg, k, &pieces[i]);
+                if (pieces[i].nbytes != sizeof(vals[i]) || pieces[i].counts[0] != NVALS)
+                {
+                    fprintf(stderr, "node rank %d piece %d has wrong size\n", k, i);
+                    err = 1;
+                    continue;
+                }
+                for (j = 0; j < NVALS; j++)
+                {
+                    if ((long) data[j] % 10000 != i * 1000 + j)
+                    {
+                        fprintf(stderr, "node rank %d piece %d value %d is %g\n", k, i, j, data[j]);
+                        err = 1;
+                        break;
+                    }
+                }
+            }
+            if (n != NPIECES)
+            {
+                fprintf(stderr, "node rank %d has %d pieces, expected %d\n", k, n, NPIECES);
+                err = 1;
+            }
+        }
+    }
+    MACSIO_AGG_Finish(agg);
+
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, comm);
+    MPI_Finalize();
+
+    return err;
+}
@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+Written by Mark C. Miller
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+end-of-copyright-header */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#include <macsio_mif.h>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+static void *CreateTstFile(const char *fname, const char *nsname, void *udata)
+{
+    return (void *) fopen(fname, "w");
+}
+
+static void *OpenTstFile(const char *fname, const char *nsname,
+    MACSIO_MIF_ioFlags_t ioFlags, void *udata)
+{
+    return (void *) fopen(fname, "a");
+}
+
+static int CloseTstFile(void *file, void *udata)
+{
+    return fclose((FILE *) file);
+}
+
+int main (int argc, char **argv)
+{
+    int i, n, rank = 0, size = 1, err = 0;
+    int policy = MACSIO_MIF_ORDER_LARGEST;
+    MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE, 0};
+    MACSIO_MIF_baton_t *bat;
+    FILE *file;
+#ifdef HAVE_MPI
+    MPI_Comm comm = MPI_COMM_WORLD;
+#else
+    int comm = 0;
+#endif
+
+    for (i = 0; i < argc; i++)
+    {
+        if (!strncasecmp(argv[i], "policy=", 7))
+            policy = MACSIO_MIF_OrderPolicyFromString(argv[i]+7);
+    }
+
+#ifdef HAVE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm, &rank);
+#endif
+
+    /* One group; higher ranks pretend to have more data */
+    bat = MACSIO_MIF_Init(1, ioFlags, comm, 7, CreateTstFile, OpenTstFile, CloseTstFile, 0);
+    MACSIO_MIF_SetBatonOrder(bat, policy, (unsigned long long) rank * 100);
+
+    if (policy != MACSIO_MIF_ORDER_RANK && MACSIO_MIF_PositionInChain(bat) != size - 1 - rank)
+    {
+        fprintf(stderr, "rank %d got chain position %d\n", rank, MACSIO_MIF_PositionInChain(bat));
+        err = 1;
+    }
+
+    file = (FILE *) MACSIO_MIF_WaitForBaton(bat, "tstmif.out", 0);
+    fprintf(file, "%d\n", rank);
+    MACSIO_MIF_HandOffBaton(bat, file);
+    MACSIO_MIF_Finish(bat);
+
+#ifdef HAVE_MPI
+    MPI_Barrier(comm);
+#endif
+
+    /* The file should hold ranks in the order the baton visited them */
+    if (rank == 0)
+    {
+        file = fopen("tstmif.out", "r");
+        for (i = 0; i < size; i++)
+        {
+            int expected = policy == MACSIO_MIF_ORDER_RANK ? i : size - 1 - i;
+            if (fscanf(file, "%d", &n) != 1 || n != expected)
+            {
+                fprintf(stderr, "line %d of tstmif.out is %d, expected %d\n", i, n, expected);
+                err = 1;
+            }
+        }
+        fclose(file);
+    }
+
+#ifdef HAVE_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MAX, comm);
+    MPI_Finalize();
+#endif
+
+    return err;
+}
@@ -44,6 +44,20 @@ Place, Suite 330, Boston, MA 02111-1307 USA
 
 #ifdef HAVE_MPI
 #include <mpi.h>
+#ifdef PARALLEL_AWARE_EXODUS
+#include <exodusII_par.h>
+#endif
+#endif
+
+/* The partial (hyperslab) writers were called ex_put_n_XXX before Exodus 7 */
+#if EX_API_VERS_NODOT >= 700
+#define EX_PUT_PARTIAL_COORD ex_put_partial_coord
+#define EX_PUT_PARTIAL_CONN ex_put_partial_conn
+#define EX_PUT_PARTIAL_VAR ex_put_partial_var
+#else
+#define EX_PUT_PARTIAL_COORD ex_put_n_coord
+#define EX_PUT_PARTIAL_CONN ex_put_n_conn
+#define EX_PUT_PARTIAL_VAR ex_put_n_var
 #endif
 
 #define MAX_STRING_LEN 128
@@ -77,6 +91,20 @@ typedef struct _ex_global_init_params {
     int num_node_sets;
     int num_side_sets;
 
+    /* this task's share of the file's nodes and elements */
+    int my_num_nodes;
+    int my_num_elems;
+    int my_node_offset;
+    int my_elem_offset;
+
+    /* ids and sizes of all the file's element blocks and its zone centered
+       variables, all defined when the file is created. Exodus counts defined
+       blocks in memory, so a task that reopens the file can't add more. */
+    int *block_ids;
+    int *block_num_elems;
+    int num_elem_vars;
+    char **elem_var_names;
+
     /* not really global initialization state but is useful to include
        in this struct to facilitate file open vs. create */
     int dumpn;
@@ -107,6 +135,21 @@ static int process_args(int argi, int argc, char *argv[])
     return 0;
 }
 
+static void put_elem_blocks(int exoid, ex_global_init_params_t const *params)
+{
+    int i;
+    for (i = 0; i < params->num_elem_block; i++)
+        ex_put_elem_block(exoid, params->block_ids[i], params->num_dim==2?"QUAD":"HEX",
+            params->block_num_elems[i], params->num_dim==2?4:8, 0);
+}
+
+static void put_elem_var_names(int exoid, ex_global_init_params_t const *params)
+{
+    ex_put_var_param(exoid, "e", params->num_elem_vars);
+    if (params->num_elem_vars)
+        ex_put_variable_names(exoid, EX_ELEM_BLOCK, params->num_elem_vars, params->elem_var_names);
+}
+
 /*!
 \brief MIF Create callback
 
@@ -156,6 +199,12 @@ static void *CreateExodusFile(const char *fname, const char *nsname, void *userD
             params->num_dim, params->num_nodes, params->num_elems, params->num_elem_block,
             params->num_node_sets, params->num_side_sets);
 
+        if (exo_err == 0)
+        {
+            put_elem_blocks(exoid, params);
+            put_elem_var_names(exoid, params);
+        }
+
         if (exo_err == 0)
             exo_err = ex_put_time(exoid, params->dumpn+1, &(params->dumpt));
 
@@ -168,12 +217,28 @@ static void *CreateExodusFile(const char *fname, const char *nsname, void *userD
     return 0;
 }
 
-//#warning HOW DO WE WRITE NEW TIMES TO SAME FILES WITH MACSIO_MIF INTERFACE?
+/*!
+\brief MIF Open callback
+
+Tasks after the first in a group add their element blocks, and at later dumps
+their variables, to the file the group's first task created. The file's element
+block count covers the whole group so the blocks can be defined in any order.
+*/
 static void *OpenExodusFile(const char *fname, const char *nsname, MACSIO_MIF_ioFlags_t ioFlags,
     void *userData)
 {
-    static const int OpenExodusFile_should_never_be_called = 1;
-    assert(!OpenExodusFile_should_never_be_called);
+    ex_global_init_params_t *params = (ex_global_init_params_t *) userData;
+    float version;
+    int exoid = ex_open(fname, EX_WRITE, &(params->cpu_word_size), &(params->io_word_size), &version);
+
+    if (exoid >= 0)
+    {
+        int *exoid_ptr = (int *) malloc(sizeof(int));
+        *exoid_ptr = exoid;
+        return exoid_ptr;
+    }
+
+    return 0;
 }
 
 static int CloseExodusFile(void *file, void *userData)
@@ -191,12 +256,13 @@ static void get_exodus_global_init_params(json_object *main_obj, int dumpn, doub
 {
     int i;
     long long num_nodes = 0, num_elems = 0;
-    long long const large_model = (1LL << 31); /* 2 Gigabytes */
-    int num_dumps = JsonGetInt(main_obj, "clargs/num_dumps");
     json_object *parts = JsonGetObj(main_obj, "problem/parts");
+    json_object *vars_array = JsonGetObj(parts, "0/Vars");
 
     params->num_elem_block = json_object_array_length(parts);
     params->num_dim = JsonGetInt(parts, "0/Mesh/GeomDim");
+    params->block_ids = (int *) malloc(params->num_elem_block * sizeof(int));
+    params->block_num_elems = (int *) malloc(params->num_elem_block * sizeof(int));
 
     for (i = 0; i < params->num_elem_block; i++)
     {
@@ -226,6 +292,8 @@ static void get_exodus_global_init_params(json_object *main_obj, int dumpn, doub
 
         num_nodes += nnodes;
         num_elems += nzones;
+        params->block_ids[i] = JsonGetInt(part, "Mesh/ChunkID")+1;
+        params->block_num_elems[i] = nzones;
     }
 
     /* word sizes */
@@ -239,7 +307,50 @@ static void get_exodus_global_init_params(json_object *main_obj, int dumpn, doub
     else if (!strncasecmp(io_word_size, "float", 5))
         params->io_word_size = sizeof(float);
 
-    /* File creation flags */
+    /* Until the file's other writers are known, the file holds just this task's parts */
+    params->num_elems = params->my_num_elems = (int) num_elems;
+    params->num_nodes = params->my_num_nodes = (int) num_nodes;
+    if ((long long) params->num_nodes != num_nodes)
+        MACSIO_LOG_MSG(Warn, ("num_nodes %lld too large for int", num_nodes));
+    params->my_node_offset = 0;
+    params->my_elem_offset = 0;
+
+    params->num_node_sets = 0;
+    params->num_side_sets = 0;
+
+    /* Zone centered variables are the same on every part */
+    params->num_elem_vars = 0;
+    params->elem_var_names = (char **) malloc((json_object_array_length(vars_array)+1) * sizeof(char*));
+    for (i = 0; i < json_object_array_length(vars_array); i++)
+    {
+        json_object *varobj = json_object_array_get_idx(vars_array, i);
+        if (strcmp(JsonGetStr(varobj, "centering"), "zone")) continue;
+        params->elem_var_names[params->num_elem_vars] = (char *) malloc((MAX_STRING_LEN+1) * sizeof (char));
+        snprintf(params->elem_var_names[params->num_elem_vars], MAX_STRING_LEN, "%s", JsonGetStr(varobj, "name"));
+        params->num_elem_vars++;
+    }
+
+    /* this is needed to facilitate MIF create callback behavior */
+    params->dumpn = dumpn;
+    params->dumpt = dumpt;
+}
+
+static void free_exodus_global_init_params(ex_global_init_params_t *params)
+{
+    int i;
+    for (i = 0; i < params->num_elem_vars; i++)
+        free(params->elem_var_names[i]);
+    free(params->elem_var_names);
+    free(params->block_ids);
+    free(params->block_num_elems);
+}
+
+/* Decide file creation flags once the size of the file is known */
+static void set_exodus_file_creation_flags(json_object *main_obj, ex_global_init_params_t *params)
+{
+    long long const large_model = (1LL << 31); /* 2 Gigabytes */
+    int num_dumps = JsonGetInt(main_obj, "clargs/num_dumps");
+
     params->file_creation_flags = EX_CLOBBER | EX_NOSHARE;
     if (!strncasecmp(use_large_model, "always", 6))
         params->file_creation_flags |= EX_LARGE_MODEL;
@@ -247,7 +358,7 @@ static void get_exodus_global_init_params(json_object *main_obj, int dumpn, doub
         params->file_creation_flags |= EX_NORMAL_MODEL;
     else if (!strncasecmp(use_large_model, "auto", 4))
     {
-        long long dataset_size = (long long) num_dumps * num_nodes * (long long) params->io_word_size;
+        long long dataset_size = (long long) num_dumps * params->num_nodes * (long long) params->io_word_size;
         if (dataset_size > large_model)
         {
             params->file_creation_flags |= EX_LARGE_MODEL;
@@ -256,18 +367,79 @@ static void get_exodus_global_init_params(json_object *main_obj, int dumpn, doub
         else
             params->file_creation_flags |= EX_NORMAL_MODEL;
     }
+}
+
+/*!
+\brief Size a MIF file for all the tasks in its group
+
+Every task in a group writes its parts as element blocks of the group's file
+so the task creating the file needs the group's node and element counts for
+ex_put_init and the ids and sizes of all the group's blocks to define them.
+Each task also needs the offset of its nodes in the file.
+*/
+static void get_exodus_group_init_params(MACSIO_MIF_baton_t const *bat, int rank, int size,
+    ex_global_init_params_t *params)
+{
+#ifdef HAVE_MPI
+    int r, my_group = MACSIO_MIF_RankOfGroup(bat, rank);
+    long long mine[3] = {params->my_num_nodes, params->my_num_elems, params->num_elem_block};
+    long long *all = (long long *) malloc(3 * size * sizeof(long long));
+    long long num_nodes = 0, num_elems = 0, num_blocks = 0, node_offset = 0, elem_offset = 0;
+    int *blk_cnts = (int *) malloc(size * sizeof(int));
+    int *blk_displs = (int *) malloc(size * sizeof(int));
+    int *all_ids, *all_num_elems, nblk = 0;
+
+    MPI_Allgather(mine, 3, MPI_LONG_LONG, all, 3, MPI_LONG_LONG, MACSIO_MAIN_Comm);
+    for (r = 0; r < size; r++)
+    {
+        blk_cnts[r] = (int) all[3*r+2];
+        blk_displs[r] = nblk;
+        nblk += blk_cnts[r];
+    }
+    all_ids = (int *) malloc(nblk * sizeof(int));
+    all_num_elems = (int *) malloc(nblk * sizeof(int));
+    MPI_Allgatherv(params->block_ids, params->num_elem_block, MPI_INT,
+        all_ids, blk_cnts, blk_displs, MPI_INT, MACSIO_MAIN_Comm);
+    MPI_Allgatherv(params->block_num_elems, params->num_elem_block, MPI_INT,
+        all_num_elems, blk_cnts, blk_displs, MPI_INT, MACSIO_MAIN_Comm);
+    for (r = 0; r < size; r++)
+    {
+        if (MACSIO_MIF_RankOfGroup(bat, r) != my_group) continue;
+        if (r < rank)
+        {
+            node_offset += all[3*r+0];
+            elem_offset += all[3*r+1];
+        }
+        num_nodes  += all[3*r+0];
+        num_elems  += all[3*r+1];
+        num_blocks += all[3*r+2];
+    }
+
+    /* Keep the blocks of this task's group */
+    params->block_ids = (int *) realloc(params->block_ids, num_blocks * sizeof(int));
+    params->block_num_elems = (int *) realloc(params->block_num_elems, num_blocks * sizeof(int));
+    for (nblk = 0, r = 0; r < size; r++)
+    {
+        if (MACSIO_MIF_RankOfGroup(bat, r) != my_group) continue;
+        memcpy(params->block_ids + nblk, all_ids + blk_displs[r], blk_cnts[r] * sizeof(int));
+        memcpy(params->block_num_elems + nblk, all_num_elems + blk_displs[r], blk_cnts[r] * sizeof(int));
+        nblk += blk_cnts[r];
+    }
+
+    free(all);
+    free(blk_cnts);
+    free(blk_displs);
+    free(all_ids);
+    free(all_num_elems);
 
-    params->num_elems = (int) num_elems;
     params->num_nodes = (int) num_nodes;
+    params->num_elems = (int) num_elems;
+    params->num_elem_block = (int) num_blocks;
+    params->my_node_offset = (int) node_offset;
+    params->my_elem_offset = (int) elem_offset;
     if ((long long) params->num_nodes != num_nodes)
         MACSIO_LOG_MSG(Warn, ("num_nodes %lld too large for int", num_nodes));
-
-    params->num_node_sets = 0;
-    params->num_side_sets = 0;
-
-    /* this is needed to facilitate MIF create callback behavior */
-    params->dumpn = dumpn;
-    params->dumpt = dumpt;
+#endif
 }
 
 static void write_rect_mesh_coords_all_parts(int exoid, ex_global_init_params_t const *params,
@@ -283,11 +455,11 @@ static void write_rect_mesh_coords_all_parts(int exoid, ex_global_init_params_t
     int *coord_offsets = (int *) malloc(num_parts * sizeof(int));
     double *exo_x_coords = 0, *exo_y_coords = 0, *exo_z_coords = 0;
 
-    exo_x_coords = (double *) malloc(params->num_nodes * sizeof(double));
+    exo_x_coords = (double *) malloc(params->my_num_nodes * sizeof(double));
     if (params->num_dim > 1)
-        exo_y_coords = (double *) malloc(params->num_nodes * sizeof(double));
+        exo_y_coords = (double *) malloc(params->my_num_nodes * sizeof(double));
     if (params->num_dim > 2)
-        exo_z_coords = (double *) malloc(params->num_nodes * sizeof(double));
+        exo_z_coords = (double *) malloc(params->my_num_nodes * sizeof(double));
 
 //#warning WE ARE DUPING COORDS ON PART BOUNDARIES AND WE SHOULD NOT BE
     for (p = 0; p < num_parts; p++)
@@ -313,7 +485,7 @@ static void write_rect_mesh_coords_all_parts(int exoid, ex_global_init_params_t
             dims[2] = JsonGetInt(part, "Mesh/LogDims", 2);
         }
    
-        coord_offsets[p] = n;
+        coord_offsets[p] = params->my_node_offset + n;
 
         for (i = 0; i < dims[0]; i++)
         {
@@ -333,7 +505,9 @@ static void write_rect_mesh_coords_all_parts(int exoid, ex_global_init_params_t
         }
     }
 
-    exo_err = ex_put_coord(exoid, exo_x_coords, exo_y_coords, exo_z_coords);
+    /* This task's nodes are a contiguous run of the file's nodes */
+    exo_err = EX_PUT_PARTIAL_COORD(exoid, params->my_node_offset+1, params->my_num_nodes,
+        exo_x_coords, exo_y_coords, exo_z_coords);
 
     if (exo_x_coords) free(exo_x_coords);
     if (exo_y_coords) free(exo_y_coords);
@@ -349,38 +523,31 @@ static void write_mesh_coords_all_parts(int exoid, ex_global_init_params_t const
         write_rect_mesh_coords_all_parts(exoid, params, parts, elem_block_coord_offsets);
 }
 
-/* Write the different mesh parts as different element blocks over a
-   single set of coordinates */
-static void write_mesh_part_blocks_and_vars(int exoid, ex_global_init_params_t const *params,
-    json_object *part, int coord_offset, int dumpn, double dumpt)
+/* Element count and 1-origin connectivity of a part's elements, whose first node is coord_offset */
+static int *part_connectivity(ex_global_init_params_t const *params, json_object *part,
+    int coord_offset, int *num_elems_in_block)
 {
     int i,j;
     int num_elems_in_dim[3] = {1,1,1};
-    int elem_block_id = JsonGetInt(part, "Mesh/ChunkID")+1;
     int nodes_per_elem = params->num_dim==2?4:8;
-    int num_elems_in_block = JsonGetInt(part, "Mesh/LogDims", 0)-1;
-    json_object *vars_array = JsonGetObj(part, "Vars");
     int *connect;
 
+    *num_elems_in_block = JsonGetInt(part, "Mesh/LogDims", 0)-1;
     num_elems_in_dim[0] = JsonGetInt(part, "Mesh/LogDims", 0)-1;
     if (params->num_dim > 1)
     {
         num_elems_in_dim[1] = JsonGetInt(part, "Mesh/LogDims", 1)-1;
-        num_elems_in_block *= (JsonGetInt(part, "Mesh/LogDims", 1)-1);
+        *num_elems_in_block *= (JsonGetInt(part, "Mesh/LogDims", 1)-1);
     }
     if (params->num_dim > 2)
     {
         num_elems_in_dim[2] = JsonGetInt(part, "Mesh/LogDims", 2)-1;
-        num_elems_in_block *= (JsonGetInt(part, "Mesh/LogDims", 2)-1);
+        *num_elems_in_block *= (JsonGetInt(part, "Mesh/LogDims", 2)-1);
     }
 
-    ex_put_elem_block(exoid, elem_block_id, params->num_dim==2?"QUAD":"HEX",
-        num_elems_in_block, nodes_per_elem, 0);
-
-//#warning ONLY NEED TO DO CONNECT STUFF ONCE
-    connect = (int *) malloc(nodes_per_elem * num_elems_in_block * sizeof(int));
+    connect = (int *) malloc(nodes_per_elem * *num_elems_in_block * sizeof(int));
 
-    for (i = 0; i < num_elems_in_block; i++)
+    for (i = 0; i < *num_elems_in_block; i++)
         for (j = 0; j < nodes_per_elem; j++)
             connect[i*nodes_per_elem+j] =
                 i/(num_elems_in_dim[0]*num_elems_in_dim[1]) +    /* Offset for crossing 3D slice dim boundaries */
@@ -390,6 +557,17 @@ static void write_mesh_part_blocks_and_vars(int exoid, ex_global_init_params_t c
                 JsonGetInt(part, "Mesh/Topology/Template", j) +  /* Offset for nodes in template elem */
                 1;                                               /* Offset for 1-origin indexing */
 
+    return connect;
+}
+
+/* Write a mesh part's element block, defined at file creation, over the file's single set of coordinates */
+static void write_mesh_part_block(int exoid, ex_global_init_params_t const *params,
+    json_object *part, int coord_offset)
+{
+    int elem_block_id = JsonGetInt(part, "Mesh/ChunkID")+1;
+    int num_elems_in_block;
+    int *connect = part_connectivity(params, part, coord_offset, &num_elems_in_block);
+
     ex_put_elem_conn(exoid, elem_block_id, connect);
     if (connect) free(connect);
   
@@ -397,64 +575,44 @@ static void write_mesh_part_blocks_and_vars(int exoid, ex_global_init_params_t c
     exo_err = ex_put_id_map(exoid, EX_NODE_MAP, node_map);
     exo_err = ex_put_id_map(exoid, EX_ELEM_MAP, elem_map);
 #endif
+}
 
-    /* Output variables */
-    {
-        int ev = 0;
-        int num_elem_vars = 0;
-        char **elem_var_names = 0;
-
-        for (i = 0; i < json_object_array_length(vars_array); i++)
-        {
-            json_object *varobj = json_object_array_get_idx(vars_array, i);
-            if (strcmp(JsonGetStr(varobj, "centering"), "zone")) continue;
-            num_elem_vars++;
-        }
-        if (num_elem_vars)
-            elem_var_names = (char **) malloc(num_elem_vars * sizeof(char*));
-
-        ex_put_var_param(exoid, "e", num_elem_vars);
-
-        for (i = 0; i < json_object_array_length(vars_array); i++)
-        {
-            json_object *varobj = json_object_array_get_idx(vars_array, i);
-            if (strcmp(JsonGetStr(varobj, "centering"), "zone")) continue;
-            elem_var_names[ev] = (char *) malloc((MAX_STRING_LEN+1) * sizeof (char));
-            snprintf(elem_var_names[ev], MAX_STRING_LEN, "%s", JsonGetStr(varobj, "name"));
-            ev++;
-        }
+/* Zone centered variable's data at the cpu word size; *vbuf is set if a converted copy was made */
+static void const *part_var_data(ex_global_init_params_t const *params, json_object *varobj, void **vbuf)
+{
+    json_object *dataobj = JsonGetObj(varobj, "data");
+    json_extarr_type etype = json_object_extarr_type(dataobj);
 
-        if (num_elem_vars)
-        {
-	    ex_put_variable_names(exoid, EX_ELEM_BLOCK, num_elem_vars, elem_var_names);
-            for (i = 0; i < num_elem_vars; i++)
-                free(elem_var_names[i]);
-            free(elem_var_names);
-        }
+    *vbuf = 0;
+    if (params->cpu_word_size == sizeof(double) && etype != json_extarr_type_flt64)
+        json_object_extarr_data_as_double(dataobj, (double**) vbuf);
+    else if (params->cpu_word_size == sizeof(float) && etype != json_extarr_type_flt32)
+        json_object_extarr_data_as_float(dataobj, (float**) vbuf);
 
-//#warning MOVE TO MORE GLOBAL PLACE IN DUMP SEQUENCE
-        ex_put_time(exoid, dumpn+1, &dumpt);
+    return *vbuf ? *vbuf : json_object_extarr_data(dataobj);
+}
 
-        ev = 1;
-        for (i = 0; i < json_object_array_length(vars_array); i++)
-        {
-            json_object *varobj = json_object_array_get_idx(vars_array, i);
-            json_object *dataobj = JsonGetObj(varobj, "data");
-            json_extarr_type etype = json_object_extarr_type(dataobj);
-            void const *dbuf = json_object_extarr_data(dataobj);
-            void *vbuf = 0;
+/* Write a mesh part's zone centered variables on its element block */
+static void write_mesh_part_vars(int exoid, ex_global_init_params_t const *params,
+    json_object *part, int dumpn)
+{
+    int i, ev = 1;
+    int elem_block_id = JsonGetInt(part, "Mesh/ChunkID")+1;
+    json_object *vars_array = JsonGetObj(part, "Vars");
 
-            if (strcmp(JsonGetStr(varobj, "centering"), "zone")) continue;
+    for (i = 0; i < json_object_array_length(vars_array); i++)
+    {
+        json_object *varobj = json_object_array_get_idx(vars_array, i);
+        void *vbuf;
+        void const *dbuf;
 
-            if (params->cpu_word_size == sizeof(double) && etype != json_extarr_type_flt64)
-                json_object_extarr_data_as_double(dataobj, (double**) &vbuf);
-            else if (params->cpu_word_size == sizeof(float) && etype != json_extarr_type_flt32)
-                json_object_extarr_data_as_float(dataobj, (float**) &vbuf);
+        if (strcmp(JsonGetStr(varobj, "centering"), "zone")) continue;
 
-	    ex_put_var(exoid, dumpn+1, EX_ELEM_BLOCK, ev++, elem_block_id, num_elems_in_block, vbuf?vbuf:dbuf);
+        dbuf = part_var_data(params, varobj, &vbuf);
+        ex_put_var(exoid, dumpn+1, EX_ELEM_BLOCK, ev++, elem_block_id,
+            json_object_extarr_nvals(JsonGetObj(varobj, "data")), dbuf);
 
-            if (vbuf) free(vbuf);
-        }
+        if (vbuf) free(vbuf);
     }
 }
 
@@ -523,9 +681,135 @@ static void WriteDecompMesh(json_object *main_obj, int exoid, int dumpn, MACSIO_
         zdims[i] = dims[i]-1;
 }
 
+/*!
+\brief Write all tasks' parts to a single file with parallel NetCDF-4
+
+Parallel NetCDF-4 needs every task to make the same define-mode calls and, for
+collective access, the same data-writing calls. So rather than one element block
+per part, all parts go in a single element block. Each task's parts are a
+contiguous run of its nodes and elements and each variable is written with one
+collective partial write per task.
+*/
+static void main_dump_sif(json_object *main_obj, int dumpn, double dumpt, ex_global_init_params_t *params)
+{
+#if defined(HAVE_MPI) && defined(PARALLEL_AWARE_EXODUS)
+    int rank = JsonGetInt(main_obj, "parallel/mpi_rank");
+    int exoid, p, v, n, elem_block_id = 1;
+    int nodes_per_elem = params->num_dim==2?4:8;
+    long long mine[2] = {params->my_num_nodes, params->my_num_elems};
+    long long offsets[2] = {0, 0}, totals[2];
+    char fileName[256];
+    json_object *parts = JsonGetObj(main_obj, "problem/parts");
+    int num_parts = json_object_array_length(parts);
+    MPI_Info mpiInfo = MACSIO_UTILS_MPIInfoFromHints(JsonGetStr(main_obj, "clargs/mpi_hints"));
+    char *vbuf;
+
+    MPI_Exscan(mine, offsets, 2, MPI_LONG_LONG, MPI_SUM, MACSIO_MAIN_Comm);
+    MPI_Allreduce(mine, totals, 2, MPI_LONG_LONG, MPI_SUM, MACSIO_MAIN_Comm);
+    if (rank == 0)
+        offsets[0] = offsets[1] = 0;
+    params->num_nodes = (int) totals[0];
+    params->num_elems = (int) totals[1];
+    params->num_elem_block = 1;
+    params->block_ids[0] = elem_block_id;
+    params->block_num_elems[0] = params->num_elems;
+    params->my_node_offset = (int) offsets[0];
+    params->my_elem_offset = (int) offsets[1];
+    if ((long long) params->num_nodes != totals[0])
+        MACSIO_LOG_MSG(Warn, ("num_nodes %lld too large for int", totals[0]));
+    set_exodus_file_creation_flags(main_obj, params);
+
+    sprintf(fileName, "%s_exodus.%s",
+        JsonGetStr(main_obj, "clargs/filebase"),
+        JsonGetStr(main_obj, "clargs/fileext"));
+
+    MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
+
+    if (dumpn == 0)
+    {
+        int *elem_block_coord_offsets = 0, *connect;
+
+        exoid = ex_create_par(fileName, params->file_creation_flags | EX_NETCDF4 | EX_MPIIO,
+            &(params->cpu_word_size), &(params->io_word_size), MACSIO_MAIN_Comm, mpiInfo);
+        if (exoid < 0)
+            MACSIO_LOG_MSG(Die, ("ex_create_par failed for \"%s\"", fileName));
+
+        ex_put_init(exoid, "MACSio performance test of Exodus library",
+            params->num_dim, params->num_nodes, params->num_elems, params->num_elem_block,
+            params->num_node_sets, params->num_side_sets);
+        put_elem_blocks(exoid, params);
+        put_elem_var_names(exoid, params);
+
+        write_mesh_coords_all_parts(exoid, params, parts, &elem_block_coord_offsets);
+
+        connect = (int *) malloc(nodes_per_elem * params->my_num_elems * sizeof(int));
+        for (n = 0, p = 0; p < num_parts; p++)
+        {
+            int num_elems_in_part;
+            int *part_connect = part_connectivity(params, JsonGetObj(parts, "", p),
+                elem_block_coord_offsets[p], &num_elems_in_part);
+            memcpy(connect + n * nodes_per_elem, part_connect, nodes_per_elem * num_elems_in_part * sizeof(int));
+            n += num_elems_in_part;
+            free(part_connect);
+        }
+        EX_PUT_PARTIAL_CONN(exoid, EX_ELEM_BLOCK, elem_block_id, params->my_elem_offset+1,
+            params->my_num_elems, connect, 0, 0);
+        free(connect);
+        if (elem_block_coord_offsets) free(elem_block_coord_offsets);
+    }
+    else
+    {
+        float version;
+        exoid = ex_open_par(fileName, EX_WRITE | EX_MPIIO, &(params->cpu_word_size),
+            &(params->io_word_size), &version, MACSIO_MAIN_Comm, mpiInfo);
+        if (exoid < 0)
+            MACSIO_LOG_MSG(Die, ("ex_open_par failed for \"%s\"", fileName));
+    }
+    if (mpiInfo != MPI_INFO_NULL)
+        MPI_Info_free(&mpiInfo);
+
+    ex_put_time(exoid, dumpn+1, &dumpt);
+
+    /* Gather each variable's values over this task's parts and write them in one call */
+    vbuf = (char *) malloc(params->my_num_elems * params->cpu_word_size);
+    for (v = 0; v < params->num_elem_vars; v++)
+    {
+        size_t nbytes = 0;
+        for (p = 0; p < num_parts; p++)
+        {
+            json_object *vars_array = JsonGetObj(parts, "", p, "Vars");
+            int i;
+            for (i = 0; i < json_object_array_length(vars_array); i++)
+            {
+                json_object *varobj = json_object_array_get_idx(vars_array, i);
+                void *cbuf;
+                void const *dbuf;
+                size_t len;
+
+                if (strcmp(JsonGetStr(varobj, "name"), params->elem_var_names[v])) continue;
+
+                dbuf = part_var_data(params, varobj, &cbuf);
+                len = json_object_extarr_nvals(JsonGetObj(varobj, "data")) * params->cpu_word_size;
+                memcpy(vbuf + nbytes, dbuf, len);
+                nbytes += len;
+                if (cbuf) free(cbuf);
+                break;
+            }
+        }
+        EX_PUT_PARTIAL_VAR(exoid, dumpn+1, EX_ELEM_BLOCK, v+1, elem_block_id,
+            params->my_elem_offset+1, params->my_num_elems, vbuf);
+    }
+    free(vbuf);
+
+    ex_close(exoid);
+#else
+    MACSIO_LOG_MSG(Die, ("Exodus SIF mode needs MPI and an Exodus library built with parallel NetCDF-4"));
+#endif
+}
+
 static void main_dump(int argi, int argc, char **argv, json_object *main_obj, int dumpn, double dumpt)
 {
-    int numGroups = -1;
+    int numGroups = -1, use_sif = 0;
     int rank, size;
     int *exoid_ptr;
     int *elem_block_coord_offsets = 0;
@@ -546,7 +830,7 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
     size = JsonGetInt(main_obj, "parallel/mpi_size");
 
 //#warning MOVE TO A FUNCTION
-    /* ensure we're in MIF mode and determine the file count */
+    /* determine the file mode and, for MIF, the file count */
     json_object *parfmode_obj = JsonGetObj(main_obj, "clargs/parallel_file_mode");
     if (parfmode_obj)
     {
@@ -554,33 +838,52 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
         json_object *filecnt = json_object_array_get_idx(parfmode_obj, 1);
         if (modestr && !strcmp(json_object_get_string(modestr), "SIF"))
         {
-            MACSIO_LOG_MSG(Die, ("Exodus plugin doesn't support SIF mode"));
+            use_sif = 1;
         }
-        else if (modestr && strcmp(json_object_get_string(modestr), "MIFMAX"))
+        else if (modestr && strcmp(json_object_get_string(modestr), "MIF"))
         {
-            MACSIO_LOG_MSG(Warn, ("Exodus plugin supports only MIFMAX mode"));
+            MACSIO_LOG_MSG(Warn, ("Ignoring non-standard MIF mode"));
         }
-        numGroups = size;
+        if (filecnt)
+            numGroups = json_object_get_int(filecnt);
+        else
+            numGroups = size;
     }
     else
     {
         char const * modestr = JsonGetStr(main_obj, "clargs/parallel_file_mode");
         if (!strcmp(modestr, "SIF"))
-        {
-            MACSIO_LOG_MSG(Die, ("Exodus plugin doesn't support SIF mode"));
-        }
-        else if (strcmp(modestr, "MIFMAX"))
-        {
-            MACSIO_LOG_MSG(Warn, ("Exodus plugin supports only MIFMAX mode"));
-        }
+            use_sif = 1;
         numGroups = size;
     }
 
+    /* Element blocks, dimensions and variable names all come from a task's parts */
+    if (json_object_array_length(JsonGetObj(main_obj, "problem/parts")) == 0)
+        MACSIO_LOG_MSG(Die, ("Exodus plugin needs at least one part on every task. "
+                             "Set --avg_num_parts to 1 or more."));
+
     get_exodus_global_init_params(main_obj, dumpn, dumpt, &ex_globals);
 
+    if (use_sif)
+    {
+        main_dump_sif(main_obj, dumpn, dumpt, &ex_globals);
+        free_exodus_global_init_params(&ex_globals);
+        return;
+    }
+
+    if (numGroups < 1 || numGroups > size)
+    {
+        MACSIO_LOG_MSG(Warn, ("Using %d files instead of %d", size, numGroups));
+        numGroups = size;
+    }
+
     bat = MACSIO_MIF_Init(numGroups, ioFlags, MACSIO_MAIN_Comm, 1,
         CreateExodusFile, OpenExodusFile, CloseExodusFile, &ex_globals);
 
+    /* Size the file for all the tasks sharing it */
+    get_exodus_group_init_params(bat, rank, size, &ex_globals);
+    set_exodus_file_creation_flags(main_obj, &ex_globals);
+
     /* Construct name for the file */
     sprintf(fileName, "%s_exodus_%05d.%s",
         JsonGetStr(main_obj, "clargs/filebase"),
@@ -596,14 +899,21 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
      * the group when that processor calls "HandOffBaton" */
     exoid_ptr = (int *) MACSIO_MIF_WaitForBaton(bat, fileName, 0);
 
-    write_mesh_coords_all_parts(*exoid_ptr, &ex_globals,
-        JsonGetObj(main_obj, "problem/parts"), &elem_block_coord_offsets);
+    if (!exoid_ptr)
+        MACSIO_LOG_MSG(Die, ("Unable to create or open \"%s\"", fileName));
+
+    /* The mesh doesn't change so it is written only with the first dump */
+    if (dumpn == 0)
+        write_mesh_coords_all_parts(*exoid_ptr, &ex_globals,
+            JsonGetObj(main_obj, "problem/parts"), &elem_block_coord_offsets);
 
     int numParts = JsonGetInt(main_obj, "problem/parts"); /* returns array length */
     for (int i = 0; i < numParts; i++)
     {
         json_object *this_part = JsonGetObj(main_obj, "problem/parts", i);
-        write_mesh_part_blocks_and_vars(*exoid_ptr, &ex_globals, this_part, elem_block_coord_offsets[i], dumpn, dumpt);
+        if (dumpn == 0)
+            write_mesh_part_block(*exoid_ptr, &ex_globals, this_part, elem_block_coord_offsets[i]);
+        write_mesh_part_vars(*exoid_ptr, &ex_globals, this_part, dumpn);
     }
     if (elem_block_coord_offsets) free(elem_block_coord_offsets);
 
@@ -629,6 +939,8 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
 
     /* We're done using MACSIO_MIF, so finish it off */
     MACSIO_MIF_Finish(bat);
+
+    free_exodus_global_init_params(&ex_globals);
 }
 
 static int register_this_interface()
@@ -24,11 +24,16 @@ this program; if not, write to the Free Software Foundation, Inc., 59 Temple
 Place, Suite 330, Boston, MA 02111-1307 USA
 */
 
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <json-cwx/json.h>
 
@@ -37,6 +42,9 @@ Place, Suite 330, Boston, MA 02111-1307 USA
 #include <macsio_log.h>
 #include <macsio_main.h>
 #include <macsio_mif.h>
+#include <macsio_msf.h>
+#include <macsio_agg.h>
+#include <macsio_hdf5_load.h>
 #include <macsio_timing.h>
 #include <macsio_utils.h>
 
@@ -51,6 +59,14 @@ Place, Suite 330, Boston, MA 02111-1307 USA
 #include <H5pubconf.h>
 #include <hdf5.h>
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZFP
+#include <zfp.h>
+#endif
+
 /*! \brief H5Z-ZFP generic interface for setting rate mode */
 #define H5Pset_zfp_rate_cdata(R, N, CD)          \
 do { if (N>=4) {double *p = (double *) &CD[2];   \
@@ -95,6 +111,27 @@ static char const *iface_ext = "h5";
 static int use_log = 0; /**< Use HDF5's logging fapl */
 static int no_collective = 0; /**< Use HDF5 independent (e.g. not collective) I/O */
 static int no_single_chunk = 0; /**< disable single chunking */
+static int node_aggregate = 0; /**< Aggregate to one writer per node in SIF/MSF modes */
+static int time_series = 0; /**< Append dumps to extendible datasets of one file in SIF/MSF modes */
+static int use_swmr = 0; /**< Write time-series files in SWMR mode */
+static hid_t ts_file_id = -1; /**< Time-series file kept open between dumps */
+static hsize_t ts_step = 0; /**< Next time slice of the time-series file */
+static char core_staging_str[64] = "none"; /**< Build MIF files in memory and flush each in one write */
+static int core_increment = 1<<21; /**< Memory increment of the core VFD */
+static char template_mode_str[64] = "none"; /**< Reuse the first dump's MIF files as templates */
+static int subfiling = 0; /**< Use the subfiling VFD in SIF/MSF modes */
+static int subfiling_stripe_size = 0; /**< Subfiling stripe size in bytes */
+static int subfiling_iocs_per_node = 0; /**< Subfiling I/O concentrators per node */
+static int template_direct = 0; /**< Overwrite template raw data without HDF5 */
+static int precompress_threads = 0; /**< Threads per task pre-compressing chunks in MIF mode */
+static int alignment = 0; /**< HDF5 file object alignment from MACSio's --alignment */
+static int align_threshold = 1; /**< Threshold size of objects to align */
+static char fs_strategy_str[64] = "default"; /**< HDF5 file space strategy */
+static int fs_page_size = 0; /**< HDF5 file space page size for the page strategy */
+static int page_buffer_size = 0; /**< HDF5 page buffer size */
+static int coll_metadata = 0; /**< Use collective metadata reads and writes */
+static int mdc_image = 0; /**< Write a metadata cache image at file close */
+static char mdc_config_str[64] = "mainzer"; /**< Metadata cache configuration */
 static int silo_block_size = 0; /**< block size for silo block-based VFD */
 static int silo_block_count = 0; /**< block count for silo block-based VFD */
 static int sbuf_size = -1; /**< HDF5 library sieve buf size */
@@ -107,6 +144,93 @@ static hid_t dspc = -1;
 static int show_errors = 0;
 static char compression_alg_str[64];
 static char compression_params_str[512];
+static char chunk_policy_str[64] = "single"; /**< How chunk dimensions are chosen */
+static int chunk_bytes = 1<<20; /**< Target chunk size, in bytes, for chunk policies */
+
+/*! \brief create HDF5 library file creation property list */
+static hid_t make_fcpl()
+{
+    hid_t fcpl_id = H5Pcreate(H5P_FILE_CREATE);
+
+#if H5_VERSION_GE(1,10,1)
+    H5F_fspace_strategy_t strategy;
+    int have_strategy = 1;
+
+    if (!strcasecmp(fs_strategy_str, "page"))
+        strategy = H5F_FSPACE_STRATEGY_PAGE;
+    else if (!strcasecmp(fs_strategy_str, "fsm_aggr"))
+        strategy = H5F_FSPACE_STRATEGY_FSM_AGGR;
+    else if (!strcasecmp(fs_strategy_str, "aggr"))
+        strategy = H5F_FSPACE_STRATEGY_AGGR;
+    else if (!strcasecmp(fs_strategy_str, "none"))
+        strategy = H5F_FSPACE_STRATEGY_NONE;
+    else
+        have_strategy = 0;
+
+    if (have_strategy)
+        H5Pset_file_space_strategy(fcpl_id, strategy, (hbool_t) 0, (hsize_t) 1);
+    if (have_strategy && strategy == H5F_FSPACE_STRATEGY_PAGE && fs_page_size > 0)
+        H5Pset_file_space_page_size(fcpl_id, (hsize_t) fs_page_size);
+#else
+    if (strcasecmp(fs_strategy_str, "default"))
+    {
+        static int have_issued_warning = 0;
+        if (!have_issued_warning)
+            MACSIO_LOG_MSG(Warn, ("--file_space_strategy needs HDF5 1.10.1 or later"));
+        have_issued_warning = 1;
+    }
+#endif
+
+    return fcpl_id;
+}
+
+#if H5_HAVE_PARALLEL
+/*!
+\brief Set the parallel driver of a shared file's access property list
+
+This is the MPI-IO driver unless \c --subfiling asks for HDF5's subfiling VFD.
+*/
+static void
+set_parallel_driver(
+    hid_t fapl_id, /**< file access property list to set */
+    MPI_Comm comm, /**< communicator of the tasks sharing the file */
+    MPI_Info info /**< MPI-IO hints */
+)
+{
+    if (subfiling)
+    {
+#ifdef H5_HAVE_SUBFILING_VFD
+        H5FD_subfiling_config_t config;
+        int provided;
+
+        MPI_Query_thread(&provided);
+        if (provided < MPI_THREAD_MULTIPLE)
+            MACSIO_LOG_MSG(Die, ("--subfiling needs MACSio's --mpi_thread_multiple"));
+
+        /* HDF5 takes the number of I/O concentrators per node only from the environment */
+        if (subfiling_iocs_per_node > 0)
+        {
+            char val[32];
+            snprintf(val, sizeof(val), "%d", subfiling_iocs_per_node);
+            setenv(H5FD_SUBFILING_IOC_PER_NODE, val, 1);
+        }
+
+        H5Pset_mpi_params(fapl_id, comm, info);
+        H5Pget_fapl_subfiling(fapl_id, &config);
+        if (subfiling_stripe_size > 0)
+            config.shared_cfg.stripe_size = (int64_t) subfiling_stripe_size;
+        H5Pset_fapl_subfiling(fapl_id, &config);
+        return;
+#else
+        static int have_issued_warning = 0;
+        if (!have_issued_warning)
+            MACSIO_LOG_MSG(Warn, ("HDF5 library lacks the subfiling VFD; using MPI-IO"));
+        have_issued_warning = 1;
+#endif
+    }
+    H5Pset_fapl_mpio(fapl_id, comm, info);
+}
+#endif
 
 /*! \brief create HDF5 library file access property list */
 static hid_t make_fapl()
@@ -123,6 +247,9 @@ static hid_t make_fapl()
     if (rbuf_size >= 0)
         h5status |= H5Pset_small_data_block_size(fapl_id, mbuf_size);
 
+    if (alignment > 0)
+        h5status |= H5Pset_alignment(fapl_id, (hsize_t) align_threshold, (hsize_t) alignment);
+
 #if 0
     if (silo_block_size && silo_block_count)
     {
@@ -142,23 +269,44 @@ static hid_t make_fapl()
     }
 #endif
 
+    if (!strcasecmp(mdc_config_str, "mainzer"))
     {
         H5AC_cache_config_t config;
 
         /* Acquire a default mdc config struct */
         config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
         H5Pget_mdc_config(fapl_id, &config);
-#define MAINZER_PARAMS 1
-#if MAINZER_PARAMS
         config.set_initial_size = (hbool_t) 1;
         config.initial_size = 16 * 1024;
         config.min_size = 8 * 1024;
         config.epoch_length = 3000;
         config.lower_hr_threshold = 0.95;
-#endif
         H5Pset_mdc_config(fapl_id, &config);
     }
 
+#if H5_VERSION_GE(1,10,1)
+    if (page_buffer_size > 0)
+        h5status |= H5Pset_page_buffer_size(fapl_id, (size_t) page_buffer_size, 0, 0);
+
+    if (mdc_image)
+    {
+        H5AC_cache_image_config_t image_config;
+        image_config.version = H5AC__CURR_CACHE_IMAGE_CONFIG_VERSION;
+        image_config.generate_image = (hbool_t) 1;
+        image_config.save_resize_status = (hbool_t) 0;
+        image_config.entry_ageout = H5AC__CACHE_IMAGE__ENTRY_AGEOUT__NONE;
+        h5status |= H5Pset_mdc_image_config(fapl_id, &image_config);
+    }
+#endif
+
+#if H5_HAVE_PARALLEL
+    if (coll_metadata)
+    {
+        h5status |= H5Pset_coll_metadata_write(fapl_id, (hbool_t) 1);
+        h5status |= H5Pset_all_coll_metadata_ops(fapl_id, (hbool_t) 1);
+    }
+#endif
+
     if (h5status < 0)
     {
         if (fapl_id >= 0)
@@ -208,14 +356,80 @@ get_tokval(
     return 1;
 }
 
+/*!
+\brief Choose chunk dimensions according to \c --chunk_policy
+
+For the \c size policy, all dimensions of the dataset are shrunk by the same
+factor to get near \c --chunk_bytes. For the \c part policy, chunks start out
+the size of a part so that chunk boundaries coincide with part boundaries. If that
+is bigger than \c --chunk_bytes, the largest dimension is repeatedly divided by
+its smallest factor so that chunks still tile each part exactly. Node-centered
+datasets get chunks the size of a part's nodes. Since neighboring parts share
+their boundary nodes, those chunks cannot tile the parts exactly and a part's
+nodes span up to two chunks in each dimension.
+*/
+static void
+choose_chunk_dims(
+    int ndims, /**< number of dimensions of the dataset */
+    hsize_t const *dims, /**< dimensions of the dataset */
+    hsize_t const *part_dims, /**< dimensions of a part (HDF5 order) or null if dataset is one part */
+    size_t valsize, /**< size, in bytes, of one value */
+    hsize_t *chunk_dims /**< [out] chosen chunk dimensions */
+)
+{
+    int i;
+    hsize_t target = (hsize_t) chunk_bytes / (valsize ? valsize : 1);
+    hsize_t nvals = 1;
+
+    for (i = 0; i < ndims; i++)
+    {
+        chunk_dims[i] = dims[i];
+        if (!strcasecmp(chunk_policy_str, "part") && part_dims && part_dims[i] > 0 && part_dims[i] < dims[i])
+            chunk_dims[i] = part_dims[i];
+        if (chunk_dims[i] == 0) chunk_dims[i] = 1;
+        nvals *= chunk_dims[i];
+    }
+
+    if (!strcasecmp(chunk_policy_str, "single") || target < 1)
+        return;
+
+    if (!strcasecmp(chunk_policy_str, "size"))
+    {
+        double scale = pow((double) target / nvals, 1.0 / ndims);
+        if (scale >= 1) return;
+        for (i = 0; i < ndims; i++)
+        {
+            chunk_dims[i] = (hsize_t) (chunk_dims[i] * scale);
+            if (chunk_dims[i] == 0) chunk_dims[i] = 1;
+        }
+        return;
+    }
+
+    /* part policy: split the largest dimension by its smallest factor until small enough */
+    while (nvals > target)
+    {
+        hsize_t f;
+        int big = 0;
+        for (i = 1; i < ndims; i++)
+            if (chunk_dims[i] > chunk_dims[big]) big = i;
+        if (chunk_dims[big] == 1) break;
+        for (f = 2; f * f <= chunk_dims[big] && chunk_dims[big] % f; f++);
+        if (f * f > chunk_dims[big]) f = 2; /* prime, just halve it */
+        nvals /= chunk_dims[big];
+        chunk_dims[big] = (chunk_dims[big] + f - 1) / f;
+        nvals *= chunk_dims[big];
+    }
+}
+
 /*!
 \brief create HDF5 library dataset creation property list
 
 If the dataset size is below the \c minsize threshold, no special
 storage layout or compression action is taken.
 
-Chunking is initially set to \em single-chunk. However, for szip
-compressor, chunking can be set by command-line arguments.
+Chunk dimensions are chosen by choose_chunk_dims() according to
+\c --chunk_policy, which defaults to \em single-chunk. However, for szip
+compressor, chunking can also be set by command-line arguments.
 
 */
 static hid_t
@@ -223,7 +437,8 @@ make_dcpl(
     char const *alg_str, /**< compression algorithm string */
     char const *params_str, /**< compression params string */
     hid_t space_id, /**< HDF5 dataspace id for the dataset */
-    hid_t dtype_id /**< HDF5 datatype id for the dataset */
+    hid_t dtype_id, /**< HDF5 datatype id for the dataset */
+    hsize_t const *part_dims /**< dimensions of a part in the dataset or null if it is one part */
 )
 {
     int shuffle = -1;
@@ -235,8 +450,8 @@ make_dcpl(
     float zfp_accuracy = -1;
     char szip_method[64], szip_chunk_str[64];
     char *token, *string, *tofree;
-    int ndims;
-    hsize_t dims[4], maxdims[4];
+    int i, ndims;
+    hsize_t dims[4], maxdims[4], chunk_dims[4];
     hid_t retval = H5Pcreate(H5P_DATASET_CREATE);
 
     szip_method[0] = '\0';
@@ -245,11 +460,27 @@ make_dcpl(
     /* Initially, set contiguous layout. May reset to chunked later */
     H5Pset_layout(retval, H5D_CONTIGUOUS);
 
-    if (!alg_str || !strlen(alg_str))
-        return retval;
-
     ndims = H5Sget_simple_extent_ndims(space_id);
     H5Sget_simple_extent_dims(space_id, dims, maxdims);
+    choose_chunk_dims(ndims, dims, part_dims, H5Tget_size(dtype_id), chunk_dims);
+
+    /* Extendible datasets must be chunked whatever else is asked for */
+    for (i = 0; i < ndims; i++)
+    {
+        if (maxdims[i] == H5S_UNLIMITED)
+        {
+            H5Pset_chunk(retval, ndims, chunk_dims);
+            break;
+        }
+    }
+
+    if (!alg_str || !strlen(alg_str))
+    {
+        /* Chunk even without compression if a policy other than single is asked for */
+        if (strcasecmp(chunk_policy_str, "single") && ndims > 0)
+            H5Pset_chunk(retval, ndims, chunk_dims);
+        return retval;
+    }
 
     /* We can make a pass through params string without being specific about
        algorithm because there are presently no symbol collisions there */
@@ -287,8 +518,8 @@ make_dcpl(
      */
  
     /* Initially, as a default in case nothing else is selected,
-       set chunk size equal to dataset size (e.g. single chunk) */
-    H5Pset_chunk(retval, ndims, dims);
+       set chunk size according to the chunk policy */
+    H5Pset_chunk(retval, ndims, chunk_dims);
 
     if (!strncasecmp(alg_str, "gzip", 4))
     {
@@ -378,6 +609,11 @@ process_args(
 
     char *c_alg = compression_alg_str;
     char *c_params = compression_params_str;
+    char *c_policy = chunk_policy_str;
+    char *c_fs_strategy = fs_strategy_str;
+    char *c_mdc_config = mdc_config_str;
+    char *c_core_staging = core_staging_str;
+    char *c_template_mode = template_mode_str;
 
     MACSIO_CLARGS_ProcessCmdline(0, argFlags, argi, argc, argv,
         "--show_errors", "",
@@ -447,6 +683,43 @@ process_args(
         "--no_collective", "",
             "Use independent, not collective, I/O calls in SIF mode.",
             &no_collective,
+        "--node_aggregate", "",
+            "In SIF and MSF modes, have tasks on the same node place their data\n"
+            "in an MPI shared memory window and only one task per node open the\n"
+            "file and write on behalf of all of them (see MACSIO_AGG).",
+            &node_aggregate,
+        "--time_series", "",
+            "In SIF and MSF modes, keep one file open for all dumps and append each\n"
+            "dump as a new slice of extendible datasets whose slowest dimension is\n"
+            "time instead of creating a file per dump.",
+            &time_series,
+        "--swmr", "",
+            "With --time_series, let readers follow along while the file is written\n"
+            "(see H5Fstart_swmr_write). HDF5 supports this only for files written by\n"
+            "one task, i.e. MSF groups of one task or node aggregation on one node.\n"
+            "Variables appearing after the first dump cannot be added in this mode.",
+            &use_swmr,
+        "--chunk_policy %s", "single",
+            "How to choose chunk dimensions of chunked datasets. Datasets are chunked\n"
+            "whenever compression is used or the policy is other than 'single'.\n"
+            "    single : one chunk the size of the whole dataset.\n"
+            "    size : chunks of about --chunk_bytes with the dataset's aspect ratio.\n"
+            "    part : chunks aligned with mesh part boundaries in SIF/MSF datasets.\n"
+            "        A part's extent is split evenly, if needed, so that chunks are no\n"
+            "        bigger than --chunk_bytes. In MIF mode, a dataset is one part.\n"
+            "An explicit szip chunk= parameter overrides the policy.",
+            &c_policy,
+        "--chunk_bytes %d", "1048576",
+            "Target size, in bytes, of chunks for the 'size' and 'part' chunk policies.",
+            &chunk_bytes,
+        "--precompress_threads %d", "0",
+            "In MIF mode, compress each dataset's chunks ahead of time on this many\n"
+            "threads per task and write them with H5Dwrite_chunk, bypassing the\n"
+            "HDF5 filter pipeline on write. The files are still read through the\n"
+            "normal pipeline. Applies to gzip (with or without shuffle) and, when\n"
+            "built with the ZFP library, zfp. Other filters fall back to the normal\n"
+            "H5Dwrite. Zero (the default) disables pre-compression.",
+            &precompress_threads,
         "--no_single_chunk", "",
             "Do not single chunk the datasets (currently ignored).",
             &no_single_chunk,
@@ -460,6 +733,61 @@ process_args(
             "Specify threshold size for data blocks considered to be 'small'\n"
             "(see H5Pset_small_data_block_size)",
             &rbuf_size,
+        "--align_threshold %d", "1",
+            "Only objects at least this many bytes are aligned by MACSio's --alignment\n"
+            "(see H5Pset_alignment).",
+            &align_threshold,
+        "--file_space_strategy %s %d", "default 0",
+            "File space strategy (see H5Pset_file_space_strategy) and, for the 'page'\n"
+            "strategy, the page size in bytes (0 for the library default). Strategies\n"
+            "are 'default' (leave as is), 'fsm_aggr', 'page', 'aggr' and 'none'.",
+            &c_fs_strategy, &fs_page_size,
+        "--page_buffer_size %d", "0",
+            "Size of the page buffer (see H5Pset_page_buffer_size). Needs the 'page'\n"
+            "file space strategy. 0 disables it.",
+            &page_buffer_size,
+        "--collective_metadata", "",
+            "Do metadata reads and writes collectively in SIF/MSF modes (see\n"
+            "H5Pset_all_coll_metadata_ops and H5Pset_coll_metadata_write).",
+            &coll_metadata,
+        "--mdc_image", "",
+            "Write a metadata cache image when closing files (see\n"
+            "H5Pset_mdc_image_config). The library ignores this in parallel writes.",
+            &mdc_image,
+        "--mdc_config %s", "mainzer",
+            "Metadata cache configuration. 'mainzer' uses a small initial cache\n"
+            "tuned for many small files and 'default' leaves the library default.",
+            &c_mdc_config,
+        "--core_staging %s %d", "none 2097152",
+            "In MIF mode, the last task of each group loads its group's file into\n"
+            "memory with the core VFD (growing by the given increment in bytes),\n"
+            "adds its part and then writes the whole file with a single write.\n"
+            "Earlier tasks write their parts directly. 'sync' waits for the write.\n"
+            "'async' leaves it in flight until the task's next dump. 'none' disables\n"
+            "staging.",
+            &c_core_staging, &core_increment,
+        "--template %s", "none",
+            "In MIF mode, keep the first dump's files as templates of the file layout.\n"
+            "Later dumps with the same layout either 'copy' the template to a new file\n"
+            "or overwrite it 'inplace', in both cases only opening the existing groups\n"
+            "and datasets and writing their raw data. 'none' creates every file anew.",
+            &c_template_mode,
+        "--template_direct", "",
+            "With --template, write raw data straight to the datasets' file offsets\n"
+            "recorded in the first dump instead of through HDF5. This needs contiguous\n"
+            "datasets (no compression and the single chunk policy).",
+            &template_direct,
+        "--subfiling", "",
+            "In SIF and MSF modes, write (and read) through HDF5's subfiling VFD. The\n"
+            "logical file is backed by node-local subfiles written by I/O concentrators.\n"
+            "Needs HDF5 1.14 built with subfiling and MACSio's --mpi_thread_multiple.",
+            &subfiling,
+        "--subfiling_stripe_size %d", "0",
+            "Subfiling stripe size in bytes (0 for HDF5's default).",
+            &subfiling_stripe_size,
+        "--subfiling_iocs_per_node %d", "0",
+            "Subfiling I/O concentrators per node (0 for HDF5's default).",
+            &subfiling_iocs_per_node,
         "--log", "",
             "Use logging Virtual File Driver (see H5Pset_fapl_log)",
             &use_log,
@@ -475,79 +803,447 @@ process_args(
     return 0;
 }
 
-/*! \brief Single shared file implementation of main dump */
+#ifdef HAVE_MPI
+/*! \brief Compute a part's hyperslab in a group-global dataset (HDF5 order) */
 static void
-main_dump_sif(
+get_part_selection(
+    json_object *part_obj, /**< the part whose selection is computed */
+    int ndims, /**< number of logical dimensions in the mesh */
+    int is_zonal, /**< flag indicating the variable is zone-centered */
+    hsize_t const *origin, /**< global origin of the dataset (HDF5 order) */
+    hsize_t *starts, /**< [out] hyperslab starts (HDF5 order) */
+    hsize_t *counts /**< [out] hyperslab counts (HDF5 order) */
+)
+{
+    int i;
+    json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
+    json_object *global_log_origin_array =
+        json_object_path_get_array(part_obj, "GlobalLogOrigin");
+    json_object *global_log_indices_array =
+        json_object_path_get_array(part_obj, "GlobalLogIndices");
+    json_object *mesh_dims_array = json_object_path_get_array(mesh_obj, "LogDims");
+    for (i = 0; i < ndims; i++)
+    {
+        starts[ndims-1-i] =
+            json_object_get_int(json_object_array_get_idx(global_log_origin_array,i));
+        counts[ndims-1-i] =
+            json_object_get_int(json_object_array_get_idx(mesh_dims_array,i));
+        if (is_zonal)
+        {
+            counts[ndims-1-i]--;
+            starts[ndims-1-i] -=
+                json_object_get_int(json_object_array_get_idx(global_log_indices_array,i));
+        }
+        starts[ndims-1-i] -= origin[ndims-1-i];
+    }
+}
+
+/*!
+\brief Place all of this task's parts' variables in the node's shared window
+
+Each (variable, part) pair becomes one \ref MACSIO_AGG piece whose id is the
+variable's index and whose starts/counts are its hyperslab in the file dataset.
+*/
+static MACSIO_AGG_t *
+aggregate_parts(
     json_object *main_obj, /**< main json data object to dump */
-    int dumpn, /**< dump number (like a cycle number) */
-    double dumpt /**< dump time */
+    MPI_Comm comm, /**< communicator of the tasks sharing the file */
+    int ndims, /**< number of logical dimensions in the mesh */
+    hsize_t const *origin_nodal, /**< global origin of node-centered datasets (HDF5 order) */
+    hsize_t const *origin_zonal /**< global origin of zone-centered datasets (HDF5 order) */
 )
 {
-    MACSIO_TIMING_GroupMask_t main_dump_sif_grp = MACSIO_TIMING_GroupMask("main_dump_sif");
-    MACSIO_TIMING_TimerId_t main_dump_sif_tid;
+    int i, v, p, pass;
+    int npieces = 0;
+    size_t nbytes = 0;
+    MACSIO_AGG_t *agg = 0;
+    json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
+
+    /* First pass sizes the window, second pass fills it */
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (p = 0; p < json_object_array_length(part_array); p++)
+        {
+            json_object *part_obj = json_object_array_get_idx(part_array, p);
+            json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
+            for (v = 0; v < json_object_array_length(vars_array); v++)
+            {
+                json_object *var_obj = json_object_array_get_idx(vars_array, v);
+                json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
+                size_t valsize = json_object_extarr_type(extarr_obj)==json_extarr_type_flt64?
+                    sizeof(double):sizeof(int);
+                size_t var_nbytes = json_object_extarr_nvals(extarr_obj) * valsize;
+                int is_zonal = !strcmp(json_object_path_get_string(var_obj, "centering"), "zone");
+                hsize_t starts[3], counts[3];
+                long long llstarts[3], llcounts[3];
+
+                if (pass == 0)
+                {
+                    npieces++;
+                    nbytes += var_nbytes;
+                    continue;
+                }
+
+                get_part_selection(part_obj, ndims, is_zonal,
+                    is_zonal ? origin_zonal : origin_nodal, starts, counts);
+                for (i = 0; i < ndims; i++)
+                {
+                    llstarts[i] = (long long) starts[i];
+                    llcounts[i] = (long long) counts[i];
+                }
+                if (MACSIO_AGG_AddPiece(agg, v, ndims, llstarts, llcounts,
+                        json_object_extarr_data(extarr_obj), var_nbytes))
+                    MACSIO_LOG_MSG(Die, ("Unable to place part %d, var %d in shared window", p, v));
+            }
+        }
+        if (pass == 0)
+            agg = MACSIO_AGG_Init(comm, npieces, nbytes);
+    }
+
+    MACSIO_AGG_Sync(agg);
+    return agg;
+}
+
+/*! \brief Grow the arrays of pieces collected for a var to hold at least \c n */
+static void
+grow_pieces(
+    hsize_t (**starts)[3], /**< [in,out] hyperslab starts of each piece */
+    hsize_t (**counts)[3], /**< [in,out] hyperslab counts of each piece */
+    void const ***bufs, /**< [in,out] data of each piece */
+    int n, /**< number of pieces needed */
+    int *max /**< [in,out] number of pieces allocated */
+)
+{
+    if (n <= *max) return;
+    *max = n < 2 * *max ? 2 * *max : n;
+    *starts = (hsize_t (*)[3]) realloc(*starts, *max * sizeof(**starts));
+    *counts = (hsize_t (*)[3]) realloc(*counts, *max * sizeof(**counts));
+    *bufs = (void const **) realloc(*bufs, *max * sizeof(**bufs));
+}
+
+/* Ascending order of hsize_t values for qsort */
+static int
+compare_hsize(void const *a, void const *b)
+{
+    hsize_t ha = *((hsize_t const *) a), hb = *((hsize_t const *) b);
+    return ha < hb ? -1 : (ha > hb ? 1 : 0);
+}
+
+/*!
+\brief Form one file and one memory selection covering all of a rank's pieces of a var
+
+The file selection is the union (\c H5S_SELECT_OR) of the pieces' hyperslabs,
+at time slice \c step for time-series datasets.
+HDF5 matches memory to file elements in the order each selection iterates, which
+for a union is row-major over the whole extent and not piece by piece. So, the
+pieces are packed back to back into a 1-D buffer in that same order, one
+fastest-varying row of the union at a time, and the memory selection is the
+leading elements of a 1-D dataspace. Where pieces overlap (shared nodes), the
+union holds each element once and the last piece's values are the ones written.
+The buffer is never larger than the pieces themselves, however scattered they are.
+
+\return The packed buffer (to be freed by the caller after the write) or null
+if the rank has no pieces, in which case both selections are empty.
+*/
+static void *
+select_pieces(
+    hid_t ds_id, /**< dataset the pieces are to be written to */
+    int ndims, /**< number of logical dimensions of the pieces */
+    int npieces, /**< number of pieces */
+    hsize_t const (*starts)[3], /**< hyperslab starts of each piece (HDF5 order) */
+    hsize_t const (*counts)[3], /**< hyperslab counts of each piece (HDF5 order) */
+    void const * const *bufs, /**< data of each piece */
+    size_t valsize, /**< size, in bytes, of one value */
+    hssize_t step, /**< time slice of a time-series dataset or -1 if not time-series */
+    hid_t *fspace_id, /**< [out] file selection */
+    hid_t *mspace_id /**< [out] memory selection */
+)
+{
+    int i, d, b, ncover, nbrk;
+    hsize_t fstarts[4] = {0, 0, 0, 0}, fcounts[4] = {1, 1, 1, 1};
+    hsize_t (*ps)[3], (*pc)[3], *brk, x, y, total = 0, npacked = 0, zero = 0;
+    hsize_t lo[2], hi[2];
+    int *cover;
+    int t = step >= 0 ? 1 : 0;
+    char *pack = 0;
+
+    *fspace_id = H5Dget_space(ds_id);
+    if (npieces == 0)
+    {
+        hsize_t one = 1;
+        H5Sselect_none(*fspace_id);
+        *mspace_id = H5Screate_simple(1, &one, 0);
+        H5Sselect_none(*mspace_id);
+        return 0;
+    }
+
+    /* Pad the pieces to 3 dimensions (slowest first) and select them in the file */
+    ps = (hsize_t (*)[3]) malloc(npieces * sizeof(*ps));
+    pc = (hsize_t (*)[3]) malloc(npieces * sizeof(*pc));
+    for (i = 0; i < npieces; i++)
+    {
+        for (d = 0; d < 3; d++)
+        {
+            ps[i][d] = 0;
+            pc[i][d] = 1;
+        }
+        for (d = 0; d < ndims; d++)
+        {
+            ps[i][3-ndims+d] = starts[i][d];
+            pc[i][3-ndims+d] = counts[i][d];
+            fstarts[t+d] = starts[i][d];
+            fcounts[t+d] = counts[i][d];
+        }
+        if (t)
+            fstarts[0] = (hsize_t) step;
+        total += pc[i][0] * pc[i][1] * pc[i][2];
+        H5Sselect_hyperslab(*fspace_id, i ? H5S_SELECT_OR : H5S_SELECT_SET, fstarts, 0, fcounts, 0);
+    }
+
+    /* Range of rows (the two slower dimensions) any piece touches */
+    for (d = 0; d < 2; d++)
+    {
+        lo[d] = ps[0][d];
+        hi[d] = ps[0][d] + pc[0][d];
+        for (i = 1; i < npieces; i++)
+        {
+            if (ps[i][d] < lo[d]) lo[d] = ps[i][d];
+            if (ps[i][d] + pc[i][d] > hi[d]) hi[d] = ps[i][d] + pc[i][d];
+        }
+    }
+
+    pack = (char *) malloc(total * valsize);
+    cover = (int *) malloc(npieces * sizeof(int));
+    brk = (hsize_t *) malloc(2 * npieces * sizeof(hsize_t));
+    for (x = lo[0]; x < hi[0]; x++)
+    {
+        for (y = lo[1]; y < hi[1]; y++)
+        {
+            /* Pieces crossing this row and where their runs along it start and end */
+            ncover = nbrk = 0;
+            for (i = 0; i < npieces; i++)
+            {
+                if (x < ps[i][0] || x >= ps[i][0] + pc[i][0] ||
+                    y < ps[i][1] || y >= ps[i][1] + pc[i][1])
+                    continue;
+                cover[ncover++] = i;
+                brk[nbrk++] = ps[i][2];
+                brk[nbrk++] = ps[i][2] + pc[i][2];
+            }
+            if (ncover == 0)
+                continue;
+            qsort(brk, nbrk, sizeof(hsize_t), compare_hsize);
+
+            /* Copy each stretch between breaks from the last piece covering it */
+            for (b = 0; b + 1 < nbrk; b++)
+            {
+                hsize_t s = brk[b], e = brk[b+1];
+                int owner = -1;
+                if (s == e)
+                    continue;
+                for (i = 0; i < ncover; i++)
+                {
+                    if (ps[cover[i]][2] <= s && e <= ps[cover[i]][2] + pc[cover[i]][2])
+                        owner = cover[i];
+                }
+                if (owner < 0)
+                    continue;
+                memcpy(pack + npacked * valsize, (char const *) bufs[owner] +
+                    (((x - ps[owner][0]) * pc[owner][1] + (y - ps[owner][1])) * pc[owner][2] +
+                    (s - ps[owner][2])) * valsize, (e - s) * valsize);
+                npacked += e - s;
+            }
+        }
+    }
+    free(brk);
+    free(cover);
+    free(ps);
+    free(pc);
+
+    if (npacked != (hsize_t) H5Sget_select_npoints(*fspace_id))
+        MACSIO_LOG_MSG(Die, ("Packed %llu values for a selection of %llu",
+            (unsigned long long) npacked, (unsigned long long) H5Sget_select_npoints(*fspace_id)));
+
+    *mspace_id = H5Screate_simple(1, &total, 0);
+    H5Sselect_hyperslab(*mspace_id, H5S_SELECT_SET, &zero, 0, &npacked, 0);
+
+    return pack;
+}
+
+/*!
+\brief Write all parts' variables to group-global datasets in a shared file
+
+This is the work-horse for both SIF and MSF modes. All tasks in \c comm call
+this collectively. Each variable is written to a single dataset of extent
+\c dims_nodal or \c dims_zonal (depending on the variable's centering) and each
+part is written into it with a hyperslab selection at the part's global logical
+origin less \c origin_nodal or \c origin_zonal.
+
+In SIF mode, \c comm is MACSIO_MAIN_Comm, the datasets span the whole global mesh
+and the origins are zero. In MSF mode, \c comm is a group's communicator and the
+datasets span only the bounding box of the group's parts. In that case, the
+origins are non-zero and recorded as a \c GlobalLogOrigin attribute on each
+dataset so that readers can place the group's data in the global mesh.
+
+With \c --node_aggregate, tasks first place their data in a per-node shared
+memory window and only one task per node opens the file and writes all of
+its node's pieces.
+
+Each rank writes all of its pieces of a variable with a single selection (see
+select_pieces()). With HDF5 1.14 or later, all variables are then written in
+one \c H5Dwrite_multi call. Otherwise, there is one \c H5Dwrite per variable.
+
+With \c --time_series, the file is created on the first dump and kept open.
+Datasets get a leading, unlimited time dimension (all dimensions are extendible
+so that growing variables also fit) and each dump is written to the next time
+slice after an \c H5Dset_extent. The file is flushed after each dump and closed
+after the last one.
+*/
+static void
+write_shared_file(
+    json_object *main_obj, /**< main json data object to dump */
+    MPI_Comm comm, /**< communicator of the tasks sharing the file */
+    char const *fileName, /**< name of the shared file to create */
+    int ndims, /**< number of logical dimensions in the mesh */
+    hsize_t const *dims_nodal, /**< extent of node-centered datasets (HDF5 order) */
+    hsize_t const *dims_zonal, /**< extent of zone-centered datasets (HDF5 order) */
+    hsize_t const *origin_nodal, /**< global origin of node-centered datasets (HDF5 order) */
+    hsize_t const *origin_zonal, /**< global origin of zone-centered datasets (HDF5 order) */
+    int write_origin_attr, /**< flag to record the origins as dataset attributes */
+    MACSIO_TIMING_GroupMask_t grp, /**< timing group to use for timers here */
+    int dumpn /**< dump number (like a cycle number) */
+)
+{
+    MACSIO_TIMING_TimerId_t tid;
     double timer_dt;
 
-#ifdef HAVE_MPI
-    int ndims;
-    int i, v, p;
-    char const *mesh_type = json_object_path_get_string(main_obj, "clargs/part_type");
-    char fileName[256];
-    int use_part_count;
+    int i, d, v, p, nvars, comm_size;
+    int npieces, max_pieces = 0;
+    hsize_t (*piece_starts)[3] = 0, (*piece_counts)[3] = 0;
+    void const **piece_bufs = 0;
+    hid_t *ds_ids, *dtype_ids, *fspace_ids, *mspace_ids;
+    void **pack_bufs;
+    hsize_t part_dims[2][4]; /* nodal, zonal */
 
-    hid_t h5file_id;
+    hid_t h5file_id = ts_file_id;
     hid_t fapl_id = make_fapl();
+    hid_t fcpl_id = make_fcpl();
+    int fdims = time_series ? ndims + 1 : ndims; /* file dataset rank */
+    hsize_t fdims_nodal[4], fdims_zonal[4], fmaxdims[4];
     hid_t dxpl_id = H5Pcreate(H5P_DATASET_XFER);
-    hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
     hid_t null_space_id = H5Screate(H5S_NULL);
     hid_t fspace_nodal_id, fspace_zonal_id;
-    hsize_t global_log_dims_nodal[3];
-    hsize_t global_log_dims_zonal[3];
 
-    MPI_Info mpiInfo = MPI_INFO_NULL;
+    MPI_Info mpiInfo = MACSIO_UTILS_MPIInfoFromHints(JsonGetStr(main_obj, "clargs/mpi_hints"));
+    MACSIO_AGG_t *agg = 0;
+
+    if (node_aggregate)
+    {
+        tid = MT_StartTimer("MACSIO_AGG_Init", grp, dumpn);
+        agg = aggregate_parts(main_obj, comm, ndims, origin_nodal, origin_zonal);
+        timer_dt = MT_StopTimer(tid);
+
+        /* Non-writers are done once their data is in the node's window */
+        if (!MACSIO_AGG_IsWriter(agg))
+        {
+            if (mpiInfo != MPI_INFO_NULL)
+                MPI_Info_free(&mpiInfo);
+            MACSIO_AGG_Finish(agg);
+            H5Pclose(fcpl_id);
+            H5Sclose(null_space_id);
+            H5Pclose(dxpl_id);
+            H5Pclose(fapl_id);
+            return;
+        }
+        comm = MACSIO_AGG_WriterComm(agg);
+    }
 
 //#warning WE ARE DOING SIF SLIGHTLY WRONG, DUPLICATING SHARED NODES
 //#warning INCLUDE ARGS FOR ISTORE AND K_SYM
-//#warning INCLUDE ARG PROCESS FOR HINTS
-//#warning FAPL PROPS: ALIGNMENT 
+    MPI_Comm_size(comm, &comm_size);
+    if (use_swmr && time_series && comm_size > 1)
+    {
+        static int have_issued_warning = 0;
+        if (!have_issued_warning)
+            MACSIO_LOG_MSG(Warn, ("--swmr ignored for files written by more than one task"));
+        have_issued_warning = 1;
+    }
 #if H5_HAVE_PARALLEL
-    H5Pset_fapl_mpio(fapl_id, MACSIO_MAIN_Comm, mpiInfo);
+    if (!(use_swmr && time_series && comm_size == 1))
+        set_parallel_driver(fapl_id, comm, mpiInfo);
 #endif
+    if (mpiInfo != MPI_INFO_NULL)
+        MPI_Info_free(&mpiInfo);
 
-//#warning FOR MIF, NEED A FILEROOT ARGUMENT OR CHANGE TO FILEFMT ARGUMENT
-    /* Construct name for the HDF5 file */
-    sprintf(fileName, "%s_hdf5_%03d.%s",
-        json_object_path_get_string(main_obj, "clargs/filebase"),
-        dumpn,
-        json_object_path_get_string(main_obj, "clargs/fileext"));
-
-    MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
-    main_dump_sif_tid = MT_StartTimer("H5Fcreate", main_dump_sif_grp, dumpn);
-    h5file_id = H5Fcreate(fileName, H5F_ACC_TRUNC, H5P_DEFAULT, fapl_id);
-    timer_dt = MT_StopTimer(main_dump_sif_tid);
+    MACSIO_UTILS_RecordOutputFiles(dumpn, (char *) fileName);
+    if (h5file_id < 0)
+    {
+#if H5_VERSION_GE(1,10,0)
+        if (use_swmr && time_series && comm_size == 1)
+            H5Pset_libver_bounds(fapl_id, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+#endif
+        tid = MT_StartTimer("H5Fcreate", grp, dumpn);
+        h5file_id = H5Fcreate(fileName, H5F_ACC_TRUNC, fcpl_id, fapl_id);
+        timer_dt = MT_StopTimer(tid);
+        ts_step = 0;
+    }
+    H5Pclose(fcpl_id);
 
-    /* Create an HDF5 Dataspace for the global whole of mesh and var objects in the file. */
-    ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
-    json_object *global_log_dims_array =
-        json_object_path_get_array(main_obj, "problem/global/LogDims");
-    json_object *global_parts_log_dims_array =
-        json_object_path_get_array(main_obj, "problem/global/PartsLogDims");
-    /* Note that global zonal array is smaller in each dimension by one *ON*EACH*BLOCK*
-       in the associated dimension. */
-    for (i = 0; i < ndims; i++)
+    /* Time-series datasets have a leading time dimension */
+    for (i = 0; i < fdims; i++)
+        fmaxdims[i] = H5S_UNLIMITED;
+    if (time_series)
     {
-        int parts_log_dims_val = JsonGetInt(global_parts_log_dims_array, "", i);
-        global_log_dims_nodal[ndims-1-i] = (hsize_t) JsonGetInt(global_log_dims_array, "", i);
-        global_log_dims_zonal[ndims-1-i] = global_log_dims_nodal[ndims-1-i] -
-            JsonGetInt(global_parts_log_dims_array, "", i);
+        fdims_nodal[0] = fdims_zonal[0] = ts_step + 1;
+        for (i = 0; i < ndims; i++)
+        {
+            fdims_nodal[i+1] = dims_nodal[i];
+            fdims_zonal[i+1] = dims_zonal[i];
+        }
+    }
+    else
+    {
+        for (i = 0; i < ndims; i++)
+        {
+            fdims_nodal[i] = dims_nodal[i];
+            fdims_zonal[i] = dims_zonal[i];
+        }
     }
-    fspace_nodal_id = H5Screate_simple(ndims, global_log_dims_nodal, 0);
-    fspace_zonal_id = H5Screate_simple(ndims, global_log_dims_zonal, 0);
+    fspace_nodal_id = H5Screate_simple(fdims, fdims_nodal, time_series ? fmaxdims : 0);
+    fspace_zonal_id = H5Screate_simple(fdims, fdims_zonal, time_series ? fmaxdims : 0);
 
     /* Get the list of vars on the first part as a guide to loop over vars */
     json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
     json_object *first_part_obj = json_object_array_get_idx(part_array, 0);
     json_object *first_part_vars_array = json_object_path_get_array(first_part_obj, "Vars");
 
+    /* Largest part over all tasks, in nodes and in zones, for the part chunk policy.
+       Every task must pass the same chunk dimensions to the collective H5Dcreate.
+       A time slice of a time-series dataset holds one dump of each part. */
+    for (i = 0; i < 4; i++)
+        part_dims[0][i] = part_dims[1][i] = 0;
+    if (first_part_obj)
+    {
+        hsize_t starts[3], counts[3];
+        for (p = 0; p < 2; p++)
+        {
+            get_part_selection(first_part_obj, ndims, p, p ? origin_zonal : origin_nodal, starts, counts);
+            for (i = 0; i < ndims; i++)
+                part_dims[p][fdims-ndims+i] = counts[i];
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, part_dims, 8, MPI_UNSIGNED_LONG_LONG, MPI_MAX, comm);
+    if (time_series)
+        part_dims[0][0] = part_dims[1][0] = 1;
+
+    /* Datasets, selections and packed buffers of all vars, kept for one multi-dataset write */
+    nvars = json_object_array_length(first_part_vars_array);
+    ds_ids = (hid_t *) calloc(nvars, sizeof(hid_t));
+    dtype_ids = (hid_t *) calloc(nvars, sizeof(hid_t));
+    fspace_ids = (hid_t *) calloc(nvars, sizeof(hid_t));
+    mspace_ids = (hid_t *) calloc(nvars, sizeof(hid_t));
+    pack_bufs = (void **) calloc(nvars, sizeof(void *));
+
     /* Dataset transfer property list used in all H5Dwrite calls */
 #if H5_HAVE_PARALLEL
     if (no_collective)
@@ -557,9 +1253,9 @@ main_dump_sif(
 #endif
 
 
-    /* Loop over vars and then over parts */
+    /* Loop over vars, writing all of a rank's parts of a var together */
     /* currently assumes all vars exist on all ranks. but not all parts */
-    for (v = -1; v < json_object_array_length(first_part_vars_array); v++) /* -1 start is for Mesh */
+    for (v = -1; v < nvars; v++) /* -1 start is for Mesh */
     {
 
 //#warning SKIPPING MESH
@@ -569,100 +1265,512 @@ main_dump_sif(
         json_object *var_obj = json_object_array_get_idx(first_part_vars_array, v);
         char const *varName = json_object_path_get_string(var_obj, "name");
         char *centering = strdup(json_object_path_get_string(var_obj, "centering"));
+        int is_zonal = !strcmp(centering, "zone");
+        hsize_t const *origin = is_zonal ? origin_zonal : origin_nodal;
         json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
 //#warning JUST ASSUMING TWO TYPES NOW. CHANGE TO A FUNCTION
         hid_t dtype_id = json_object_extarr_type(dataobj)==json_extarr_type_flt64? 
                 H5T_NATIVE_DOUBLE:H5T_NATIVE_INT;
-        hid_t fspace_id = H5Scopy(strcmp(centering, "zone") ? fspace_nodal_id : fspace_zonal_id);
-        hid_t dcpl_id = make_dcpl(compression_alg_str, compression_params_str, fspace_id, dtype_id);
+        hid_t fspace_id = H5Scopy(is_zonal ? fspace_zonal_id : fspace_nodal_id);
+        hid_t dcpl_id, ds_id = -1;
+
+        /* A time-series dataset made by an earlier dump gets another time slice */
+        if (time_series && H5Lexists(h5file_id, varName, H5P_DEFAULT) > 0)
+        {
+            hsize_t cur_dims[4], new_dims[4];
+            hid_t cur_space_id;
+            ds_id = H5Dopen2(h5file_id, varName, H5P_DEFAULT);
+            H5Sget_simple_extent_dims(fspace_id, new_dims, 0);
+            cur_space_id = H5Dget_space(ds_id);
+            H5Sget_simple_extent_dims(cur_space_id, cur_dims, 0);
+            H5Sclose(cur_space_id);
+            for (d = 1; d < fdims; d++)
+                if (cur_dims[d] > new_dims[d]) new_dims[d] = cur_dims[d];
+            tid = MT_StartTimer("H5Dset_extent", grp, dumpn);
+            H5Dset_extent(ds_id, new_dims);
+            timer_dt = MT_StopTimer(tid);
+            H5Sclose(fspace_id);
+        }
+        else
+        {
+            dcpl_id = make_dcpl(compression_alg_str, compression_params_str, fspace_id, dtype_id, part_dims[is_zonal]);
 
-        /* Create the file dataset (using old-style H5Dcreate API here) */
+            /* Create the file dataset (using old-style H5Dcreate API here) */
 //#warning USING DEFAULT DCPL: LATER ADD COMPRESSION, ETC.
         
-        main_dump_sif_tid = MT_StartTimer("H5Dcreate", main_dump_sif_grp, dumpn);
-        hid_t ds_id = H5Dcreate1(h5file_id, varName, dtype_id, fspace_id, dcpl_id); 
-        timer_dt = MT_StopTimer(main_dump_sif_tid);
-        H5Sclose(fspace_id);
-        H5Pclose(dcpl_id);
-
-        /* Loop to make write calls for this var for each part on this rank */
-//#warning USE NEW MULTI-DATASET API WHEN AVAILABLE TO AGLOMERATE ALL PARTS INTO ONE CALL
-        use_part_count = (int) ceil(json_object_path_get_double(main_obj, "clargs/avg_num_parts"));
-        for (p = 0; p < use_part_count; p++)
-        {
-            json_object *part_obj = json_object_array_get_idx(part_array, p);
-            json_object *var_obj = 0;
-            hid_t mspace_id = H5Scopy(null_space_id);
-            void const *buf = 0;
+            tid = MT_StartTimer("H5Dcreate", grp, dumpn);
+            ds_id = H5Dcreate1(h5file_id, varName, dtype_id, fspace_id, dcpl_id); 
+            timer_dt = MT_StopTimer(tid);
+            H5Sclose(fspace_id);
+            H5Pclose(dcpl_id);
 
-            fspace_id = H5Scopy(null_space_id);
+            /* Record where this dataset sits in the global mesh */
+            if (write_origin_attr)
+            {
+                hsize_t attr_dims = (hsize_t) ndims;
+                hid_t aspace_id = H5Screate_simple(1, &attr_dims, 0);
+                hid_t attr_id = H5Acreate1(ds_id, "GlobalLogOrigin", H5T_NATIVE_HSIZE, aspace_id, H5P_DEFAULT);
+                H5Awrite(attr_id, H5T_NATIVE_HSIZE, origin);
+                H5Aclose(attr_id);
+                H5Sclose(aspace_id);
+            }
+        }
 
-            /* this rank actually has something to contribute to the H5Dwrite call */
-            if (part_obj)
+        /* Collect this rank's pieces of this var, from its parts or its node's window */
+        npieces = 0;
+        if (agg)
+        {
+            int n, nagg;
+            for (n = 0; n < MACSIO_AGG_NodeSize(agg); n++)
             {
-                int i;
-                hsize_t starts[3], counts[3];
-                json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
-                json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
-                json_object *var_obj = json_object_array_get_idx(vars_array, v);
-                json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
-                json_object *global_log_origin_array =
-                    json_object_path_get_array(part_obj, "GlobalLogOrigin");
-                json_object *global_log_indices_array =
-                    json_object_path_get_array(part_obj, "GlobalLogIndices");
-                json_object *mesh_dims_array = json_object_path_get_array(mesh_obj, "LogDims");
-                for (i = 0; i < ndims; i++)
+                MACSIO_AGG_piece_t const *pieces = MACSIO_AGG_GetPieces(agg, n, &nagg);
+                for (i = 0; i < nagg; i++)
                 {
-                    starts[ndims-1-i] =
-                        json_object_get_int(json_object_array_get_idx(global_log_origin_array,i));
-                    counts[ndims-1-i] =
-                        json_object_get_int(json_object_array_get_idx(mesh_dims_array,i));
-                    if (!strcmp(centering, "zone"))
+                    if (pieces[i].id != v) continue;
+                    grow_pieces(&piece_starts, &piece_counts, &piece_bufs, npieces+1, &max_pieces);
+                    for (d = 0; d < ndims; d++)
                     {
-                        counts[ndims-1-i]--;
-                        starts[ndims-1-i] -=
-                            json_object_get_int(json_object_array_get_idx(global_log_indices_array,i));
+                        piece_starts[npieces][d] = (hsize_t) pieces[i].starts[d];
+                        piece_counts[npieces][d] = (hsize_t) pieces[i].counts[d];
                     }
+                    piece_bufs[npieces++] = MACSIO_AGG_PieceData(agg, n, &pieces[i]);
                 }
-
-                /* set selection of filespace */
-                fspace_id = H5Dget_space(ds_id);
-                main_dump_sif_tid = MT_StartTimer("H5Sselect_hyperslab", main_dump_sif_grp, dumpn);
-                H5Sselect_hyperslab(fspace_id, H5S_SELECT_SET, starts, 0, counts, 0);
-                timer_dt = MT_StopTimer(main_dump_sif_tid);
-
-                /* set dataspace of data in memory */
-                mspace_id = H5Screate_simple(ndims, counts, 0);
-                buf = json_object_extarr_data(extarr_obj);
             }
-
-            main_dump_sif_tid = MT_StartTimer("H5Dwrite", main_dump_sif_grp, dumpn);
-            H5Dwrite(ds_id, dtype_id, mspace_id, fspace_id, dxpl_id, buf);
-            timer_dt = MT_StopTimer(main_dump_sif_tid);
-            H5Sclose(fspace_id);
-            H5Sclose(mspace_id);
-
         }
-
-        H5Dclose(ds_id);
+        else
+        {
+            for (p = 0; p < json_object_array_length(part_array); p++)
+            {
+                json_object *part_obj = json_object_array_get_idx(part_array, p);
+                json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
+                json_object *var_obj = json_object_array_get_idx(vars_array, v);
+                json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
+                grow_pieces(&piece_starts, &piece_counts, &piece_bufs, npieces+1, &max_pieces);
+                get_part_selection(part_obj, ndims, is_zonal, origin,
+                    piece_starts[npieces], piece_counts[npieces]);
+                piece_bufs[npieces++] = json_object_extarr_data(extarr_obj);
+            }
+        }
+
+        /* Union all of this rank's pieces into one selection for a single write */
+        tid = MT_StartTimer("H5Sselect_hyperslab", grp, dumpn);
+        pack_bufs[v] = select_pieces(ds_id, ndims, npieces,
+            (hsize_t const (*)[3]) piece_starts, (hsize_t const (*)[3]) piece_counts,
+            piece_bufs, H5Tget_size(dtype_id), time_series ? (hssize_t) ts_step : -1,
+            &fspace_ids[v], &mspace_ids[v]);
+        timer_dt = MT_StopTimer(tid);
+        ds_ids[v] = ds_id;
+        dtype_ids[v] = dtype_id;
+
+#if !H5_VERSION_GE(1,14,0)
+        tid = MT_StartTimer("H5Dwrite", grp, dumpn);
+        H5Dwrite(ds_ids[v], dtype_ids[v], mspace_ids[v], fspace_ids[v], dxpl_id, pack_bufs[v]);
+        timer_dt = MT_StopTimer(tid);
+#endif
+
         free(centering);
     }
 
+#if H5_VERSION_GE(1,14,0)
+    /* One (collective) write of all vars together */
+    tid = MT_StartTimer("H5Dwrite_multi", grp, dumpn);
+    H5Dwrite_multi((size_t) nvars, ds_ids, dtype_ids, mspace_ids, fspace_ids, dxpl_id,
+        (void const **) pack_bufs);
+    timer_dt = MT_StopTimer(tid);
+#endif
+
+    for (v = 0; v < nvars; v++)
+    {
+        H5Sclose(fspace_ids[v]);
+        H5Sclose(mspace_ids[v]);
+        H5Dclose(ds_ids[v]);
+        free(pack_bufs[v]);
+    }
+    free(ds_ids);
+    free(dtype_ids);
+    free(fspace_ids);
+    free(mspace_ids);
+    free(pack_bufs);
+    free(piece_starts);
+    free(piece_counts);
+    free(piece_bufs);
+
     H5Sclose(fspace_nodal_id);
     H5Sclose(fspace_zonal_id);
     H5Sclose(null_space_id);
     H5Pclose(dxpl_id);
     H5Pclose(fapl_id);
-    H5Fclose(h5file_id);
+    if (time_series && dumpn < JsonGetInt(main_obj, "clargs/num_dumps") - 1)
+    {
+        /* Keep the time-series file open for the next dump */
+#if H5_VERSION_GE(1,10,0)
+        if (use_swmr && comm_size == 1 && ts_step == 0)
+        {
+            tid = MT_StartTimer("H5Fstart_swmr_write", grp, dumpn);
+            H5Fstart_swmr_write(h5file_id);
+            timer_dt = MT_StopTimer(tid);
+        }
+#endif
+        tid = MT_StartTimer("H5Fflush", grp, dumpn);
+        H5Fflush(h5file_id, H5F_SCOPE_LOCAL);
+        timer_dt = MT_StopTimer(tid);
+        ts_file_id = h5file_id;
+        ts_step++;
+    }
+    else
+    {
+        tid = MT_StartTimer("H5Fclose", grp, dumpn);
+        H5Fclose(h5file_id);
+        timer_dt = MT_StopTimer(tid);
+        ts_file_id = -1;
+        ts_step = 0;
+    }
+
+    if (agg)
+        MACSIO_AGG_Finish(agg);
+}
+#endif
+
+/*! \brief Single shared file implementation of main dump */
+static void
+main_dump_sif(
+    json_object *main_obj, /**< main json data object to dump */
+    int dumpn, /**< dump number (like a cycle number) */
+    double dumpt /**< dump time */
+)
+{
+#ifdef HAVE_MPI
+    MACSIO_TIMING_GroupMask_t main_dump_sif_grp = MACSIO_TIMING_GroupMask("main_dump_sif");
+    int i, ndims;
+    char fileName[256];
+    hsize_t global_log_dims_nodal[3];
+    hsize_t global_log_dims_zonal[3];
+    hsize_t const zero_origin[3] = {0, 0, 0};
+
+//#warning FOR MIF, NEED A FILEROOT ARGUMENT OR CHANGE TO FILEFMT ARGUMENT
+    /* Construct name for the HDF5 file */
+    if (time_series)
+        sprintf(fileName, "%s_hdf5_ts.%s",
+            json_object_path_get_string(main_obj, "clargs/filebase"),
+            json_object_path_get_string(main_obj, "clargs/fileext"));
+    else
+        sprintf(fileName, "%s_hdf5_%03d.%s",
+            json_object_path_get_string(main_obj, "clargs/filebase"),
+            dumpn,
+            json_object_path_get_string(main_obj, "clargs/fileext"));
+
+    /* Create an HDF5 Dataspace for the global whole of mesh and var objects in the file. */
+    ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
+    json_object *global_log_dims_array =
+        json_object_path_get_array(main_obj, "problem/global/LogDims");
+    json_object *global_parts_log_dims_array =
+        json_object_path_get_array(main_obj, "problem/global/PartsLogDims");
+    /* Note that global zonal array is smaller in each dimension by one *ON*EACH*BLOCK*
+       in the associated dimension. */
+    for (i = 0; i < ndims; i++)
+    {
+        global_log_dims_nodal[ndims-1-i] = (hsize_t) JsonGetInt(global_log_dims_array, "", i);
+        global_log_dims_zonal[ndims-1-i] = global_log_dims_nodal[ndims-1-i] -
+            JsonGetInt(global_parts_log_dims_array, "", i);
+    }
 
+    write_shared_file(main_obj, MACSIO_MAIN_Comm, fileName, ndims,
+        global_log_dims_nodal, global_log_dims_zonal, zero_origin, zero_origin, 0,
+        main_dump_sif_grp, dumpn);
+#endif
+}
+
+/*!
+\brief Multiple shared file implementation of main dump
+
+Ranks are divided into \c numFiles groups with \ref MACSIO_MSF. Each group
+writes one file in the same way SIF mode does but using the group's
+communicator. The datasets in a group's file span the bounding box of the
+group's parts rather than the whole global mesh.
+
+A group's parts are consecutive in chunk order, which seldom makes a box, so the
+bounding box usually includes regions belonging to other groups. Their space is
+allocated in the group's file but never written. The datasets to create are
+taken from a task's first part, so a group with no parts at all writes a file
+with no datasets.
+*/
+static void
+main_dump_msf(
+    json_object *main_obj, /**< main json data object to dump */
+    int numFiles, /**< number of shared files (groups) */
+    int dumpn, /**< dump number (like a cycle number) */
+    double dumpt /**< dump time */
+)
+{
+#ifdef HAVE_MPI
+    MACSIO_TIMING_GroupMask_t main_dump_msf_grp = MACSIO_TIMING_GroupMask("main_dump_msf");
+    MACSIO_TIMING_TimerId_t main_dump_msf_tid;
+    double timer_dt;
+    int i, p, ndims, rank;
+    int lo[6], hi[6]; /* nodal bounds in [0..2], zonal bounds in [3..5] */
+    double zones, held_zones = 0, box_zones = 1;
+    char fileName[256];
+    hsize_t dims_nodal[3], dims_zonal[3];
+    hsize_t origin_nodal[3], origin_zonal[3];
+    MACSIO_MSF_ioFlags_t ioFlags = {MACSIO_MSF_WRITE,
+        (unsigned)JsonGetInt(main_obj, "clargs/exercise_scr")&0x1};
+
+    main_dump_msf_tid = MT_StartTimer("MACSIO_MSF_Init", main_dump_msf_grp, dumpn);
+    MACSIO_MSF_baton_t *bat = MACSIO_MSF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 4, 0);
+    timer_dt = MT_StopTimer(main_dump_msf_tid);
+
+    rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
+    ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
+
+    /* Find the bounding box of this group's parts in the global mesh */
+    for (i = 0; i < 6; i++)
+    {
+        lo[i] = INT_MAX;
+        hi[i] = INT_MIN;
+    }
+    json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
+    for (p = 0; p < json_object_array_length(part_array); p++)
+    {
+        json_object *part_obj = json_object_array_get_idx(part_array, p);
+        for (i = 0; i < ndims; i++)
+        {
+            int origin = JsonGetInt(part_obj, "GlobalLogOrigin", i);
+            int index = JsonGetInt(part_obj, "GlobalLogIndices", i);
+            int dim = JsonGetInt(part_obj, "Mesh/LogDims", i);
+            if (origin < lo[i]) lo[i] = origin;
+            if (origin + dim > hi[i]) hi[i] = origin + dim;
+            if (origin - index < lo[3+i]) lo[3+i] = origin - index;
+            if (origin - index + dim - 1 > hi[3+i]) hi[3+i] = origin - index + dim - 1;
+        }
+        for (i = 0, zones = 1; i < ndims; i++)
+            zones *= (double) (JsonGetInt(part_obj, "Mesh/LogDims", i) - 1);
+        held_zones += zones;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, lo, 6, MPI_INT, MPI_MIN, MACSIO_MSF_CommOfGroup(bat));
+    MPI_Allreduce(MPI_IN_PLACE, hi, 6, MPI_INT, MPI_MAX, MACSIO_MSF_CommOfGroup(bat));
+    MPI_Allreduce(MPI_IN_PLACE, &held_zones, 1, MPI_DOUBLE, MPI_SUM, MACSIO_MSF_CommOfGroup(bat));
+
+    /* None of the group's tasks has a part */
+    if (lo[0] > hi[0])
+    {
+        for (i = 0; i < 6; i++)
+            lo[i] = hi[i] = 0;
+    }
+
+    for (i = 0; i < ndims; i++)
+        box_zones *= (double) (hi[3+i] - lo[3+i]);
+    if (box_zones > 0)
+        MACSIO_LOG_MSG(Dbg1, ("Group's parts fill %.1f%% of its MSF datasets' extent",
+            100.0 * held_zones / box_zones));
+
+    for (i = 0; i < ndims; i++)
+    {
+        origin_nodal[ndims-1-i] = (hsize_t) lo[i];
+        dims_nodal[ndims-1-i] = (hsize_t) (hi[i] - lo[i]);
+        origin_zonal[ndims-1-i] = (hsize_t) lo[3+i];
+        dims_zonal[ndims-1-i] = (hsize_t) (hi[3+i] - lo[3+i]);
+    }
+
+    /* Construct name for the HDF5 file */
+    if (time_series)
+        sprintf(fileName, "%s_hdf5_%05d_ts.%s",
+            json_object_path_get_string(main_obj, "clargs/filebase"),
+            MACSIO_MSF_RankOfGroup(bat, rank),
+            json_object_path_get_string(main_obj, "clargs/fileext"));
+    else
+        sprintf(fileName, "%s_hdf5_%05d_%03d.%s",
+            json_object_path_get_string(main_obj, "clargs/filebase"),
+            MACSIO_MSF_RankOfGroup(bat, rank),
+            dumpn,
+            json_object_path_get_string(main_obj, "clargs/fileext"));
+
+    write_shared_file(main_obj, MACSIO_MSF_CommOfGroup(bat), fileName, ndims,
+        dims_nodal, dims_zonal, origin_nodal, origin_zonal, 1,
+        main_dump_msf_grp, dumpn);
+
+    main_dump_msf_tid = MT_StartTimer("MACSIO_MSF_Finish", main_dump_msf_grp, dumpn);
+    MACSIO_MSF_Finish(bat);
+    timer_dt = MT_StopTimer(main_dump_msf_tid);
 #endif
 }
 
 /*! \brief User data for MIF callbacks */
 typedef struct _user_data {
     hid_t groupId; /**< HDF5 hid_t of current group */
+    int dumpn; /**< dump number, for timers in the MIF callbacks */
+    char fileName[256]; /**< name of the file the task has open */
+    int lastInGroup; /**< flag indicating the task is last to write its group's file */
+    int staged; /**< flag indicating the open file is staged in memory by the core VFD */
+    char const *templateFile; /**< template to copy or reopen instead of creating the file */
 } user_data_t;
 
+/*! \brief Raw data of one dataset in a template file */
+typedef struct _template_piece_t {
+    haddr_t offset; /**< file offset of the dataset's raw data */
+    size_t nbytes; /**< size of the dataset's raw data */
+} template_piece_t;
+
+/*! \brief This task's template file and where its datasets' raw data are in it */
+static struct _template_t {
+    char fileName[256]; /**< the group's file from the dump that made the template */
+    unsigned long long nbytes; /**< size of this task's data when the template was made */
+    int nparts; /**< number of this task's parts when the template was made */
+    template_piece_t *pieces; /**< this task's datasets, in the order they are written */
+    int npieces; /**< number of pieces or -1 if offsets are not usable */
+    int maxpieces; /**< number of pieces allocated */
+} template_state;
+
+/*! \brief Record the raw data offset of a dataset just written to a new template */
+static void
+template_record(
+    hid_t ds_id, /**< the dataset */
+    size_t nbytes /**< size of its raw data */
+)
+{
+    haddr_t offset = H5Dget_offset(ds_id);
+
+    if (template_state.npieces < 0)
+        return;
+    if (offset == HADDR_UNDEF)
+    {
+        template_state.npieces = -1;
+        return;
+    }
+    if (template_state.npieces == template_state.maxpieces)
+    {
+        template_state.maxpieces = template_state.maxpieces ? 2 * template_state.maxpieces : 16;
+        template_state.pieces = (template_piece_t *) realloc(template_state.pieces,
+            template_state.maxpieces * sizeof(template_piece_t));
+    }
+    template_state.pieces[template_state.npieces].offset = offset;
+    template_state.pieces[template_state.npieces].nbytes = nbytes;
+    template_state.npieces++;
+}
+
+/*! \brief Copy file \c src to \c dst */
+static void
+copy_file(
+    char const *src, /**< name of file to copy */
+    char const *dst /**< name of the copy */
+)
+{
+    size_t const bufsize = 1<<22;
+    char *buf = (char *) malloc(bufsize);
+    int in = open(src, O_RDONLY);
+    int out = open(dst, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    ssize_t n;
+
+    if (in < 0 || out < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to copy template \"%s\" to \"%s\"", src, dst));
+    while ((n = read(in, buf, bufsize)) > 0)
+    {
+        if (write(out, buf, (size_t) n) != n)
+            MACSIO_LOG_MSG(Die, ("Unable to copy template \"%s\" to \"%s\"", src, dst));
+    }
+    close(in);
+    close(out);
+    free(buf);
+}
+
+/*! \brief Flush of a core VFD file image still in flight */
+static struct _core_flush_t {
+    struct aiocb cb; /**< the POSIX AIO control block of the write */
+    void *image; /**< the file image being written */
+    int pending; /**< flag indicating a write is in flight */
+} core_flush_pending;
+
+/*! \brief Wait for a core VFD file image write started by core_flush() */
+static void
+core_flush_wait()
+{
+    struct aiocb const *cbs[1] = {&core_flush_pending.cb};
+
+    if (!core_flush_pending.pending)
+        return;
+
+    while (aio_error(&core_flush_pending.cb) == EINPROGRESS)
+        aio_suspend(cbs, 1, 0);
+    if (aio_return(&core_flush_pending.cb) != (ssize_t) core_flush_pending.cb.aio_nbytes)
+        MACSIO_LOG_MSG(Err, ("Asynchronous write of staged file failed"));
+    close(core_flush_pending.cb.aio_fildes);
+    free(core_flush_pending.image);
+    core_flush_pending.pending = 0;
+}
+
+/*!
+\brief Write a core VFD file image to its file in one write
+
+With \c async, the write is only started and core_flush_wait() completes it.
+Otherwise, the write is done before returning. Either way, \c image is freed.
+*/
+static void
+core_flush(
+    char const *fileName, /**< name of the file to write */
+    void *image, /**< the file image (page aligned) */
+    size_t size, /**< size of the file image in bytes */
+    int async /**< flag to leave the write in flight */
+)
+{
+    int fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (fd < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\" to write staged file", fileName));
+
+    if (async)
+    {
+        core_flush_wait();
+        memset(&core_flush_pending.cb, 0, sizeof(core_flush_pending.cb));
+        core_flush_pending.cb.aio_fildes = fd;
+        core_flush_pending.cb.aio_buf = image;
+        core_flush_pending.cb.aio_nbytes = size;
+        core_flush_pending.cb.aio_offset = 0;
+        core_flush_pending.image = image;
+        if (aio_write(&core_flush_pending.cb) == 0)
+        {
+            core_flush_pending.pending = 1;
+            return;
+        }
+        /* Fall through to a synchronous write if AIO is unavailable */
+    }
+
+    {
+        char const *p = (char const *) image;
+        size_t left = size;
+        while (left > 0)
+        {
+            ssize_t n = pwrite(fd, p, left, (off_t) (p - (char const *) image));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0)
+                MACSIO_LOG_MSG(Die, ("Unable to write staged file \"%s\"", fileName));
+            p += n;
+            left -= (size_t) n;
+        }
+    }
+    close(fd);
+    free(image);
+}
+
+/*!
+\brief Use the core VFD for a MIF file if \c --core_staging asks for it
+
+Only the last task of a group stages the file. Staging loads the whole file
+into memory and writes all of it back, so if every task of a group of N did
+so, the group would write about N*N/2 parts' worth of data. Earlier tasks
+write their parts directly and the last task writes the whole file once.
+
+\return non-zero if the file is staged
+*/
+static int
+set_core_staging(
+    hid_t fapl, /**< file access property list of the MIF file */
+    user_data_t *ud /**< task specific user data */
+)
+{
+    if (!strcasecmp(core_staging_str, "none") || !ud || !ud->lastInGroup)
+        return 0;
+    H5Pset_fapl_core(fapl, (size_t) core_increment, 0);
+    return 1;
+}
+
 /*! \brief MIF create file callback for HDF5 MIF mode */
 static void *
 CreateHDF5File(
@@ -673,13 +1781,41 @@ CreateHDF5File(
 {
     hid_t *retval = 0;
     hid_t h5File;
-    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    hid_t fapl = make_fapl();
+    hid_t fcpl = make_fcpl();
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
+    user_data_t *ud = (user_data_t *) userData;
     H5Pset_fclose_degree(fapl, H5F_CLOSE_SEMI);
-    h5File = H5Fcreate(fname, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    if (ud)
+        ud->staged = set_core_staging(fapl, ud);
+    if (ud && ud->templateFile)
+    {
+        /* The file's layout already exists in the template */
+        if (strcmp(fname, ud->templateFile))
+        {
+            tid = MT_StartTimer("template_copy", MACSIO_TIMING_GroupMask("main_dump_mif"), ud->dumpn);
+            copy_file(ud->templateFile, fname);
+            timer_dt = MT_StopTimer(tid);
+        }
+        tid = MT_StartTimer("H5Fopen", MACSIO_TIMING_GroupMask("main_dump_mif"), ud->dumpn);
+        h5File = H5Fopen(fname, H5F_ACC_RDWR, fapl);
+        timer_dt = MT_StopTimer(tid);
+    }
+    else
+    {
+        tid = MT_StartTimer("H5Fcreate", MACSIO_TIMING_GroupMask("main_dump_mif"),
+            userData ? ((user_data_t *) userData)->dumpn : 0);
+        h5File = H5Fcreate(fname, H5F_ACC_TRUNC, fcpl, fapl);
+        timer_dt = MT_StopTimer(tid);
+    }
     H5Pclose(fapl);
+    H5Pclose(fcpl);
     if (h5File >= 0)
     {
 //#warning USE NEWER GROUP CREATION SETTINGS OF HDF5
+        if (userData)
+            snprintf(((user_data_t *) userData)->fileName, 256, "%s", fname);
         if (nsname && userData)
         {
             user_data_t *ud = (user_data_t *) userData;
@@ -700,14 +1836,23 @@ OpenHDF5File(
     void *userData /**< task specific user data for current task */
 ) 
 {
-    hid_t *retval;
+    hid_t *retval = 0;
     hid_t h5File;
-    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    hid_t fapl = make_fapl();
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
     H5Pset_fclose_degree(fapl, H5F_CLOSE_SEMI);
+    if (userData)
+        ((user_data_t *) userData)->staged = set_core_staging(fapl, (user_data_t *) userData);
+    tid = MT_StartTimer("H5Fopen", MACSIO_TIMING_GroupMask("main_dump_mif"),
+        userData ? ((user_data_t *) userData)->dumpn : 0);
     h5File = H5Fopen(fname, ioFlags.do_wr ? H5F_ACC_RDWR : H5F_ACC_RDONLY, fapl);
+    timer_dt = MT_StopTimer(tid);
     H5Pclose(fapl);
     if (h5File >= 0)
     {
+        if (userData)
+            snprintf(((user_data_t *) userData)->fileName, 256, "%s", fname);
         if (ioFlags.do_wr && nsname && userData)
         {
             user_data_t *ud = (user_data_t *) userData;
@@ -728,8 +1873,13 @@ CloseHDF5File(
 {
     const unsigned int obj_flags = H5F_OBJ_LOCAL | H5F_OBJ_DATASET |
         H5F_OBJ_GROUP | H5F_OBJ_DATATYPE | H5F_OBJ_ATTR;
-    int noo;
+    int noo = 0;
     herr_t close_retval;
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
+    void *image = 0;
+    ssize_t image_size = 0;
+    user_data_t *ud = (user_data_t *) userData;
 
     if (userData)
     {
@@ -742,23 +1892,385 @@ CloseHDF5File(
     if (fid == (hid_t)H5F_OBJ_ALL ||
         (H5Iis_valid(fid) > 0) && H5Iget_type(fid) == H5I_FILE)
         noo = H5Fget_obj_count(fid, obj_flags);
+
+    /* Take a copy of a staged file's image before closing it discards it */
+    if (ud && ud->staged && ud->fileName[0])
+    {
+        tid = MT_StartTimer("H5Fget_file_image", MACSIO_TIMING_GroupMask("main_dump_mif"), ud->dumpn);
+        H5Fflush(*((hid_t*) file), H5F_SCOPE_GLOBAL);
+        image_size = H5Fget_file_image(*((hid_t*) file), 0, 0);
+        if (image_size > 0 && !posix_memalign(&image, 4096, (size_t) image_size))
+            H5Fget_file_image(*((hid_t*) file), image, (size_t) image_size);
+        timer_dt = MT_StopTimer(tid);
+    }
+
+    tid = MT_StartTimer("H5Fclose", MACSIO_TIMING_GroupMask("main_dump_mif"),
+        userData ? ((user_data_t *) userData)->dumpn : 0);
     close_retval = H5Fclose(*((hid_t*) file));
+    timer_dt = MT_StopTimer(tid);
     free(file);
 
+    /* Only the group's last task stages, so no task reads the file after this write */
+    if (image)
+    {
+        tid = MT_StartTimer("core_flush", MACSIO_TIMING_GroupMask("main_dump_mif"), ud->dumpn);
+        core_flush(ud->fileName, image, (size_t) image_size,
+            !strcasecmp(core_staging_str, "async"));
+        timer_dt = MT_StopTimer(tid);
+    }
+
     if (noo > 0) return -1;
     return (int) close_retval;
 }
 
-/*! \brief Write individual mesh part in MIF mode */
+/*!
+\brief MIF create file callback for \c --template_direct
+
+The group's file is a copy of the template (or the template itself) and is
+opened for plain POSIX writes.
+*/
+static void *
+CreateTemplateFile(
+    const char *fname, /**< file name */
+    const char *nsname, /**< curent task namespace name */
+    void *userData /**< user data specific to current task */
+)
+{
+    user_data_t *ud = (user_data_t *) userData;
+    int *retval = (int *) malloc(sizeof(int));
+
+    if (strcmp(fname, ud->templateFile))
+    {
+        MACSIO_TIMING_TimerId_t tid = MT_StartTimer("template_copy",
+            MACSIO_TIMING_GroupMask("main_dump_mif"), ud->dumpn);
+        copy_file(ud->templateFile, fname);
+        MT_StopTimer(tid);
+    }
+    *retval = open(fname, O_WRONLY);
+    if (*retval < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\"", fname));
+    return (void *) retval;
+}
+
+/*! \brief MIF open file callback for \c --template_direct */
+static void *
+OpenTemplateFile(
+    const char *fname, /**< filename */
+    const char *nsname, /**< namespace name for current task */
+    MACSIO_MIF_ioFlags_t ioFlags, /* io flags */
+    void *userData /**< task specific user data for current task */
+)
+{
+    int *retval = (int *) malloc(sizeof(int));
+    *retval = open(fname, O_WRONLY);
+    if (*retval < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\"", fname));
+    return (void *) retval;
+}
+
+/*! \brief MIF close file callback for \c --template_direct */
+static int
+CloseTemplateFile(
+    void *file, /**< void* to the file descriptor to close */
+    void *userData /**< task specific user data */
+)
+{
+    int retval = close(*((int *) file));
+    free(file);
+    return retval;
+}
+
+/*! \brief One chunk of a dataset compressed by precompress_chunks() */
+typedef struct _precomp_chunk_t
+{
+    hsize_t offset[3];  /**< logical offset of the chunk in the dataset */
+    void *data;         /**< compressed bytes of the chunk */
+    size_t nbytes;      /**< number of compressed bytes */
+} precomp_chunk_t;
+
+/*! \brief Work shared by the threads compressing one dataset's chunks */
+typedef struct _precomp_job_t
+{
+    pthread_mutex_t lock;    /**< guards \c next */
+    int next;                /**< next chunk for a thread to claim */
+    int nchunks;             /**< number of chunks in the dataset */
+    precomp_chunk_t *chunks; /**< the chunks */
+    int ndims;               /**< number of dimensions of the dataset */
+    hsize_t dims[3];         /**< dimensions of the dataset */
+    hsize_t chunk_dims[3];   /**< dimensions of a chunk */
+    size_t valsize;          /**< size, in bytes, of one value */
+    void const *buf;         /**< the dataset's uncompressed data */
+    int shuffle;             /**< apply the shuffle filter */
+    int gzip_level;          /**< deflate level or -1 for no deflate */
+#ifdef HAVE_ZFP
+    int zfp;                 /**< compress with zfp */
+    uint64 zfp_mode;         /**< zfp stream mode from the dataset's H5Z-ZFP cd_values */
+    int zfp_chunk_header;    /**< H5Z-ZFP version expects the zfp header in each chunk */
+#endif
+} precomp_job_t;
+
+/*! \brief Compress one chunk as the dataset's filter pipeline would */
+static void
+precompress_chunk(
+    precomp_job_t const *job, /**< the job */
+    precomp_chunk_t *chunk /**< [in,out] the chunk to compress */
+)
+{
+    int d;
+    hsize_t j, k, nvals = 1;
+    hsize_t c[3] = {1, 1, 1}, o[3] = {0, 0, 0}, dm[3] = {1, 1, 1}, cd[3] = {1, 1, 1};
+    char *raw;
+    size_t nbytes;
+
+    /* Gather the chunk's values, zero-padding any part of it past the dataset's edge */
+    for (d = 0; d < job->ndims; d++)
+    {
+        dm[3-job->ndims+d] = job->dims[d];
+        cd[3-job->ndims+d] = job->chunk_dims[d];
+        o[3-job->ndims+d] = chunk->offset[d];
+        c[3-job->ndims+d] = job->chunk_dims[d];
+        if (chunk->offset[d] + c[3-job->ndims+d] > job->dims[d])
+            c[3-job->ndims+d] = job->dims[d] - chunk->offset[d];
+        nvals *= job->chunk_dims[d];
+    }
+    nbytes = nvals * job->valsize;
+    raw = (char *) calloc(nvals, job->valsize);
+    for (j = 0; j < c[0]; j++)
+        for (k = 0; k < c[1]; k++)
+            memcpy(raw + ((j * cd[1] + k) * cd[2]) * job->valsize,
+                   (char const *) job->buf + (((o[0] + j) * dm[1] + o[1] + k) * dm[2] + o[2]) * job->valsize,
+                   c[2] * job->valsize);
+
+#ifdef HAVE_ZFP
+    if (job->zfp)
+    {
+        zfp_type type = job->valsize == 8 ? zfp_type_double : zfp_type_float;
+        zfp_stream *zstr = zfp_stream_open(0);
+        zfp_field *zfld;
+        bitstream *bstr;
+
+        /* zfp's x is the fastest varying dimension */
+        if (job->ndims == 1)
+            zfld = zfp_field_1d(raw, type, cd[2]);
+        else if (job->ndims == 2)
+            zfld = zfp_field_2d(raw, type, cd[2], cd[1]);
+        else
+            zfld = zfp_field_3d(raw, type, cd[2], cd[1], cd[0]);
+        zfp_stream_set_mode(zstr, job->zfp_mode);
+        chunk->data = malloc(zfp_stream_maximum_size(zstr, zfld));
+        bstr = stream_open(chunk->data, zfp_stream_maximum_size(zstr, zfld));
+        zfp_stream_set_bit_stream(zstr, bstr);
+        zfp_stream_rewind(zstr);
+        if (job->zfp_chunk_header)
+            zfp_write_header(zstr, zfld, ZFP_HEADER_FULL);
+        chunk->nbytes = zfp_compress(zstr, zfld);
+        zfp_field_free(zfld);
+        zfp_stream_close(zstr);
+        stream_close(bstr);
+        free(raw);
+        return;
+    }
+#endif
+
+    if (job->shuffle && job->valsize > 1)
+    {
+        /* Same byte transposition as H5Z_FILTER_SHUFFLE */
+        char *shuf = (char *) malloc(nbytes);
+        for (j = 0; j < nvals; j++)
+            for (k = 0; k < job->valsize; k++)
+                shuf[k * nvals + j] = raw[j * job->valsize + k];
+        free(raw);
+        raw = shuf;
+    }
+
+#ifdef HAVE_ZLIB
+    if (job->gzip_level >= 0)
+    {
+        uLongf zlen = compressBound((uLong) nbytes);
+        chunk->data = malloc(zlen);
+        if (compress2((Bytef *) chunk->data, &zlen, (Bytef const *) raw, (uLong) nbytes, job->gzip_level) != Z_OK)
+            MACSIO_LOG_MSG(Die, ("zlib compress2 failed"));
+        chunk->nbytes = (size_t) zlen;
+        free(raw);
+        return;
+    }
+#endif
+
+    chunk->data = raw;
+    chunk->nbytes = nbytes;
+}
+
+/*! \brief Thread body claiming and compressing chunks until none are left */
+static void *
+precompress_thread(
+    void *arg /**< the precomp_job_t */
+)
+{
+    precomp_job_t *job = (precomp_job_t *) arg;
+    while (1)
+    {
+        int c;
+        pthread_mutex_lock(&job->lock);
+        c = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (c >= job->nchunks) break;
+        precompress_chunk(job, &job->chunks[c]);
+    }
+    return 0;
+}
+
+/*!
+\brief Compress a dataset's chunks on a pool of threads and write them directly
+
+The filters are read back from the created dataset's own creation property list
+so that the bytes written are exactly what its filter pipeline would produce.
+Only shuffle, deflate and (with the ZFP library) H5Z-ZFP are handled. H5Z-ZFP
+keeps the zfp header in the dataset's cd_values; from H5Z-ZFP 1.1.0, it also
+expects one at the start of each chunk.
+
+\return 1 if the data was written, 0 if the dataset's layout or filters are not
+handled here and the caller should use H5Dwrite instead.
+*/
+static int
+precompress_and_write(
+    hid_t ds_id, /**< dataset to write */
+    hid_t dtype_id, /**< memory and file datatype */
+    void const *buf /**< the dataset's data */
+)
+{
+#if H5_VERSION_GE(1,10,3)
+    int i, d, nfilters, ok = 1;
+    hid_t dcpl_id = H5Dget_create_plist(ds_id);
+    hid_t space_id = H5Dget_space(ds_id);
+    hsize_t n[3] = {1, 1, 1};
+    pthread_t *threads;
+    precomp_job_t job;
+
+    memset(&job, 0, sizeof(job));
+    job.gzip_level = -1;
+
+    if (H5Pget_layout(dcpl_id) != H5D_CHUNKED)
+        ok = 0;
+
+    nfilters = ok ? H5Pget_nfilters(dcpl_id) : 0;
+    for (i = 0; i < nfilters && ok; i++)
+    {
+        unsigned int flags, cd_values[32];
+        size_t cd_nelmts = 32;
+        H5Z_filter_t filter = H5Pget_filter2(dcpl_id, (unsigned) i, &flags, &cd_nelmts, cd_values, 0, 0, 0);
+
+        if (filter == H5Z_FILTER_SHUFFLE && job.gzip_level < 0)
+            job.shuffle = 1;
+#ifdef HAVE_ZLIB
+        else if (filter == H5Z_FILTER_DEFLATE && job.gzip_level < 0)
+            job.gzip_level = cd_nelmts > 0 ? (int) cd_values[0] : 6;
+#endif
+#ifdef HAVE_ZFP
+        else if (filter == 32013 && nfilters == 1 && cd_nelmts > 1)
+        {
+            bitstream *bstr = stream_open(&cd_values[1], (cd_nelmts-1) * sizeof(unsigned int));
+            zfp_stream *zstr = zfp_stream_open(bstr);
+            zfp_field *zfld = zfp_field_alloc();
+            if (zfp_read_header(zstr, zfld, ZFP_HEADER_FULL))
+            {
+                job.zfp = 1;
+                job.zfp_mode = zfp_stream_mode(zstr);
+                job.zfp_chunk_header = (cd_values[0] & 0xFFF) >= 0x110;
+            }
+            else
+                ok = 0;
+            zfp_field_free(zfld);
+            zfp_stream_close(zstr);
+            stream_close(bstr);
+        }
+#endif
+        else
+            ok = 0;
+    }
+
+    if (!ok)
+    {
+        H5Sclose(space_id);
+        H5Pclose(dcpl_id);
+        return 0;
+    }
+
+    job.ndims = H5Sget_simple_extent_ndims(space_id);
+    H5Sget_simple_extent_dims(space_id, job.dims, 0);
+    H5Pget_chunk(dcpl_id, job.ndims, job.chunk_dims);
+    job.valsize = H5Tget_size(dtype_id);
+    job.buf = buf;
+    H5Sclose(space_id);
+    H5Pclose(dcpl_id);
+
+    /* Enumerate the chunks */
+    job.nchunks = 1;
+    for (d = 0; d < job.ndims; d++)
+    {
+        n[d] = (job.dims[d] + job.chunk_dims[d] - 1) / job.chunk_dims[d];
+        job.nchunks *= (int) n[d];
+    }
+    job.chunks = (precomp_chunk_t *) calloc(job.nchunks, sizeof(precomp_chunk_t));
+    for (i = 0; i < job.nchunks; i++)
+    {
+        int r = i;
+        for (d = job.ndims-1; d >= 0; d--)
+        {
+            job.chunks[i].offset[d] = (r % n[d]) * job.chunk_dims[d];
+            r /= (int) n[d];
+        }
+    }
+
+    /* Compress on the pool, then write from this thread as HDF5 may not be thread-safe */
+    pthread_mutex_init(&job.lock, 0);
+    threads = (pthread_t *) malloc(precompress_threads * sizeof(pthread_t));
+    for (i = 0; i < precompress_threads; i++)
+        pthread_create(&threads[i], 0, precompress_thread, &job);
+    for (i = 0; i < precompress_threads; i++)
+        pthread_join(threads[i], 0);
+    free(threads);
+    pthread_mutex_destroy(&job.lock);
+
+    for (i = 0; i < job.nchunks; i++)
+    {
+        if (H5Dwrite_chunk(ds_id, H5P_DEFAULT, 0, job.chunks[i].offset,
+                job.chunks[i].nbytes, job.chunks[i].data) < 0)
+            MACSIO_LOG_MSG(Warn, ("H5Dwrite_chunk failed"));
+        free(job.chunks[i].data);
+    }
+    free(job.chunks);
+
+    return 1;
+#else
+    static int have_issued_warning = 0;
+    if (!have_issued_warning)
+        MACSIO_LOG_MSG(Warn, ("--precompress_threads needs HDF5 1.10.3 or later"));
+    have_issued_warning = 1;
+    return 0;
+#endif
+}
+
+/*!
+\brief Write individual mesh part in MIF mode
+
+With \c overwrite, the datasets already exist (from a template) and are only
+opened and written. Otherwise they are created and, if making a template, their
+raw data offsets are recorded (see template_record()).
+*/
 static void
 write_mesh_part(
     hid_t h5loc, /**< HDF5 group id into which to write */
-    json_object *part_obj /**< JSON object for the mesh part to write */
+    json_object *part_obj, /**< JSON object for the mesh part to write */
+    int overwrite, /**< flag to write existing datasets rather than create them */
+    int dumpn /**< dump number (like a cycle number) */
 )
 {
 //#warning WERE SKPPING THE MESH (COORDS) OBJECT PRESENTLY
     int i;
     json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
+    MACSIO_TIMING_GroupMask_t main_dump_mif_grp = MACSIO_TIMING_GroupMask("main_dump_mif");
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
 
     for (i = 0; i < json_object_array_length(vars_array); i++)
     {
@@ -777,11 +2289,36 @@ write_mesh_part(
             var_dims[j] = json_object_extarr_dim(data_obj, j);
 
         fspace_id = H5Screate_simple(ndims, var_dims, 0);
-        dcpl_id = make_dcpl(compression_alg_str, compression_params_str, fspace_id, dtype_id);
-        ds_id = H5Dcreate1(h5loc, varname, dtype_id, fspace_id, dcpl_id); 
-        H5Dwrite(ds_id, dtype_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf);
+        dcpl_id = H5P_DEFAULT;
+        if (overwrite)
+        {
+            tid = MT_StartTimer("H5Dopen", main_dump_mif_grp, dumpn);
+            ds_id = H5Dopen2(h5loc, varname, H5P_DEFAULT);
+            timer_dt = MT_StopTimer(tid);
+        }
+        else
+        {
+            dcpl_id = make_dcpl(compression_alg_str, compression_params_str, fspace_id, dtype_id, 0);
+            tid = MT_StartTimer("H5Dcreate", main_dump_mif_grp, dumpn);
+            ds_id = H5Dcreate1(h5loc, varname, dtype_id, fspace_id, dcpl_id); 
+            timer_dt = MT_StopTimer(tid);
+        }
+        if (precompress_threads > 0)
+        {
+            int done;
+            tid = MT_StartTimer("precompress_and_write", main_dump_mif_grp, dumpn);
+            done = precompress_and_write(ds_id, dtype_id, buf);
+            timer_dt = MT_StopTimer(tid);
+            if (!done)
+                H5Dwrite(ds_id, dtype_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf);
+        }
+        else
+            H5Dwrite(ds_id, dtype_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf);
+        if (!overwrite && strcasecmp(template_mode_str, "none"))
+            template_record(ds_id, (size_t) json_object_extarr_nvals(data_obj) * H5Tget_size(dtype_id));
         H5Dclose(ds_id);
-        H5Pclose(dcpl_id);
+        if (dcpl_id != H5P_DEFAULT)
+            H5Pclose(dcpl_id);
         H5Sclose(fspace_id);
     }
 }
@@ -806,37 +2343,118 @@ main_dump_mif(
     char fileName[256];
     int i, len;
     int *theData;
-    user_data_t userData;
+    user_data_t userData = {0, dumpn, "", 0, 0, 0};
     MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE,
         (unsigned)JsonGetInt(main_obj, "clargs/exercise_scr")&0x1};
+    json_object *parts = json_object_path_get_array(main_obj, "problem/parts");
+    unsigned long long nbytes = (unsigned long long)
+        json_object_object_nbytes(JsonGetObj(main_obj, "problem"), JSON_C_FALSE);
+    int use_template = 0, direct = 0;
+
+    if (time_series)
+    {
+        static int have_issued_warning = 0;
+        if (!have_issued_warning)
+            MACSIO_LOG_MSG(Warn, ("--time_series is supported only in SIF and MSF modes"));
+        have_issued_warning = 1;
+    }
+
+    /* Use the template if every task's data still has the layout it was made with */
+    if (strcasecmp(template_mode_str, "none"))
+    {
+        int changed = !template_state.fileName[0] || template_state.nbytes != nbytes ||
+            template_state.nparts != json_object_array_length(parts);
+        int no_offsets = template_state.npieces < 0;
+#ifdef HAVE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &changed, 1, MPI_INT, MPI_MAX, MACSIO_MAIN_Comm);
+        MPI_Allreduce(MPI_IN_PLACE, &no_offsets, 1, MPI_INT, MPI_MAX, MACSIO_MAIN_Comm);
+#endif
+        use_template = !changed;
+        direct = use_template && template_direct && !no_offsets;
+        if (use_template && template_direct && no_offsets)
+        {
+            static int have_issued_warning = 0;
+            if (!have_issued_warning)
+                MACSIO_LOG_MSG(Warn, ("--template_direct needs contiguous datasets; "
+                    "writing through HDF5 instead"));
+            have_issued_warning = 1;
+        }
+        if (use_template)
+            userData.templateFile = template_state.fileName;
+        else
+        {
+            template_state.npieces = 0;
+            template_state.nbytes = nbytes;
+            template_state.nparts = json_object_array_length(parts);
+        }
+    }
+
+    /* Finish the previous dump's staged file write, if still in flight */
+    if (core_flush_pending.pending)
+    {
+        main_dump_mif_tid = MT_StartTimer("core_flush_wait", main_dump_mif_grp, dumpn);
+        core_flush_wait();
+        timer_dt = MT_StopTimer(main_dump_mif_tid);
+    }
 
 //#warning MAKE WHOLE FILE USE HDF5 1.8 INTERFACE
-//#warning SET FILE AND DATASET PROPERTIES
 //#warning DIFFERENT MPI TAGS FOR DIFFERENT PLUGINS AND CONTEXTS
     main_dump_mif_tid = MT_StartTimer("MACSIO_MIF_INIT", main_dump_mif_grp, dumpn);
-    MACSIO_MIF_baton_t *bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 3,
-        CreateHDF5File, OpenHDF5File, CloseHDF5File, &userData);
+    MACSIO_MIF_baton_t *bat = direct ?
+        MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 3,
+            CreateTemplateFile, OpenTemplateFile, CloseTemplateFile, &userData) :
+        MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 3,
+            CreateHDF5File, OpenHDF5File, CloseHDF5File, &userData);
+    MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT, nbytes);
+    userData.lastInGroup = MACSIO_MIF_IsLastInGroup(bat);
     timer_dt = MT_StopTimer(main_dump_mif_tid);
 
     rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
     size = json_object_path_get_int(main_obj, "parallel/mpi_size");
 
     /* Construct name for the silo file */
-    sprintf(fileName, "%s_hdf5_%05d_%03d.%s",
-        json_object_path_get_string(main_obj, "clargs/filebase"),
-        MACSIO_MIF_RankOfGroup(bat, rank),
-        dumpn,
-        json_object_path_get_string(main_obj, "clargs/fileext"));
+    if (use_template && !strcasecmp(template_mode_str, "inplace"))
+        strcpy(fileName, template_state.fileName);
+    else
+        sprintf(fileName, "%s_hdf5_%05d_%03d.%s",
+            json_object_path_get_string(main_obj, "clargs/filebase"),
+            MACSIO_MIF_RankOfGroup(bat, rank),
+            dumpn,
+            json_object_path_get_string(main_obj, "clargs/fileext"));
 
     MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
     
     h5File_ptr = (hid_t *) MACSIO_MIF_WaitForBaton(bat, fileName, 0);
-    h5File = *h5File_ptr;
-    h5Group = userData.groupId;
 
-    json_object *parts = json_object_path_get_array(main_obj, "problem/parts");
+    if (direct)
+    {
+        /* Write each part's raw data straight to its place in the template */
+        int fd = *((int *) h5File_ptr), p = 0;
+        main_dump_mif_tid = MT_StartTimer("template_direct_write", main_dump_mif_grp, dumpn);
+        for (int i = 0; i < json_object_array_length(parts); i++)
+        {
+            json_object *vars_array = json_object_path_get_array(
+                json_object_array_get_idx(parts, i), "Vars");
+            for (int j = 0; j < json_object_array_length(vars_array); j++, p++)
+            {
+                json_object *data_obj = json_object_path_get_extarr(
+                    json_object_array_get_idx(vars_array, j), "data");
+                if (p >= template_state.npieces ||
+                    pwrite(fd, json_object_extarr_data(data_obj), template_state.pieces[p].nbytes,
+                        (off_t) template_state.pieces[p].offset) != (ssize_t) template_state.pieces[p].nbytes)
+                    MACSIO_LOG_MSG(Die, ("Unable to write to template copy \"%s\"", fileName));
+            }
+        }
+        timer_dt = MT_StopTimer(main_dump_mif_tid);
+        parts = 0;
+    }
+    else
+    {
+        h5File = *h5File_ptr;
+        h5Group = userData.groupId;
+    }
 
-    for (int i = 0; i < json_object_array_length(parts); i++)
+    for (int i = 0; parts && i < json_object_array_length(parts); i++)
     {
         char domain_dir[256];
         json_object *this_part = json_object_array_get_idx(parts, i);
@@ -845,10 +2463,13 @@ main_dump_mif(
         snprintf(domain_dir, sizeof(domain_dir), "domain_%07d",
             json_object_path_get_int(this_part, "Mesh/ChunkID"));
  
-        domain_group_id = H5Gcreate1(h5File, domain_dir, 0);
+        if (use_template)
+            domain_group_id = H5Gopen2(h5File, domain_dir, H5P_DEFAULT);
+        else
+            domain_group_id = H5Gcreate1(h5File, domain_dir, 0);
 
         main_dump_mif_tid = MT_StartTimer("write_mesh_part", main_dump_mif_grp, dumpn);
-        write_mesh_part(domain_group_id, this_part);
+        write_mesh_part(domain_group_id, this_part, use_template, dumpn);
         timer_dt = MT_StopTimer(main_dump_mif_tid);
 
         H5Gclose(domain_group_id);
@@ -872,12 +2493,25 @@ main_dump_mif(
     MACSIO_MIF_Finish(bat);
     timer_dt = MT_StopTimer(main_dump_mif_tid);
 
+    /* This dump's files are the templates for later ones */
+    if (strcasecmp(template_mode_str, "none") && !use_template)
+        strcpy(template_state.fileName, fileName);
+
+    /* Nothing follows the last dump to overlap a staged file write with */
+    if (core_flush_pending.pending && dumpn == JsonGetInt(main_obj, "clargs/num_dumps") - 1)
+    {
+        main_dump_mif_tid = MT_StartTimer("core_flush_wait", main_dump_mif_grp, dumpn);
+        core_flush_wait();
+        timer_dt = MT_StopTimer(main_dump_mif_tid);
+    }
+
 }
 
 /*!
 \brief Main dump callback for HDF5 plugin
 
-Selects between MIF and SSF output.
+Selects between MIF, SSF and MSF output. A file count given with SIF mode
+(e.g. \c --parallel_file_mode \c SIF \c 8) selects MSF mode.
 */
 static void
 main_dump(
@@ -904,6 +2538,7 @@ main_dump(
 
     /* process cl args */
     process_args(argi, argc, argv);
+    alignment = JsonGetInt(main_obj, "clargs/alignment");
 
     rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
     size = json_object_path_get_int(main_obj, "parallel/mpi_size");
@@ -918,9 +2553,19 @@ main_dump(
 //#warning ERRORS NEED TO GO TO LOG FILES AND ERROR BEHAVIOR NEEDS TO BE HONORED
         if (!strcmp(json_object_get_string(modestr), "SIF"))
         {
-            main_dump_tid = MT_StartTimer("main_dump_sif", main_dump_grp, dumpn);
-            main_dump_sif(main_obj, dumpn, dumpt);
-            timer_dt = MT_StopTimer(main_dump_tid);
+            numFiles = json_object_get_int(filecnt);
+            if (numFiles > 1)
+            {
+                main_dump_tid = MT_StartTimer("main_dump_msf", main_dump_grp, dumpn);
+                main_dump_msf(main_obj, numFiles, dumpn, dumpt);
+                timer_dt = MT_StopTimer(main_dump_tid);
+            }
+            else
+            {
+                main_dump_tid = MT_StartTimer("main_dump_sif", main_dump_grp, dumpn);
+                main_dump_sif(main_obj, dumpn, dumpt);
+                timer_dt = MT_StopTimer(main_dump_tid);
+            }
         }
         else
         {
@@ -963,6 +2608,270 @@ main_dump(
     }
 }
 
+/*!
+\brief Read the selected datasets of a SIF or MSF file into one part
+
+Each dataset is divided into slabs along its slowest varying dimension, one per
+task reading the file, and each task reads its slab. With parallel HDF5, the
+reads are collective unless \c --no_collective is given. The slab's place in the
+global mesh is recorded in each variable's \c GlobalLogOrigin, adding the
+dataset's own \c GlobalLogOrigin attribute in MSF files.
+*/
+static void
+read_shared_file(
+    hid_t h5file_id, /**< the open file */
+    int sub_rank, /**< rank of this task among those reading the file */
+    int sub_size, /**< number of tasks reading the file */
+    char const *read_vars, /**< value of \c --read_vars */
+    json_object *parts_out, /**< [out] array to which the part read is appended */
+    MACSIO_TIMING_GroupMask_t grp, /**< timing group to use for timers here */
+    int loadn /**< load number */
+)
+{
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
+    H5G_info_t ginfo;
+    hsize_t v;
+    hid_t dxpl_id = H5Pcreate(H5P_DATASET_XFER);
+    json_object *vars_out = json_object_new_array();
+
+#if H5_HAVE_PARALLEL
+    if (no_collective)
+        H5Pset_dxpl_mpio(dxpl_id, H5FD_MPIO_INDEPENDENT);
+    else
+        H5Pset_dxpl_mpio(dxpl_id, H5FD_MPIO_COLLECTIVE);
+#endif
+
+    /* Every task reading the file visits the same datasets in the same order */
+    H5Gget_info(h5file_id, &ginfo);
+    for (v = 0; v < ginfo.nlinks; v++)
+    {
+        char vname[256];
+        int d, ndims, dims[4];
+        hsize_t h5dims[4], starts[4] = {0, 0, 0, 0}, counts[4], origin[4] = {0, 0, 0, 0};
+        hid_t ds_id, fspace_id, mspace_id, mem_type_id;
+        json_object *var_obj, *data_obj, *origin_array;
+        enum json_extarr_type etype;
+
+        tid = MT_StartTimer("metadata", grp, loadn);
+        H5Lget_name_by_idx(h5file_id, ".", H5_INDEX_NAME, H5_ITER_INC, v, vname,
+            sizeof(vname), H5P_DEFAULT);
+        if (!MACSIO_UTILS_VarIsSelected(read_vars, vname))
+        {
+            timer_dt = MT_StopTimer(tid);
+            continue;
+        }
+        ds_id = H5Dopen2(h5file_id, vname, H5P_DEFAULT);
+        fspace_id = H5Dget_space(ds_id);
+        ndims = H5Sget_simple_extent_dims(fspace_id, h5dims, 0);
+        if (H5Aexists(ds_id, "GlobalLogOrigin") > 0)
+        {
+            /* Time-series datasets have one more dimension than their origin */
+            hid_t attr_id = H5Aopen(ds_id, "GlobalLogOrigin", H5P_DEFAULT);
+            hid_t aspace_id = H5Aget_space(attr_id);
+            int norigin = (int) H5Sget_simple_extent_npoints(aspace_id);
+            H5Aread(attr_id, H5T_NATIVE_HSIZE, origin + ndims - norigin);
+            H5Sclose(aspace_id);
+            H5Aclose(attr_id);
+        }
+        timer_dt = MT_StopTimer(tid);
+
+        /* This task's slab */
+        for (d = 0; d < ndims; d++)
+            counts[d] = h5dims[d];
+        starts[0] = h5dims[0] * sub_rank / sub_size;
+        counts[0] = h5dims[0] * (sub_rank + 1) / sub_size - starts[0];
+        for (d = 0; d < ndims; d++)
+            dims[ndims-1-d] = (int) counts[d];
+
+        MACSIO_HDF5_GetMemType(ds_id, &mem_type_id, &etype);
+        mspace_id = H5Screate_simple(ndims, counts, 0);
+        if (counts[0])
+            H5Sselect_hyperslab(fspace_id, H5S_SELECT_SET, starts, 0, counts, 0);
+        else
+        {
+            H5Sselect_none(fspace_id);
+            H5Sselect_none(mspace_id);
+        }
+        data_obj = json_object_new_extarr_alloc(etype, ndims, dims, 0);
+
+        tid = MT_StartTimer("H5Dread", grp, loadn);
+        H5Dread(ds_id, mem_type_id, mspace_id, fspace_id, dxpl_id,
+            (void *) json_object_extarr_data(data_obj));
+        timer_dt = MT_StopTimer(tid);
+
+        H5Sclose(mspace_id);
+        H5Sclose(fspace_id);
+        H5Dclose(ds_id);
+
+        if (!counts[0])
+        {
+            json_object_put(data_obj);
+            continue;
+        }
+
+        origin_array = json_object_new_array();
+        for (d = ndims-1; d >= 0; d--)
+            json_object_array_add(origin_array, json_object_new_int((int) (origin[d] + starts[d])));
+
+        var_obj = json_object_new_object();
+        json_object_object_add(var_obj, "name", json_object_new_string(vname));
+        json_object_object_add(var_obj, "GlobalLogOrigin", origin_array);
+        json_object_object_add(var_obj, "data", data_obj);
+        json_object_array_add(vars_out, var_obj);
+    }
+    H5Pclose(dxpl_id);
+
+    if (json_object_array_length(vars_out))
+    {
+        json_object *part_obj = json_object_new_object();
+        json_object_object_add(part_obj, "Vars", vars_out);
+        json_object_array_add(parts_out, part_obj);
+    }
+    else
+        json_object_put(vars_out);
+}
+
+/*!
+\brief Main load callback for HDF5 plugin
+
+\c path names a SIF file or any one file of a set of MIF or MSF files, which are
+named \c <filebase>_hdf5_<group>_<dump>.<ext> (see MACSIO_UTILS_GroupFileName()). Files are divided evenly among the tasks. When there are
+fewer files than tasks, the tasks sharing a file divide its domain groups (MIF)
+or slabs of its datasets (SIF/MSF) among themselves. Only the variables listed in
+\c --read_vars are read. Each load's data replaces that of the previous load.
+*/
+static void
+main_load(
+    int argi, /**< arg index at which to start processing \c argv */
+    int argc, /**< \c argc from main */
+    char **argv, /**< \c argv from main */
+    char const *path, /**< name of the file to read */
+    json_object *main_obj, /**< main json data object */
+    json_object **data_read_obj /**< [out] the data read, shaped like main_obj's "problem" */
+)
+{
+    static int loadn = 0;
+    static json_object *last_read_obj = 0;
+    MACSIO_TIMING_GroupMask_t main_load_grp = MACSIO_TIMING_GroupMask("main_load");
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
+    int rank, size, nfiles = 0, f, f0, f1, sub_rank = 0, sub_size = 1;
+    char const *read_vars = JsonGetStr(main_obj, "clargs/read_vars");
+    char fileName[256];
+    json_object *parts_out, *problem;
+#ifdef HAVE_MPI
+    MPI_Comm file_comm = MPI_COMM_SELF;
+#endif
+
+    process_args(argi, argc, argv);
+
+    rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
+    size = json_object_path_get_int(main_obj, "parallel/mpi_size");
+
+    if (last_read_obj)
+        json_object_put(last_read_obj);
+
+    /* Count the files in the set */
+    if (rank == 0)
+    {
+        int is_set = MACSIO_UTILS_GroupFileName(path, "_hdf5_", 0, fileName, sizeof(fileName));
+        while (!access(fileName, R_OK))
+        {
+            nfiles++;
+            if (!is_set) break;
+            MACSIO_UTILS_GroupFileName(path, "_hdf5_", nfiles, fileName, sizeof(fileName));
+        }
+        if (!nfiles)
+            MACSIO_LOG_MSG(Die, ("Unable to find HDF5 file(s) at \"%s\"", path));
+    }
+#ifdef HAVE_MPI
+    MPI_Bcast(&nfiles, 1, MPI_INT, 0, MACSIO_MAIN_Comm);
+#endif
+
+    /* This task's files and, if sharing one, its rank among the tasks reading it */
+    if (nfiles >= size)
+    {
+        f0 = (int) ((long long) nfiles * rank / size);
+        f1 = (int) ((long long) nfiles * (rank + 1) / size);
+    }
+    else
+    {
+        f0 = (int) ((long long) nfiles * rank / size);
+        f1 = f0 + 1;
+    }
+#ifdef HAVE_MPI
+    MPI_Comm_split(MACSIO_MAIN_Comm, f0, rank, &file_comm);
+    MPI_Comm_rank(file_comm, &sub_rank);
+    MPI_Comm_size(file_comm, &sub_size);
+#endif
+
+    parts_out = json_object_new_array();
+    for (f = f0; f < f1; f++)
+    {
+        hid_t h5file_id, fapl_id = make_fapl();
+        H5G_info_t ginfo;
+        hsize_t k;
+        int is_mif = 0;
+        double hit_rate = 0;
+
+        MACSIO_UTILS_GroupFileName(path, "_hdf5_", f, fileName, sizeof(fileName));
+
+#if H5_HAVE_PARALLEL
+        if (sub_size > 1 || subfiling)
+        {
+            MPI_Info mpiInfo = MACSIO_UTILS_MPIInfoFromHints(JsonGetStr(main_obj, "clargs/mpi_hints"));
+            set_parallel_driver(fapl_id, file_comm, mpiInfo);
+            if (mpiInfo != MPI_INFO_NULL)
+                MPI_Info_free(&mpiInfo);
+        }
+#endif
+        tid = MT_StartTimer("H5Fopen", main_load_grp, loadn);
+        h5file_id = H5Fopen(fileName, H5F_ACC_RDONLY, fapl_id);
+        timer_dt = MT_StopTimer(tid);
+        H5Pclose(fapl_id);
+        if (h5file_id < 0)
+            MACSIO_LOG_MSG(Die, ("Unable to open HDF5 file \"%s\"", fileName));
+
+        /* MIF files hold a group per domain. SIF and MSF files hold datasets. */
+        tid = MT_StartTimer("metadata", main_load_grp, loadn);
+        H5Gget_info(h5file_id, &ginfo);
+        for (k = 0; k < ginfo.nlinks && !is_mif; k++)
+        {
+            char lname[256];
+            H5Lget_name_by_idx(h5file_id, ".", H5_INDEX_NAME, H5_ITER_INC, k, lname,
+                sizeof(lname), H5P_DEFAULT);
+            is_mif = !strncmp(lname, "domain_", 7);
+        }
+        timer_dt = MT_StopTimer(tid);
+
+        if (is_mif)
+            MACSIO_HDF5_ReadMIFFile(h5file_id, sub_rank, sub_size, read_vars, parts_out,
+                main_load_grp, loadn);
+        else
+            read_shared_file(h5file_id, sub_rank, sub_size, read_vars, parts_out,
+                main_load_grp, loadn);
+
+        H5Fget_mdc_hit_rate(h5file_id, &hit_rate);
+        MACSIO_LOG_MSG(Dbg1, ("Metadata cache hit rate reading \"%s\" was %g", fileName, hit_rate));
+
+        tid = MT_StartTimer("H5Fclose", main_load_grp, loadn);
+        H5Fclose(h5file_id);
+        timer_dt = MT_StopTimer(tid);
+    }
+
+#ifdef HAVE_MPI
+    MPI_Comm_free(&file_comm);
+#endif
+
+    problem = json_object_new_object();
+    json_object_object_add(problem, "parts", parts_out);
+    *data_read_obj = json_object_new_object();
+    json_object_object_add(*data_read_obj, "problem", problem);
+    last_read_obj = *data_read_obj;
+    loadn++;
+}
+
 /*! \brief Function called during static initialization to register the plugin */
 static int
 register_this_interface()
@@ -978,6 +2887,7 @@ register_this_interface()
     strcpy(iface.name, iface_name);
     strcpy(iface.ext, iface_ext);
     iface.dumpFunc = main_dump;
+    iface.loadFunc = main_load;
     iface.processArgsFunc = process_args;
 
     /* Register custom compression methods with HDF5 library */
@@ -0,0 +1,153 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+Written by Mark C. Miller
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <json-cwx/json.h>
+
+#include <macsio_timing.h>
+#include <macsio_utils.h>
+
+#include <hdf5.h>
+
+#include <macsio_hdf5_load.h>
+
+void
+MACSIO_HDF5_GetMemType(
+    hid_t ds_id,
+    hid_t *mem_type_id,
+    enum json_extarr_type *etype
+)
+{
+    hid_t dtype_id = H5Dget_type(ds_id);
+
+//#warning JUST ASSUMING TWO TYPES NOW. CHANGE TO A FUNCTION
+    if (H5Tget_class(dtype_id) == H5T_FLOAT)
+    {
+        *mem_type_id = H5T_NATIVE_DOUBLE;
+        *etype = json_extarr_type_flt64;
+    }
+    else
+    {
+        *mem_type_id = H5T_NATIVE_INT;
+        *etype = json_extarr_type_int32;
+    }
+    H5Tclose(dtype_id);
+}
+
+void
+MACSIO_HDF5_ReadMIFFile(
+    hid_t h5file_id,
+    int sub_rank,
+    int sub_size,
+    char const *read_vars,
+    json_object *parts_out,
+    MACSIO_TIMING_GroupMask_t grp,
+    int loadn
+)
+{
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
+    H5G_info_t ginfo;
+    hsize_t k, ndomains = 0;
+    char **domains = 0;
+
+    /* List the domain groups in the file */
+    tid = MT_StartTimer("metadata", grp, loadn);
+    H5Gget_info(h5file_id, &ginfo);
+    domains = (char **) calloc(ginfo.nlinks, sizeof(char *));
+    for (k = 0; k < ginfo.nlinks; k++)
+    {
+        char lname[256];
+        H5Lget_name_by_idx(h5file_id, ".", H5_INDEX_NAME, H5_ITER_INC, k, lname,
+            sizeof(lname), H5P_DEFAULT);
+        if (!strncmp(lname, "domain_", 7))
+            domains[ndomains++] = strdup(lname);
+    }
+    timer_dt = MT_StopTimer(tid);
+
+    /* This task's share of the file's domains */
+    for (k = ndomains * sub_rank / sub_size; k < ndomains * (sub_rank + 1) / sub_size; k++)
+    {
+        hid_t grp_id = H5Gopen2(h5file_id, domains[k], H5P_DEFAULT);
+        json_object *part_obj = json_object_new_object();
+        json_object *mesh_obj = json_object_new_object();
+        json_object *vars_out = json_object_new_array();
+        hsize_t v;
+
+        H5Gget_info(grp_id, &ginfo);
+        for (v = 0; v < ginfo.nlinks; v++)
+        {
+            char vname[256];
+            int d, ndims, dims[4];
+            hsize_t h5dims[4];
+            hid_t ds_id, fspace_id, mem_type_id;
+            json_object *var_obj, *data_obj;
+            enum json_extarr_type etype;
+
+            H5Lget_name_by_idx(grp_id, ".", H5_INDEX_NAME, H5_ITER_INC, v, vname,
+                sizeof(vname), H5P_DEFAULT);
+            if (!MACSIO_UTILS_VarIsSelected(read_vars, vname))
+                continue;
+
+            tid = MT_StartTimer("metadata", grp, loadn);
+            ds_id = H5Dopen2(grp_id, vname, H5P_DEFAULT);
+            fspace_id = H5Dget_space(ds_id);
+            ndims = H5Sget_simple_extent_dims(fspace_id, h5dims, 0);
+            timer_dt = MT_StopTimer(tid);
+
+            for (d = 0; d < ndims; d++)
+                dims[d] = (int) h5dims[d];
+            MACSIO_HDF5_GetMemType(ds_id, &mem_type_id, &etype);
+            data_obj = json_object_new_extarr_alloc(etype, ndims, dims, 0);
+
+            tid = MT_StartTimer("H5Dread", grp, loadn);
+            H5Dread(ds_id, mem_type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                (void *) json_object_extarr_data(data_obj));
+            timer_dt = MT_StopTimer(tid);
+
+            var_obj = json_object_new_object();
+            json_object_object_add(var_obj, "name", json_object_new_string(vname));
+            json_object_object_add(var_obj, "data", data_obj);
+            json_object_array_add(vars_out, var_obj);
+
+            H5Sclose(fspace_id);
+            H5Dclose(ds_id);
+        }
+        H5Gclose(grp_id);
+
+        json_object_object_add(mesh_obj, "ChunkID",
+            json_object_new_int(atoi(domains[k] + strlen("domain_"))));
+        json_object_object_add(part_obj, "Mesh", mesh_obj);
+        json_object_object_add(part_obj, "Vars", vars_out);
+        json_object_array_add(parts_out, part_obj);
+    }
+
+    for (k = 0; k < ndomains; k++)
+        free(domains[k]);
+    free(domains);
+}
@@ -0,0 +1,82 @@
+#ifndef MACSIO_HDF5_LOAD_H
+#define MACSIO_HDF5_LOAD_H
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+Written by Mark C. Miller
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include <json-cwx/json.h>
+
+#include <macsio_timing.h>
+
+#include <hdf5.h>
+
+/*!
+\defgroup MACSIO_HDF5_LOAD MACSIO_HDF5_LOAD
+\brief Load helpers shared by the plugins that write HDF5 MIF files
+
+The HDF5 and HDF5S3 plugins write the same MIF files, one group per mesh part
+named \c domain_<ChunkID> holding a dataset per variable. Both read them back
+with these.
+
+@{
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Memory type and extarr type in which to read a dataset */
+extern void
+MACSIO_HDF5_GetMemType(
+    hid_t ds_id, /**< [in] the dataset to read */
+    hid_t *mem_type_id, /**< [out] HDF5 memory type */
+    enum json_extarr_type *etype /**< [out] corresponding extarr type */
+);
+
+/*!
+\brief Read the selected datasets of a MIF file's domain groups into parts
+
+The tasks sharing a file divide its domain groups evenly among themselves.
+Each group read is appended to \c parts_out as a part whose \c Vars hold the
+datasets named in \c read_vars.
+*/
+extern void
+MACSIO_HDF5_ReadMIFFile(
+    hid_t h5file_id, /**< [in] the open file */
+    int sub_rank, /**< [in] rank of this task among those reading the file */
+    int sub_size, /**< [in] number of tasks reading the file */
+    char const *read_vars, /**< [in] value of \c --read_vars */
+    json_object *parts_out, /**< [out] array to which the parts read are appended */
+    MACSIO_TIMING_GroupMask_t grp, /**< [in] timing group to use for timers here */
+    int loadn /**< [in] load number */
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*!@}*/
+
+#endif /* MACSIO_HDF5_LOAD_H */
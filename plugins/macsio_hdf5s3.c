@@ -27,6 +27,7 @@ Public License for more details.
 #include <json-cwx/json.h>
 
 #include <macsio_clargs.h>
+#include <macsio_hdf5_load.h>
 #include <macsio_iface.h>
 #include <macsio_log.h>
 #include <macsio_main.h>
@@ -40,6 +41,9 @@ Public License for more details.
 
 #include <H5pubconf.h>
 #include <hdf5.h>
+#if H5_VERSION_GE(1,13,0)
+#include <H5FDdevelop.h>
+#endif
 /*!
 \addtogroup plugins
 @{
@@ -81,8 +85,11 @@ static char *secret_key = NULL;
 static char *host = NULL;
 static char *auth_region = NULL;
 static char *sample_bucket = NULL;
-static int statusG = 0;
-static char errorDetailsG[4096] = { 0 };
+static int s3_part_size = 8 << 20;  /**< bytes per part of a multipart upload */
+static int s3_concurrency = 4;       /**< max. number of parts in flight per task */
+static int s3_read_concurrency = 4;  /**< max. number of ranged GETs in flight per task */
+static int selective_read = 0;       /**< fetch only the byte ranges HDF5 reads */
+static int read_page_size = 1 << 16; /**< granularity of selective reads */
 
 /*
 libs3 related functions
@@ -92,13 +99,40 @@ static void S3_init(void)
     S3Status status;
     
     if ((status = S3_initialize("s3", S3_INIT_ALL, host))
-        != S3StatusOK) {
-        fprintf(stderr, "Failed to initialize libs3: %s\n", 
-                S3_get_status_name(status));
-        exit(-1);
-    }
+        != S3StatusOK)
+        MACSIO_LOG_MSG(Die, ("Failed to initialize libs3: %s",
+            S3_get_status_name(status)));
 }
 
+/*! \brief Completion state of a single libs3 request
+
+Every structure handed to libs3 as \c callbackData starts with one of
+these so that the shared response callbacks can record the outcome of
+whichever request they are called for.
+*/
+typedef struct _s3_status
+{
+    S3Status status;           /**< libs3 status of the completed request */
+    int *nfailed;              /**< optional counter bumped when the request fails */
+    char errorDetails[1024];   /**< error details reported by the service */
+} s3_status_t;
+
+/*! \brief Callback data for one uploaded byte range (a whole object or one part) */
+typedef struct _s3_part
+{
+    s3_status_t st;            /**< request status; must be first */
+    char const *data;          /**< next byte of the file image to send */
+    size_t contentLength;      /**< number of bytes still to send */
+    char eTag[256];            /**< ETag the service returned for this part */
+} s3_part_t;
+
+/*! \brief Callback data for initiating a multipart upload */
+typedef struct _s3_initiate
+{
+    s3_status_t st;            /**< request status; must be first */
+    char uploadId[1024];       /**< upload id the service assigned */
+} s3_initiate_t;
+
 static S3Status responsePropertiesCallback(
     const S3ResponseProperties *properties,
     void *callbackData)
@@ -106,71 +140,71 @@ static S3Status responsePropertiesCallback(
     return S3StatusOK;
 }
 
+/* Upload parts need the ETag from the response headers to complete the
+   multipart upload later */
+static S3Status partPropertiesCallback(
+    const S3ResponseProperties *properties,
+    void *callbackData)
+{
+    s3_part_t *part = (s3_part_t *)callbackData;
+
+    if (properties->eTag)
+        snprintf(part->eTag, sizeof(part->eTag), "%s", properties->eTag);
+    return S3StatusOK;
+}
+
 // This callback does the same thing for every request type: saves the status
-// and error stuff in global variables
+// and error details in the request's own callback data. Failures are reported
+// by the caller once the request (or the batch it belongs to) has finished.
 static void responseCompleteCallback(
     S3Status status,
     const S3ErrorDetails *error,
     void *callbackData)
 {
-    statusG = status;
-    int flag = 0;
+    s3_status_t *st = (s3_status_t *)callbackData;
+    size_t len = 0;
+
+    if (!st)
+        return;
+
+    st->status = status;
+    st->errorDetails[0] = '\0';
 
     // Compose the error details message now, although we might not use it.
     // Can't just save a pointer to [error] since it's not guaranteed to last
     // beyond this callback
-    int len = 0;
-    if (error && error->message) {
-        len += snprintf(&(errorDetailsG[len]), sizeof(errorDetailsG) - len,
-                        "  Message: %s\n", error->message);
-        printf("%s\n", errorDetailsG);
-        flag = 1;
-    }
-    if (error && error->resource) {
-        len += snprintf(&(errorDetailsG[len]), sizeof(errorDetailsG) - len,
-                        "  Resource: %s\n", error->resource);
-        printf("%s\n", errorDetailsG);
-        flag = 1;
-    }
-    if (error && error->furtherDetails) {
-        len += snprintf(&(errorDetailsG[len]), sizeof(errorDetailsG) - len,
-                        "  Further Details: %s\n", error->furtherDetails);
-        printf("%s\n", errorDetailsG);
-        flag = 1;
-    }
-    if (error && error->extraDetailsCount) {
-        len += snprintf(&(errorDetailsG[len]), sizeof(errorDetailsG) - len,
-                        "%s", "  Extra Details:\n");
+    if (error && error->message)
+        len += snprintf(&(st->errorDetails[len]), sizeof(st->errorDetails) - len,
+                        " Message: %s;", error->message);
+    if (len < sizeof(st->errorDetails) && error && error->resource)
+        len += snprintf(&(st->errorDetails[len]), sizeof(st->errorDetails) - len,
+                        " Resource: %s;", error->resource);
+    if (len < sizeof(st->errorDetails) && error && error->furtherDetails)
+        len += snprintf(&(st->errorDetails[len]), sizeof(st->errorDetails) - len,
+                        " Further Details: %s;", error->furtherDetails);
+    if (error && error->extraDetailsCount)
+    {
         int i;
-        for (i = 0; i < error->extraDetailsCount; i++) {
-            len += snprintf(&(errorDetailsG[len]), 
-                            sizeof(errorDetailsG) - len, "    %s: %s\n", 
-                            error->extraDetails[i].name,
+        for (i = 0; i < error->extraDetailsCount && len < sizeof(st->errorDetails); i++)
+            len += snprintf(&(st->errorDetails[len]), sizeof(st->errorDetails) - len,
+                            " %s: %s;", error->extraDetails[i].name,
                             error->extraDetails[i].value);
-        }
-        printf("%s\n", errorDetailsG);
-        flag = 1;
-    }
-    if (flag || status != S3StatusOK) {
-        // fast fail
-        printf("responseCompleteCallback() got a error, exit.\n\n");
-        exit(1);
     }
+
+    if (status != S3StatusOK && st->nfailed)
+        (*st->nfailed)++;
 }
 
-static const S3ResponseHandler responseHandler = {
+static S3ResponseHandler responseHandler = {
     &responsePropertiesCallback,
     &responseCompleteCallback};
 
-typedef struct put_object_callback_data
-{
-    const void * data;
-    size_t contentLength; // Length of data (number of bytes)
-} put_object_callback_data;
-
+/* Hands libs3 the next slice of the caller's file image. The part data
+   points directly into the image so the only copy made is the one into
+   libs3's own send buffer. */
 static int putObjectDataCallback(int bufferSize, char *buffer, void *callbackData)
 { // a callback function required by responseHandler
-    put_object_callback_data *data = (put_object_callback_data *)callbackData;
+    s3_part_t *data = (s3_part_t *)callbackData;
     int ret = 0; // Number of bytes written in a single call
 
     if (data->contentLength)
@@ -188,10 +222,650 @@ static int putObjectDataCallback(int bufferSize, char *buffer, void *callbackDat
     }
     data->data = (char *) data->data + ret;
     data->contentLength -= ret;
-    // printf("contentLength: %d\n", data->contentLength);
     return ret;
 }
 
+static S3Status initiateMultipartCallback(const char *upload_id, void *callbackData)
+{
+    s3_initiate_t *init = (s3_initiate_t *)callbackData;
+
+    snprintf(init->uploadId, sizeof(init->uploadId), "%s", upload_id);
+    return S3StatusOK;
+}
+
+static S3Status commitMultipartCallback(const char *location, const char *etag, void *callbackData)
+{
+    return S3StatusOK;
+}
+
+/*! \brief Block until one of the requests in \c ctx can make progress
+
+libs3 leaves the waiting to the caller when requests are driven with
+S3_runonce_request_context. Wait on the context's sockets, bounded by
+the context's own timeout so retransmits and timeouts are honored.
+*/
+static void
+s3_wait(
+    S3RequestContext *ctx /**< request context to wait on */
+)
+{
+    fd_set rfds, wfds, efds;
+    int maxfd = -1;
+    int64_t timeout_ms;
+    struct timeval tv;
+
+    FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+    FD_ZERO(&efds);
+    S3_get_request_context_fdsets(ctx, &rfds, &wfds, &efds, &maxfd);
+    timeout_ms = S3_get_request_context_timeout(ctx);
+    if (timeout_ms < 0 || timeout_ms > 100)
+        timeout_ms = 100;
+    tv.tv_sec = 0;
+    tv.tv_usec = (long) timeout_ms * 1000;
+    select(maxfd + 1, &rfds, &wfds, &efds, &tv);
+}
+
+/*!
+\brief Run \c nreqs requests on a libs3 request context
+
+\c issue is called to add request \c i to the context. At most
+\c concurrency requests are in flight at any time and the window is
+topped up as requests complete. No new requests are issued once
+\c *nfailed is non-zero; those already in flight are run to completion.
+
+\returns 0 if all requests succeeded, -1 otherwise
+*/
+static int
+s3_run_requests(
+    int nreqs,                  /**< number of requests to run */
+    int concurrency,            /**< max. number of requests in flight */
+    void (*issue)(int i, S3RequestContext *ctx, void *data), /**< adds request \c i to \c ctx */
+    void *data,                 /**< passed through to \c issue */
+    int *nfailed                /**< [in,out] count of failed requests */
+)
+{
+    S3RequestContext *ctx = 0;
+    S3Status status;
+    int next = 0, remaining = 0;
+
+    if ((status = S3_create_request_context(&ctx)) != S3StatusOK)
+    {
+        MACSIO_LOG_MSG(Err, ("Unable to create libs3 request context: %s",
+            S3_get_status_name(status)));
+        return -1;
+    }
+
+    do
+    {
+        while (remaining < concurrency && next < nreqs && !*nfailed)
+        {
+            issue(next++, ctx, data);
+            remaining++;
+        }
+
+        if ((status = S3_runonce_request_context(ctx, &remaining)) != S3StatusOK)
+        {
+            MACSIO_LOG_MSG(Err, ("libs3 request context failed: %s", S3_get_status_name(status)));
+            (*nfailed)++;
+            break;
+        }
+
+        if (remaining)
+            s3_wait(ctx);
+    } while (remaining || (next < nreqs && !*nfailed));
+
+    S3_destroy_request_context(ctx);
+
+    return *nfailed ? -1 : 0;
+}
+
+/*! \brief State of a multipart upload shared by all its parts */
+typedef struct _s3_upload
+{
+    S3BucketContext *bctx;     /**< bucket being uploaded into */
+    char const *key;           /**< object key */
+    char const *uploadId;      /**< upload id from initiating the upload */
+    char const *image;         /**< file image being uploaded */
+    size_t image_size;         /**< size of \c image in bytes */
+    s3_part_t *parts;          /**< per part callback data */
+    int nfailed;               /**< count of failed parts */
+} s3_upload_t;
+
+static void
+s3_issue_upload_part(int i, S3RequestContext *ctx, void *data)
+{
+    S3PutObjectHandler putHandler = {
+        {&partPropertiesCallback, &responseCompleteCallback},
+        &putObjectDataCallback};
+    s3_upload_t *up = (s3_upload_t *)data;
+    s3_part_t *part = &up->parts[i];
+    size_t off = (size_t) i * s3_part_size;
+
+    part->st.status = S3StatusInternalError;
+    part->st.nfailed = &up->nfailed;
+    part->data = up->image + off;
+    part->contentLength = up->image_size - off < (size_t) s3_part_size ?
+                          up->image_size - off : (size_t) s3_part_size;
+    S3_upload_part(up->bctx, up->key, NULL, &putHandler, i+1, up->uploadId,
+        (int) part->contentLength, ctx, 0, part);
+}
+
+/*!
+\brief Upload a file image to the object store
+
+Images no larger than \c s3_part_size go out as a single PUT. Larger
+images are sent as a multipart upload whose parts are issued on a libs3
+request context with at most \c s3_concurrency of them in flight at any
+time, so a single task can keep several connections busy. A failed
+multipart upload is aborted so the service does not keep orphaned parts.
+
+\returns 0 on success, -1 on failure (already logged)
+*/
+static int
+s3_upload_image(
+    S3BucketContext *bctx, /**< bucket to upload into */
+    char const *key,       /**< object key */
+    char const *image,     /**< file image to upload */
+    size_t image_size,     /**< size of \c image in bytes */
+    int *nparts_out        /**< [out] number of parts used */
+)
+{
+    S3PutObjectHandler putHandler = {
+        {&partPropertiesCallback, &responseCompleteCallback},
+        &putObjectDataCallback};
+    S3MultipartInitialHandler initHandler = {responseHandler, &initiateMultipartCallback};
+    S3MultipartCommitHandler commitHandler = {responseHandler, &putObjectDataCallback,
+                                              &commitMultipartCallback};
+    S3AbortMultipartUploadHandler abortHandler = {{&responsePropertiesCallback, &responseCompleteCallback}};
+    s3_initiate_t init;
+    s3_upload_t up;
+    s3_part_t commit;
+    char *xml, *p;
+    size_t xml_size;
+    int nparts, i;
+
+    nparts = image_size > (size_t) s3_part_size ? (int) ((image_size + s3_part_size - 1) / s3_part_size) : 1;
+    *nparts_out = nparts;
+
+    if (nparts == 1)
+    {
+        s3_part_t part;
+        memset(&part, 0, sizeof(part));
+        part.st.status = S3StatusInternalError;
+        part.data = image;
+        part.contentLength = image_size;
+        S3_put_object(bctx, key, image_size, NULL, NULL, 0, &putHandler, &part);
+        if (part.st.status != S3StatusOK)
+        {
+            MACSIO_LOG_MSG(Err, ("PUT of \"%s\" failed: %s%s", key,
+                S3_get_status_name(part.st.status), part.st.errorDetails));
+            return -1;
+        }
+        return 0;
+    }
+
+    if (nparts > 10000)
+    {
+        MACSIO_LOG_MSG(Err, ("\"%s\" needs %d parts of %d bytes; object stores allow at most 10000",
+            key, nparts, s3_part_size));
+        return -1;
+    }
+
+    memset(&init, 0, sizeof(init));
+    init.st.status = S3StatusInternalError;
+    S3_initiate_multipart(bctx, key, NULL, &initHandler, NULL, 0, &init);
+    if (init.st.status != S3StatusOK || !init.uploadId[0])
+    {
+        MACSIO_LOG_MSG(Err, ("Initiating multipart upload of \"%s\" failed: %s%s", key,
+            S3_get_status_name(init.st.status), init.st.errorDetails));
+        return -1;
+    }
+
+    up.bctx = bctx;
+    up.key = key;
+    up.uploadId = init.uploadId;
+    up.image = image;
+    up.image_size = image_size;
+    up.parts = (s3_part_t *) calloc(nparts, sizeof(s3_part_t));
+    up.nfailed = 0;
+
+    s3_run_requests(nparts, s3_concurrency, s3_issue_upload_part, &up, &up.nfailed);
+
+    for (i = 0; i < nparts && !up.nfailed; i++)
+    {
+        if (up.parts[i].st.status != S3StatusOK || !up.parts[i].eTag[0])
+            up.nfailed++;
+    }
+
+    if (up.nfailed)
+    {
+        for (i = 0; i < nparts; i++)
+        {
+            if (up.parts[i].st.status == S3StatusOK) continue;
+            MACSIO_LOG_MSG(Err, ("Part %d of \"%s\" failed: %s%s", i+1, key,
+                S3_get_status_name(up.parts[i].st.status), up.parts[i].st.errorDetails));
+            break;
+        }
+        S3_abort_multipart_upload(bctx, key, init.uploadId, 0, &abortHandler);
+        free(up.parts);
+        return -1;
+    }
+
+    /* Complete the upload with the list of part numbers and their ETags */
+    xml_size = 64 + (size_t) nparts * (64 + sizeof(up.parts[0].eTag));
+    xml = p = (char *) malloc(xml_size);
+    p += sprintf(p, "<CompleteMultipartUpload>");
+    for (i = 0; i < nparts; i++)
+        p += sprintf(p, "<Part><PartNumber>%d</PartNumber><ETag>%s</ETag></Part>",
+                     i+1, up.parts[i].eTag);
+    p += sprintf(p, "</CompleteMultipartUpload>");
+    free(up.parts);
+
+    memset(&commit, 0, sizeof(commit));
+    commit.st.status = S3StatusInternalError;
+    commit.data = xml;
+    commit.contentLength = p - xml;
+    S3_complete_multipart_upload(bctx, key, &commitHandler, init.uploadId,
+        (int) commit.contentLength, NULL, 0, &commit);
+    free(xml);
+
+    if (commit.st.status != S3StatusOK)
+    {
+        MACSIO_LOG_MSG(Err, ("Completing multipart upload of \"%s\" failed: %s%s", key,
+            S3_get_status_name(commit.st.status), commit.st.errorDetails));
+        S3_abort_multipart_upload(bctx, key, init.uploadId, 0, &abortHandler);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*! \brief Callback data for one ranged GET */
+typedef struct _s3_get
+{
+    s3_status_t st;            /**< request status; must be first */
+    char *dst;                 /**< where the next byte received goes */
+    size_t remaining;          /**< number of bytes still expected */
+} s3_get_t;
+
+/*! \brief State of a ranged download shared by all its requests */
+typedef struct _s3_download
+{
+    S3BucketContext *bctx;     /**< bucket being read */
+    char const *key;           /**< object key */
+    char *buf;                 /**< destination of the range */
+    unsigned long long offset; /**< offset of the range in the object */
+    size_t length;             /**< length of the range */
+    s3_get_t *gets;            /**< per request callback data */
+    int nfailed;               /**< count of failed requests */
+} s3_download_t;
+
+static S3Status getObjectDataCallback(int bufferSize, const char *buffer, void *callbackData)
+{
+    s3_get_t *get = (s3_get_t *)callbackData;
+
+    if ((size_t) bufferSize > get->remaining)
+        return S3StatusAbortedByCallback;
+    memcpy(get->dst, buffer, bufferSize);
+    get->dst += bufferSize;
+    get->remaining -= bufferSize;
+    return S3StatusOK;
+}
+
+static S3Status headPropertiesCallback(
+    const S3ResponseProperties *properties,
+    void *callbackData)
+{
+    s3_part_t *head = (s3_part_t *)callbackData;
+
+    head->contentLength = (size_t) properties->contentLength;
+    return S3StatusOK;
+}
+
+static void
+s3_issue_get(int i, S3RequestContext *ctx, void *data)
+{
+    S3GetObjectHandler getHandler = {responseHandler, &getObjectDataCallback};
+    s3_download_t *dl = (s3_download_t *)data;
+    s3_get_t *get = &dl->gets[i];
+    size_t off = (size_t) i * s3_part_size;
+
+    get->st.status = S3StatusInternalError;
+    get->st.nfailed = &dl->nfailed;
+    get->dst = dl->buf + off;
+    get->remaining = dl->length - off < (size_t) s3_part_size ? dl->length - off : (size_t) s3_part_size;
+    S3_get_object(dl->bctx, dl->key, NULL, dl->offset + off, get->remaining, ctx, 0,
+        &getHandler, get);
+}
+
+/*! \brief Size of an object, or -1 if it does not exist or cannot be reached */
+static long long
+s3_object_size(
+    S3BucketContext *bctx, /**< bucket holding the object */
+    char const *key,       /**< object key */
+    int quiet              /**< don't log a failure */
+)
+{
+    S3ResponseHandler headHandler = {&headPropertiesCallback, &responseCompleteCallback};
+    s3_part_t head;
+
+    memset(&head, 0, sizeof(head));
+    head.st.status = S3StatusInternalError;
+    S3_head_object(bctx, key, NULL, 0, &headHandler, &head);
+    if (head.st.status != S3StatusOK)
+    {
+        if (!quiet)
+            MACSIO_LOG_MSG(Err, ("HEAD of \"%s\" failed: %s%s", key,
+                S3_get_status_name(head.st.status), head.st.errorDetails));
+        return -1;
+    }
+    return (long long) head.contentLength;
+}
+
+/*!
+\brief Read a byte range of an object into memory
+
+The range is split into \c s3_part_size pieces fetched with ranged GETs,
+at most \c s3_read_concurrency of them in flight at once.
+
+\returns 0 on success, -1 on failure (already logged)
+*/
+static int
+s3_fetch_range(
+    S3BucketContext *bctx,    /**< bucket holding the object */
+    char const *key,          /**< object key */
+    char *buf,                /**< [out] buffer of at least \c length bytes */
+    unsigned long long offset, /**< offset of the range in the object */
+    size_t length             /**< length of the range */
+)
+{
+    s3_download_t dl;
+    int nreqs, i;
+
+    if (!length)
+        return 0;
+
+    nreqs = (int) ((length + s3_part_size - 1) / s3_part_size);
+    dl.bctx = bctx;
+    dl.key = key;
+    dl.buf = buf;
+    dl.offset = offset;
+    dl.length = length;
+    dl.gets = (s3_get_t *) calloc(nreqs, sizeof(s3_get_t));
+    dl.nfailed = 0;
+
+    s3_run_requests(nreqs, s3_read_concurrency, s3_issue_get, &dl, &dl.nfailed);
+
+    for (i = 0; i < nreqs && !dl.nfailed; i++)
+    {
+        if (dl.gets[i].st.status != S3StatusOK || dl.gets[i].remaining)
+            dl.nfailed++;
+    }
+
+    if (dl.nfailed)
+    {
+        for (i = 0; i < nreqs; i++)
+        {
+            if (dl.gets[i].st.status == S3StatusOK && !dl.gets[i].remaining) continue;
+            MACSIO_LOG_MSG(Err, ("GET of bytes %llu-%llu of \"%s\" failed: %s%s",
+                offset + (unsigned long long) i * s3_part_size,
+                offset + (unsigned long long) i * s3_part_size + s3_part_size - 1, key,
+                S3_get_status_name(dl.gets[i].st.status), dl.gets[i].st.errorDetails));
+            break;
+        }
+        free(dl.gets);
+        return -1;
+    }
+
+    free(dl.gets);
+    return 0;
+}
+
+/*
+HDF5 file image callbacks
+
+The core VFD keeps the whole file in a single buffer. Rather than copying
+that buffer out with H5Fget_file_image, these callbacks let the plugin
+take ownership of it when the file is closed. The buffer is then uploaded
+in place and freed by the plugin.
+*/
+static void *image_malloc(size_t size, H5FD_file_image_op_t op, void *udata)
+{
+    return malloc(size);
+}
+
+static void *image_memcpy(void *dest, const void *src, size_t size, H5FD_file_image_op_t op, void *udata)
+{
+    return memcpy(dest, src, size);
+}
+
+static void *image_realloc(void *ptr, size_t size, H5FD_file_image_op_t op, void *udata)
+{
+    return realloc(ptr, size);
+}
+
+static herr_t image_free(void *ptr, H5FD_file_image_op_t op, void *udata)
+{
+    void **keep = (void **)udata;
+
+    /* Keep the core VFD's buffer when the file closes; free everything else */
+    if (op == H5FD_FILE_IMAGE_OP_FILE_CLOSE && keep)
+        *keep = ptr;
+    else
+        free(ptr);
+    return 0;
+}
+
+static void *image_udata_copy(void *udata)
+{
+    return udata;
+}
+
+static herr_t image_udata_free(void *udata)
+{
+    return 0;
+}
+
+/*! \brief A file image owned by the plugin and lent to the core VFD */
+typedef struct _borrowed_image
+{
+    void *buf;                 /**< the image */
+    size_t size;               /**< size of the image in bytes */
+} borrowed_image_t;
+
+/*
+Read-only file image callbacks that let the core VFD use an image fetched
+by the plugin in place. Every allocation HDF5 asks for is answered with the
+image itself and copies onto itself are skipped, so the image is neither
+copied into the property list nor into the open file. The plugin frees the
+image after the file is closed.
+*/
+static void *borrow_malloc(size_t size, H5FD_file_image_op_t op, void *udata)
+{
+    borrowed_image_t *img = (borrowed_image_t *)udata;
+
+    return size == img->size ? img->buf : 0;
+}
+
+static void *borrow_memcpy(void *dest, const void *src, size_t size, H5FD_file_image_op_t op, void *udata)
+{
+    if (dest != src)
+        memmove(dest, src, size);
+    return dest;
+}
+
+static void *borrow_realloc(void *ptr, size_t size, H5FD_file_image_op_t op, void *udata)
+{
+    return 0;
+}
+
+static herr_t borrow_free(void *ptr, H5FD_file_image_op_t op, void *udata)
+{
+    return 0;
+}
+
+/*
+A minimal read-only HDF5 virtual file driver over an S3 object
+
+HDF5 reads the superblock and object headers first and then only the
+raw data of the datasets actually read. This driver fetches just those
+byte ranges, rounded out to read_page_size pages, into a sparse image of
+the object and serves later reads of the same pages from memory. With
+--read_vars, the data of variables not read is never fetched.
+*/
+
+/*! \brief Bucket the selective read driver fetches from */
+static S3BucketContext *s3_read_bctx = 0;
+
+/*! \brief An object opened with the selective read driver */
+typedef struct _s3_vfd_file
+{
+    H5FD_t pub;                /**< public HDF5 part; must be first */
+    char key[1024];            /**< object key */
+    haddr_t eoa;               /**< end of allocated address space */
+    haddr_t eof;               /**< size of the object */
+    char *image;               /**< sparse image of the object */
+    unsigned char *fetched;    /**< one flag per page that has been fetched */
+    unsigned long long nfetched; /**< number of bytes fetched */
+} s3_vfd_file_t;
+
+static H5FD_t *
+s3_vfd_open(const char *name, unsigned flags, hid_t fapl_id, haddr_t maxaddr)
+{
+    s3_vfd_file_t *file;
+    long long size;
+
+    if (flags & (H5F_ACC_RDWR | H5F_ACC_CREAT | H5F_ACC_TRUNC))
+        return 0;
+    if (!s3_read_bctx || (size = s3_object_size(s3_read_bctx, name, 0)) < 0)
+        return 0;
+
+    file = (s3_vfd_file_t *) calloc(1, sizeof(s3_vfd_file_t));
+    snprintf(file->key, sizeof(file->key), "%s", name);
+    file->eof = (haddr_t) size;
+    file->image = (char *) malloc(size ? size : 1);
+    file->fetched = (unsigned char *) calloc(size / read_page_size + 1, 1);
+    return &file->pub;
+}
+
+static herr_t
+s3_vfd_close(H5FD_t *_file)
+{
+    s3_vfd_file_t *file = (s3_vfd_file_t *)_file;
+
+    MACSIO_LOG_MSG(Dbg1, ("Fetched %llu of %llu bytes of \"%s\"", file->nfetched,
+        (unsigned long long) file->eof, file->key));
+    free(file->image);
+    free(file->fetched);
+    free(file);
+    return 0;
+}
+
+static herr_t
+s3_vfd_query(const H5FD_t *_file, unsigned long *flags)
+{
+    *flags = H5FD_FEAT_ACCUMULATE_METADATA | H5FD_FEAT_DATA_SIEVE;
+    return 0;
+}
+
+static haddr_t
+s3_vfd_get_eoa(const H5FD_t *_file, H5FD_mem_t type)
+{
+    return ((s3_vfd_file_t const *)_file)->eoa;
+}
+
+static herr_t
+s3_vfd_set_eoa(H5FD_t *_file, H5FD_mem_t type, haddr_t addr)
+{
+    ((s3_vfd_file_t *)_file)->eoa = addr;
+    return 0;
+}
+
+static haddr_t
+s3_vfd_get_eof(const H5FD_t *_file, H5FD_mem_t type)
+{
+    return ((s3_vfd_file_t const *)_file)->eof;
+}
+
+static herr_t
+s3_vfd_read(H5FD_t *_file, H5FD_mem_t type, hid_t dxpl_id, haddr_t addr, size_t size, void *buf)
+{
+    s3_vfd_file_t *file = (s3_vfd_file_t *)_file;
+    size_t n = addr < file->eof ? (size < file->eof - addr ? size : (size_t) (file->eof - addr)) : 0;
+
+    if (n)
+    {
+        size_t pg = addr / read_page_size, pg1 = (addr + n - 1) / read_page_size;
+
+        /* Fetch each run of missing pages with one (possibly split) ranged read */
+        while (pg <= pg1)
+        {
+            size_t end, q = pg;
+            if (file->fetched[pg])
+            {
+                pg++;
+                continue;
+            }
+            while (q <= pg1 && !file->fetched[q])
+                q++;
+            end = (haddr_t) q * read_page_size < file->eof ? q * read_page_size : (size_t) file->eof;
+            if (s3_fetch_range(s3_read_bctx, file->key, file->image + pg * read_page_size,
+                    (unsigned long long) pg * read_page_size, end - pg * read_page_size) < 0)
+                return -1;
+            memset(file->fetched + pg, 1, q - pg);
+            file->nfetched += end - pg * read_page_size;
+            pg = q;
+        }
+        memcpy(buf, file->image + addr, n);
+    }
+
+    /* Reads past the end of the object return zeros */
+    if (n < size)
+        memset((char *) buf + n, 0, size - n);
+    return 0;
+}
+
+static herr_t
+s3_vfd_write(H5FD_t *_file, H5FD_mem_t type, hid_t dxpl_id, haddr_t addr, size_t size, const void *buf)
+{
+    return -1;
+}
+
+/*! \brief Id of the selective read driver, registering it on first use */
+static hid_t
+s3_vfd_id(void)
+{
+    static hid_t driver_id = -1;
+    static H5FD_class_t cls;
+    H5FD_mem_t fl_map[] = H5FD_FLMAP_DICHOTOMY;
+
+    if (driver_id >= 0 && H5Iis_valid(driver_id) > 0)
+        return driver_id;
+
+    /* Fields are set by name since the layout differs across HDF5 versions */
+    memset(&cls, 0, sizeof(cls));
+#if H5_VERSION_GE(1,13,2)
+    cls.version = H5FD_CLASS_VERSION;
+    cls.value = (H5FD_class_value_t) 600;
+#endif
+    cls.name = "macsio_s3";
+    cls.maxaddr = HADDR_MAX;
+    cls.fc_degree = H5F_CLOSE_WEAK;
+    cls.open = s3_vfd_open;
+    cls.close = s3_vfd_close;
+    cls.query = s3_vfd_query;
+    cls.get_eoa = s3_vfd_get_eoa;
+    cls.set_eoa = s3_vfd_set_eoa;
+    cls.get_eof = s3_vfd_get_eof;
+    cls.read = s3_vfd_read;
+    cls.write = s3_vfd_write;
+    memcpy(cls.fl_map, fl_map, sizeof(fl_map));
+
+    if ((driver_id = H5FDregister(&cls)) < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to register S3 selective read driver"));
+    return driver_id;
+}
 
 /*! \brief create HDF5 library file access property list */
 static hid_t make_fapl()
@@ -489,6 +1163,28 @@ process_args(
                                  "--log", "",
                                  "Use logging Virtual File Driver (see H5Pset_fapl_log)",
                                  &use_log,
+                                 "--s3_part_size %d", "8388608",
+                                 "Size in bytes of each part of a multipart upload and of each ranged\n"
+                                 "GET on reads. Files no larger than this go out as a single PUT.\n"
+                                 "Object stores generally require parts (except the last) of at least\n"
+                                 "5 MiB.",
+                                 &s3_part_size,
+                                 "--upload_concurrency %d", "4",
+                                 "Maximum number of parts of a multipart upload each task keeps\n"
+                                 "in flight at once.",
+                                 &s3_concurrency,
+                                 "--download_concurrency %d", "4",
+                                 "Maximum number of ranged GETs each task keeps in flight at once\n"
+                                 "on reads.",
+                                 &s3_read_concurrency,
+                                 "--selective_read", "",
+                                 "On reads, fetch only the byte ranges HDF5 reads (the superblock,\n"
+                                 "object headers and the data of the --read_vars variables) instead\n"
+                                 "of whole objects.",
+                                 &selective_read,
+                                 "--read_page_size %d", "65536",
+                                 "Granularity, in bytes, of the ranges fetched by --selective_read.",
+                                 &read_page_size,
 #ifdef HAVE_SILO
                                  "--silo_fapl %d %d", MACSIO_CLARGS_NODEFAULT,
                                  "Use Silo's block-based VFD and specify block size and block count",
@@ -496,6 +1192,18 @@ process_args(
 #endif
                                  MACSIO_CLARGS_END_OF_ARGS);
 
+    if (s3_part_size <= 0)
+        MACSIO_LOG_MSG(Die, ("--s3_part_size must be positive"));
+    if (s3_part_size < (5 << 20))
+        MACSIO_LOG_MSG(Warn, ("--s3_part_size %d is below the 5 MiB minimum most object stores "
+            "enforce for multipart uploads", s3_part_size));
+    if (s3_concurrency < 1)
+        s3_concurrency = 1;
+    if (s3_read_concurrency < 1)
+        s3_read_concurrency = 1;
+    if (read_page_size <= 0)
+        MACSIO_LOG_MSG(Die, ("--read_page_size must be positive"));
+
     if (!show_errors)
         H5Eset_auto1(0, 0);
     return 0;
@@ -505,8 +1213,34 @@ process_args(
 typedef struct _user_data
 {
     hid_t groupId; /**< HDF5 hid_t of current group */
+    void *image;   /**< core VFD file image handed over when the file closed */
 } user_data_t;
 
+/*!
+\brief Set up the core VFD on a file access property list
+
+When \c keep is non-NULL, the core VFD's buffer is handed to the caller
+through \c *keep when the file closes instead of being freed.
+*/
+static void
+set_core_vfd(
+    hid_t fapl, /**< file access property list to modify */
+    void **keep /**< [out] where to put the file image at close (may be NULL) */
+)
+{
+    if (H5Pset_fapl_core(fapl, vfd_core_increment, false) < 0) //increment=2M
+        MACSIO_LOG_MSG(Warn, ("Unable to set core VFD"));
+
+    if (keep)
+    {
+        H5FD_file_image_callbacks_t callbacks = {&image_malloc, &image_memcpy,
+            &image_realloc, &image_free, &image_udata_copy, &image_udata_free, keep};
+        *keep = 0;
+        if (H5Pset_file_image_callbacks(fapl, &callbacks) < 0)
+            MACSIO_LOG_MSG(Warn, ("Unable to set file image callbacks"));
+    }
+}
+
 /*! \brief MIF create file callback for HDF5 MIF mode */
 static void *
 CreateHDF5File(
@@ -519,13 +1253,7 @@ CreateHDF5File(
     hid_t h5File;
     hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
 
-    /* Use Virtual File Drivers Core */
-    herr_t ret_value = H5Pset_fapl_core(fapl, vfd_core_increment, false); //increment=2M
-    if (ret_value < 0)
-    {
-        printf(">>>> hdf5 plugin, set Core VFD error");
-    }
-
+    set_core_vfd(fapl, userData ? &((user_data_t *)userData)->image : 0);
     H5Pset_fclose_degree(fapl, H5F_CLOSE_SEMI);
     h5File = H5Fcreate(fname, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
     H5Pclose(fapl);
@@ -556,13 +1284,7 @@ OpenHDF5File(
     hid_t h5File;
     hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
 
-    /* Use Virtual File Drivers Core */
-    herr_t ret_value = H5Pset_fapl_core(fapl, vfd_core_increment, false); //increment=2M
-    if (ret_value < 0)
-    {
-        printf(">>>> hdf5 plugin, set Core VFD error");
-    }
-
+    set_core_vfd(fapl, userData ? &((user_data_t *)userData)->image : 0);
     H5Pset_fclose_degree(fapl, H5F_CLOSE_SEMI);
     h5File = H5Fopen(fname, ioFlags.do_wr ? H5F_ACC_RDWR : H5F_ACC_RDONLY, fapl);
     H5Pclose(fapl);
@@ -666,21 +1388,30 @@ main_dump_mif(
     char fileName[256];
     int i, len;
     int *theData;
-    user_data_t userData;
+    user_data_t userData = {-1, 0};
     MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE,
                                     (unsigned)JsonGetInt(main_obj, "clargs/exercise_scr") & 0x1};
 
+    rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
+    size = json_object_path_get_int(main_obj, "parallel/mpi_size");
+
+    /* Each task's file lives only in its own memory until it is uploaded. A task
+     * sharing a group's file could neither open what the tasks before it wrote
+     * nor upload the object without racing them for its key. */
+    if (numFiles != size)
+        MACSIO_LOG_MSG(Die, ("HDF5_S3 plugin needs one MIF file per task "
+            "(--parallel_file_mode MIF %d), not %d", size, numFiles));
+
     //#warning MAKE WHOLE FILE USE HDF5 1.8 INTERFACE
     //#warning SET FILE AND DATASET PROPERTIES
     //#warning DIFFERENT MPI TAGS FOR DIFFERENT PLUGINS AND CONTEXTS
     main_dump_mif_tid = MT_StartTimer("MACSIO_MIF_INIT", main_dump_mif_grp, dumpn);
     MACSIO_MIF_baton_t *bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 3,
                                               CreateHDF5File, OpenHDF5File, CloseHDF5File, &userData);
+    MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+        (unsigned long long) json_object_object_nbytes(JsonGetObj(main_obj, "problem"), JSON_C_FALSE));
     timer_dt = MT_StopTimer(main_dump_mif_tid);
 
-    rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
-    size = json_object_path_get_int(main_obj, "parallel/mpi_size");
-
     /* Construct name for the silo file */
     sprintf(fileName, "%s_hdf5s3_%05d_%03d.%s",
             json_object_path_get_string(main_obj, "clargs/filebase"),
@@ -714,30 +1445,27 @@ main_dump_mif(
         H5Gclose(domain_group_id);
     }
 
-    put_object_callback_data put_data;
-
+    /* The image size has to be taken while the file is still open. Closing
+     * it (in HandOffBaton below) then hands the core VFD's buffer to us
+     * through the file image callbacks, so the upload reads straight from
+     * the buffer HDF5 wrote into and the next task in the group is not held
+     * up by the upload. */
     H5Fflush(h5File, H5F_SCOPE_GLOBAL);
-    /* get the size of the file */
-    size_t image_size = H5Fget_file_image(h5File, NULL, (size_t)0);
-    put_data.contentLength = image_size;
-    /* allocate a buffer of the appropriate size */
-    void *image_ptr = malloc((size_t)image_size);
-    /* load the image of the file into the buffer */
-    size_t bytes_read = H5Fget_file_image(h5File, image_ptr, (size_t)image_size);
-    put_data.data = image_ptr;
-
-    /* Debug output */
-    // printf("image_size: %d\n", image_size);
-    // printf("bytes_read: %d\n", bytes_read);
-    // printf("%s\n", (char *)image_ptr);
+    ssize_t image_size = H5Fget_file_image(h5File, NULL, (size_t)0);
+
+    /* Hand off the baton to the next processor. This winds up closing
+     * the file so that the next processor that opens it can be assured
+     * of getting a consistent and up to date view of the file's contents. */
+    main_dump_mif_tid = MT_StartTimer("MACSIO_MIF_HandOffBaton", main_dump_mif_grp, dumpn);
+    MACSIO_MIF_HandOffBaton(bat, h5File_ptr);
+    timer_dt = MT_StopTimer(main_dump_mif_tid);
+
+    if (image_size < 0 || !userData.image)
+        MACSIO_LOG_MSG(Die, ("Unable to obtain HDF5 file image for \"%s\"", fileName));
+
     S3_init();
 
-    const S3PutObjectHandler putObjectHandler =
-    {
-        responseHandler,
-        &putObjectDataCallback};
-    
-    const S3BucketContext bucketContext = {
+    S3BucketContext bucketContext = {
         host,
         sample_bucket,
         S3ProtocolHTTP,
@@ -748,22 +1476,19 @@ main_dump_mif(
         auth_region};
 
     /* Put h5 file to object store */
-    main_dump_mif_grp = MT_StartTimer("write_s3_mif", main_dump_mif_grp, dumpn);
-    S3_put_object(&bucketContext, fileName, image_size, NULL, NULL, 0, &putObjectHandler, &put_data);
+    int nparts;
+    main_dump_mif_tid = MT_StartTimer("write_s3_mif", main_dump_mif_grp, dumpn);
+    int upload_status = s3_upload_image(&bucketContext, fileName, (char const *)userData.image,
+                                        (size_t)image_size, &nparts);
     timer_dt = MT_StopTimer(main_dump_mif_tid);
+    free(userData.image);
+    userData.image = 0;
 
-    /* For debug, write h5 file to disk */
-    // printf("S3 put object: %s\n", fileName);
-    // FILE *file = fopen(fileName, "wb");
-    // fwrite(image_ptr, image_size, 1, file);
-    // fclose(file);
-
-    /* Hand off the baton to the next processor. This winds up closing
-     * the file so that the next processor that opens it can be assured
-     * of getting a consistent and up to date view of the file's contents. */
-    main_dump_mif_tid = MT_StartTimer("MACSIO_MIF_HandOffBaton", main_dump_mif_grp, dumpn);
-    MACSIO_MIF_HandOffBaton(bat, h5File_ptr);
-    timer_dt = MT_StopTimer(main_dump_mif_tid);
+    if (upload_status < 0)
+        MACSIO_LOG_MSG(Die, ("Upload of \"%s\" (%lld bytes) to bucket \"%s\" failed",
+            fileName, (long long) image_size, sample_bucket));
+    MACSIO_LOG_MSG(Dbg1, ("Uploaded \"%s\" (%lld bytes) in %d part(s)",
+        fileName, (long long) image_size, nparts));
 
     /* We're done using MACSIO_MIF, so finish it off */
     main_dump_mif_tid = MT_StartTimer("MACSIO_MIF_Finish", main_dump_mif_grp, dumpn);
@@ -804,6 +1529,9 @@ main_dump(
     /* process cl args */
     process_args(argi, argc, argv);
 
+    if (!sample_bucket)
+        MACSIO_LOG_MSG(Die, ("S3_BUCKET must name the bucket to upload into"));
+
     rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
     size = json_object_path_get_int(main_obj, "parallel/mpi_size");
 
@@ -849,6 +1577,169 @@ main_dump(
     }
 }
 
+/*!
+\brief Main load callback for HDF5S3 plugin
+
+\c path is the key of any one object of a set written together, which are
+named \c <filebase>_hdf5s3_<group>_<dump>.<ext> (see MACSIO_UTILS_GroupFileName()). Objects are divided evenly among the tasks. When there
+are fewer objects than tasks, the tasks sharing an object divide its domain
+groups among themselves.
+
+By default, each object is fetched whole with ranged GETs issued in parallel
+and opened in place with the core VFD. With \c --selective_read, objects are
+opened with a driver that fetches only the byte ranges HDF5 reads. Only the
+variables listed in \c --read_vars are read. Each load's data replaces that
+of the previous load.
+*/
+static void
+main_load(
+    int argi,                   /**< arg index at which to start processing \c argv */
+    int argc,                   /**< \c argc from main */
+    char **argv,                /**< \c argv from main */
+    char const *path,           /**< key of the object to read */
+    json_object *main_obj,      /**< main json data object */
+    json_object **data_read_obj /**< [out] the data read, shaped like main_obj's "problem" */
+)
+{
+    static int loadn = 0;
+    static json_object *last_read_obj = 0;
+    MACSIO_TIMING_GroupMask_t main_load_grp = MACSIO_TIMING_GroupMask("main_load");
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
+    int rank, size, nfiles = 0, f, f0, f1, sub_rank = 0, sub_size = 1;
+    char const *read_vars = JsonGetStr(main_obj, "clargs/read_vars");
+    char key[256];
+    long long *sizes = 0;
+    json_object *parts_out, *problem;
+
+    process_args(argi, argc, argv);
+
+    if (!sample_bucket)
+        MACSIO_LOG_MSG(Die, ("S3_BUCKET must name the bucket to read from"));
+
+    rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
+    size = json_object_path_get_int(main_obj, "parallel/mpi_size");
+
+    if (last_read_obj)
+        json_object_put(last_read_obj);
+
+    S3_init();
+
+    S3BucketContext bucketContext = {
+        host,
+        sample_bucket,
+        S3ProtocolHTTP,
+        S3UriStylePath,
+        access_key,
+        secret_key,
+        NULL,
+        auth_region};
+
+    /* Count the objects in the set and get their sizes */
+    if (rank == 0)
+    {
+        long long nbytes;
+        int is_set = MACSIO_UTILS_GroupFileName(path, "_hdf5s3_", 0, key, sizeof(key));
+
+        tid = MT_StartTimer("s3_head", main_load_grp, loadn);
+        while ((nbytes = s3_object_size(&bucketContext, key, nfiles > 0)) >= 0)
+        {
+            sizes = (long long *) realloc(sizes, (nfiles + 1) * sizeof(long long));
+            sizes[nfiles++] = nbytes;
+            if (!is_set) break;
+            MACSIO_UTILS_GroupFileName(path, "_hdf5s3_", nfiles, key, sizeof(key));
+        }
+        timer_dt = MT_StopTimer(tid);
+
+        if (!nfiles)
+            MACSIO_LOG_MSG(Die, ("Unable to find HDF5 object(s) at \"%s\" in bucket \"%s\"",
+                path, sample_bucket));
+    }
+#ifdef HAVE_MPI
+    MPI_Bcast(&nfiles, 1, MPI_INT, 0, MACSIO_MAIN_Comm);
+    if (rank != 0)
+        sizes = (long long *) malloc(nfiles * sizeof(long long));
+    MPI_Bcast(sizes, nfiles, MPI_LONG_LONG, 0, MACSIO_MAIN_Comm);
+#endif
+
+    /* This task's objects and, if sharing one, its rank among the tasks reading it */
+    if (nfiles >= size)
+    {
+        f0 = (int) ((long long) nfiles * rank / size);
+        f1 = (int) ((long long) nfiles * (rank + 1) / size);
+    }
+    else
+    {
+        int r;
+        f0 = (int) ((long long) nfiles * rank / size);
+        f1 = f0 + 1;
+        for (sub_size = 0, r = 0; r < size; r++)
+        {
+            if ((int) ((long long) nfiles * r / size) != f0) continue;
+            if (r < rank) sub_rank++;
+            sub_size++;
+        }
+    }
+
+    parts_out = json_object_new_array();
+    for (f = f0; f < f1; f++)
+    {
+        hid_t h5file_id, fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+        borrowed_image_t img = {0, 0};
+
+        MACSIO_UTILS_GroupFileName(path, "_hdf5s3_", f, key, sizeof(key));
+
+        if (selective_read)
+        {
+            s3_read_bctx = &bucketContext;
+            H5Pset_driver(fapl_id, s3_vfd_id(), 0);
+        }
+        else
+        {
+            H5FD_file_image_callbacks_t callbacks = {&borrow_malloc, &borrow_memcpy,
+                &borrow_realloc, &borrow_free, &image_udata_copy, &image_udata_free, &img};
+
+            img.size = (size_t) sizes[f];
+            img.buf = malloc(img.size ? img.size : 1);
+
+            tid = MT_StartTimer("s3_fetch", main_load_grp, loadn);
+            if (s3_fetch_range(&bucketContext, key, (char *) img.buf, 0, img.size) < 0)
+                MACSIO_LOG_MSG(Die, ("Unable to fetch \"%s\" from bucket \"%s\"", key, sample_bucket));
+            timer_dt = MT_StopTimer(tid);
+
+            H5Pset_fapl_core(fapl_id, vfd_core_increment, false);
+            H5Pset_file_image_callbacks(fapl_id, &callbacks);
+            H5Pset_file_image(fapl_id, img.buf, img.size);
+        }
+
+        tid = MT_StartTimer("H5Fopen", main_load_grp, loadn);
+        h5file_id = H5Fopen(key, H5F_ACC_RDONLY, fapl_id);
+        timer_dt = MT_StopTimer(tid);
+        H5Pclose(fapl_id);
+        if (h5file_id < 0)
+            MACSIO_LOG_MSG(Die, ("Unable to open HDF5 object \"%s\"", key));
+
+        MACSIO_HDF5_ReadMIFFile(h5file_id, sub_rank, sub_size, read_vars, parts_out,
+            main_load_grp, loadn);
+
+        tid = MT_StartTimer("H5Fclose", main_load_grp, loadn);
+        H5Fclose(h5file_id);
+        timer_dt = MT_StopTimer(tid);
+        free(img.buf);
+    }
+
+    free(sizes);
+    s3_read_bctx = 0;
+    S3_deinitialize();
+
+    problem = json_object_new_object();
+    json_object_object_add(problem, "parts", parts_out);
+    *data_read_obj = json_object_new_object();
+    json_object_object_add(*data_read_obj, "problem", problem);
+    last_read_obj = *data_read_obj;
+    loadn++;
+}
+
 /*! \brief Function called during static initialization to register the plugin */
 static int
 register_this_interface()
@@ -864,6 +1755,7 @@ register_this_interface()
     strcpy(iface.name, iface_name);
     strcpy(iface.ext, iface_ext);
     iface.dumpFunc = main_dump;
+    iface.loadFunc = main_load;
     iface.processArgsFunc = process_args;
 
     /* Register custom compression methods with HDF5 library */
@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""
+Tiny local stand-in for an S3 object store, for testing MACSio's hdf5s3 plugin.
+
+It speaks just enough of the S3 REST protocol (path-style URIs, no signature
+checking) for libs3 to PUT, GET (with Range), HEAD and DELETE objects and to
+run multipart uploads. Objects are stored as plain files under a directory so
+they can be inspected after a run.
+
+Serve until interrupted:
+
+    macsio_hdf5s3_standin.py --port 9000 --root /tmp/s3
+
+Or start on a free port, run one or more commands against it with S3_HOST,
+S3_BUCKET, S3_ACCESS_KEY, S3_SECRET_KEY and S3_REGION set, check the objects
+they left behind and exit with the status of the first command to fail:
+
+    macsio_hdf5s3_standin.py --run --check-hdf5 -- ./macsio --interface hdf5s3 ... \
+        -- ./macsio --interface hdf5s3 --read_path macsio_hdf5s3_00000_000.h5 ...
+"""
+
+import argparse
+import hashlib
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, unquote, urlsplit
+
+HDF5_SIGNATURE = b"\x89HDF\r\n\x1a\n"
+
+
+class Store:
+    """Objects live at <root>/<bucket>/<key>; in-progress uploads under <root>/.uploads"""
+
+    def __init__(self, root, fail_every):
+        self.root = root
+        self.uploads = os.path.join(root, ".uploads")
+        os.makedirs(self.uploads, exist_ok=True)
+        self.fail_every = fail_every
+        self.part_count = 0
+        self.lock = threading.Lock()
+
+    def object_path(self, bucket, key):
+        path = os.path.normpath(os.path.join(self.root, bucket, key))
+        if not path.startswith(os.path.join(self.root, bucket) + os.sep):
+            raise ValueError(key)
+        return path
+
+    def should_fail_part(self):
+        if not self.fail_every:
+            return False
+        with self.lock:
+            self.part_count += 1
+            return self.part_count % self.fail_every == 0
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    store = None
+    quiet = True
+
+    def log_message(self, fmt, *args):
+        if not self.quiet:
+            sys.stderr.write("s3-standin: " + (fmt % args) + "\n")
+
+    def parse(self):
+        url = urlsplit(self.path)
+        parts = unquote(url.path).lstrip("/").split("/", 1)
+        bucket = parts[0]
+        key = parts[1] if len(parts) > 1 else ""
+        query = parse_qs(url.query, keep_blank_values=True)
+        return bucket, key, {k: v[0] for k, v in query.items()}
+
+    def body(self):
+        length = int(self.headers.get("Content-Length", 0))
+        return self.rfile.read(length) if length else b""
+
+    def reply(self, code, data=b"", headers=None):
+        self.send_response(code)
+        for k, v in (headers or {}).items():
+            self.send_header(k, v)
+        if self.command != "HEAD" or "Content-Length" not in (headers or {}):
+            self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        if data and self.command != "HEAD":
+            self.wfile.write(data)
+
+    def error(self, code, s3code, message):
+        xml = ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+               "<Error><Code>%s</Code><Message>%s</Message><Resource>%s</Resource></Error>"
+               % (s3code, message, self.path)).encode()
+        self.reply(code, xml, {"Content-Type": "application/xml"})
+
+    def do_PUT(self):
+        bucket, key, q = self.parse()
+        data = self.body()
+        if not key:
+            os.makedirs(os.path.join(self.store.root, bucket), exist_ok=True)
+            return self.reply(200)
+        etag = '"%s"' % hashlib.md5(data).hexdigest()
+        if "uploadId" in q:
+            updir = os.path.join(self.store.uploads, q["uploadId"])
+            if not os.path.isdir(updir):
+                return self.error(404, "NoSuchUpload", "unknown upload id")
+            if self.store.should_fail_part():
+                return self.error(500, "InternalError", "injected part failure")
+            with open(os.path.join(updir, "%05d" % int(q["partNumber"])), "wb") as f:
+                f.write(data)
+            return self.reply(200, headers={"ETag": etag})
+        path = self.store.object_path(bucket, key)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(data)
+        self.reply(200, headers={"ETag": etag})
+
+    def do_POST(self):
+        bucket, key, q = self.parse()
+        data = self.body()
+        if "uploads" in q:
+            upload_id = uuid.uuid4().hex
+            os.makedirs(os.path.join(self.store.uploads, upload_id))
+            xml = ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                   "<InitiateMultipartUploadResult><Bucket>%s</Bucket><Key>%s</Key>"
+                   "<UploadId>%s</UploadId></InitiateMultipartUploadResult>"
+                   % (bucket, key, upload_id)).encode()
+            return self.reply(200, xml, {"Content-Type": "application/xml"})
+        if "uploadId" in q:
+            updir = os.path.join(self.store.uploads, q["uploadId"])
+            if not os.path.isdir(updir):
+                return self.error(404, "NoSuchUpload", "unknown upload id")
+            numbers = [int(n) for n in re.findall(rb"<PartNumber>\s*(\d+)\s*</PartNumber>", data)]
+            if not numbers or numbers != sorted(numbers):
+                return self.error(400, "InvalidPartOrder", "parts must be listed in ascending order")
+            path = self.store.object_path(bucket, key)
+            os.makedirs(os.path.dirname(path), exist_ok=True)
+            digests = b""
+            with open(path, "wb") as out:
+                for n in numbers:
+                    part = os.path.join(updir, "%05d" % n)
+                    if not os.path.exists(part):
+                        return self.error(400, "InvalidPart", "part %d was not uploaded" % n)
+                    with open(part, "rb") as f:
+                        chunk = f.read()
+                    digests += hashlib.md5(chunk).digest()
+                    out.write(chunk)
+            shutil.rmtree(updir)
+            etag = '"%s-%d"' % (hashlib.md5(digests).hexdigest(), len(numbers))
+            xml = ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                   "<CompleteMultipartUploadResult><Location>http://%s/%s/%s</Location>"
+                   "<Bucket>%s</Bucket><Key>%s</Key><ETag>%s</ETag></CompleteMultipartUploadResult>"
+                   % (self.headers.get("Host", ""), bucket, key, bucket, key, etag)).encode()
+            return self.reply(200, xml, {"Content-Type": "application/xml"})
+        self.error(400, "InvalidRequest", "unsupported POST")
+
+    def do_GET(self):
+        bucket, key, q = self.parse()
+        try:
+            path = self.store.object_path(bucket, key)
+        except ValueError:
+            return self.error(400, "InvalidRequest", "bad key")
+        if not os.path.isfile(path):
+            return self.error(404, "NoSuchKey", "no such key")
+        size = os.path.getsize(path)
+        start, end, code = 0, size - 1, 200
+        m = re.match(r"bytes=(\d*)-(\d*)$", self.headers.get("Range", ""))
+        if m and (m.group(1) or m.group(2)):
+            if m.group(1):
+                start = int(m.group(1))
+                end = min(int(m.group(2)), size - 1) if m.group(2) else size - 1
+            else:
+                start = max(size - int(m.group(2)), 0)
+            if start >= size or start > end:
+                return self.error(416, "InvalidRange", "range not satisfiable")
+            code = 206
+        headers = {"Content-Type": "application/octet-stream"}
+        if code == 206:
+            headers["Content-Range"] = "bytes %d-%d/%d" % (start, end, size)
+        if self.command == "HEAD":
+            headers["Content-Length"] = str(size)
+            return self.reply(200, headers=headers)
+        with open(path, "rb") as f:
+            f.seek(start)
+            data = f.read(end - start + 1)
+        self.reply(code, data, headers)
+
+    do_HEAD = do_GET
+
+    def do_DELETE(self):
+        bucket, key, q = self.parse()
+        if "uploadId" in q:
+            shutil.rmtree(os.path.join(self.store.uploads, q["uploadId"]), ignore_errors=True)
+        elif key:
+            try:
+                os.remove(self.store.object_path(bucket, key))
+            except (OSError, ValueError):
+                pass
+        self.reply(204)
+
+
+def check_objects(root, bucket, check_hdf5, min_objects):
+    """Return a list of problems with the objects left in the bucket"""
+    problems = []
+    objects = []
+    bdir = os.path.join(root, bucket)
+    for dirpath, _, files in os.walk(bdir):
+        objects += [os.path.join(dirpath, f) for f in files]
+    if len(objects) < min_objects:
+        problems.append("expected at least %d object(s), found %d" % (min_objects, len(objects)))
+    for obj in objects:
+        if check_hdf5:
+            with open(obj, "rb") as f:
+                if f.read(len(HDF5_SIGNATURE)) != HDF5_SIGNATURE:
+                    problems.append("%s is not an HDF5 file" % os.path.relpath(obj, bdir))
+    leftover = os.listdir(os.path.join(root, ".uploads"))
+    if leftover:
+        problems.append("%d multipart upload(s) never completed or aborted" % len(leftover))
+    return problems
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--host", default="127.0.0.1")
+    ap.add_argument("--port", type=int, default=0, help="0 picks a free port")
+    ap.add_argument("--root", help="object storage directory (default: a temporary directory)")
+    ap.add_argument("--bucket", default="macsio", help="bucket exported as S3_BUCKET in --run mode")
+    ap.add_argument("--fail-every", type=int, default=0, metavar="N",
+                    help="answer every Nth part upload with a 500 error")
+    ap.add_argument("--verbose", action="store_true", help="log each request")
+    ap.add_argument("--run", action="store_true",
+                    help="run the command(s) after '--' against the stand-in; further '--'s separate commands")
+    ap.add_argument("--check-hdf5", action="store_true", help="in --run mode, require every object to be an HDF5 file")
+    ap.add_argument("--min-objects", type=int, default=0, help="in --run mode, require at least this many objects")
+    ap.add_argument("command", nargs=argparse.REMAINDER)
+    args = ap.parse_args()
+
+    root = args.root or tempfile.mkdtemp(prefix="macsio_s3_")
+    os.makedirs(os.path.join(root, args.bucket), exist_ok=True)
+    Handler.store = Store(root, args.fail_every)
+    Handler.quiet = not args.verbose
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.daemon_threads = True
+    address = "%s:%d" % (args.host, server.server_address[1])
+
+    if not args.run:
+        print("s3-standin: serving %s from %s" % (address, root), flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+        return 0
+
+    # Each '--' starts a new command; they run in order until one fails
+    commands = []
+    for arg in args.command:
+        if arg == "--":
+            commands.append([])
+        elif commands:
+            commands[-1].append(arg)
+        else:
+            commands.append([arg])
+    commands = [c for c in commands if c]
+    if not commands:
+        ap.error("--run needs a command after '--'")
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    env = dict(os.environ, S3_HOST=address, S3_BUCKET=args.bucket, S3_ACCESS_KEY="macsio",
+               S3_SECRET_KEY="macsio", S3_REGION="us-east-1")
+    status = 0
+    for command in commands:
+        status = subprocess.call(command, env=env)
+        if status:
+            break
+    server.shutdown()
+
+    problems = check_objects(root, args.bucket, args.check_hdf5, args.min_objects) if status == 0 else []
+    for p in problems:
+        sys.stderr.write("s3-standin: %s\n" % p)
+    if not args.root:
+        shutil.rmtree(root, ignore_errors=True)
+    return status if status else (1 if problems else 0)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
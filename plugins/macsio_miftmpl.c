@@ -35,7 +35,13 @@ end-of-copyright-header */
 #include <macsio_utils.h>
 #include <macsio_timing.h>
 
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef HAVE_MPI
 #include <mpi.h>
@@ -55,6 +61,8 @@ end-of-copyright-header */
 static char const *iface_name = "miftmpl"; /**< Name of the interface this plugin uses */
 static char const *iface_ext = "json";     /**< Default file extension for files generated by this plugin */
 static int json_as_html = 0;               /**< Use HTML output instead of raw ascii */
+static int binary_mode = 0;                /**< Write raw variable bytes instead of ascii JSON */
+static int binary_align = 64;              /**< Alignment, in bytes, of each variable in binary mode */
 static int my_opt_one;                     /**< Example of a static scope, plugin-specific variable to be set in
                                                 process_args to control plugin behavior */
 static int my_opt_two;                     /**< Another example variable to control plugin behavior */
@@ -86,6 +94,14 @@ static int process_args(
         "--json_as_html", "",
             "Write files as HTML instead of raw ascii [false]",
             &json_as_html,
+        "--binary", "",
+            "Write each part as a small JSON header followed by the raw bytes of each\n"
+            "variable at aligned offsets. The root file then records the file, offset and\n"
+            "length of every variable. Only files written this way can be read back.",
+            &binary_mode,
+        "--binary_align %d", "64",
+            "Alignment, in bytes, of each variable's raw bytes in binary mode.",
+            &binary_align,
         "--my_opt_one", "",
             "Help message for my_opt_one which has no arguments. If present, local\n"
             "var my_opt_one will be assigned a value of 1 and a value of zero otherwise.",
@@ -174,12 +190,18 @@ static json_object *write_mesh_part(
     MACSIO_TIMING_TimerId_t main_dump_mif_tid;
     double timer_dt;
 
-//#warning SOMEHOW SHOULD INCLUDE OFFSETS TO EACH VARIABLE
+    off_t offset, length;
+
+    /* Files are opened for append, so the read position may not be at the end yet */
+    fseeko(myFile, 0, SEEK_END);
+    offset = ftello(myFile);
+
     /* Write the json mesh part object as an ascii string */
     main_dump_mif_tid = MT_StartTimer("write_json_to_file", main_dump_mif_grp, dumpn);
     fprintf(myFile, "%s\n", json_object_to_json_string_ext(part_obj, JSON_C_TO_STRING_PLAIN));
     timer_dt = MT_StopTimer(main_dump_mif_tid);
     json_object_free_printbuf(part_obj);
+    length = ftello(myFile) - offset;
 
     /* Form the return 'value' holding the information on where to find this part */
     json_object_object_add(part_info, "partid",
@@ -188,22 +210,211 @@ static json_object *write_mesh_part(
     json_object_object_add(part_info, "file",
         json_object_new_string(fileName));
     json_object_object_add(part_info, "offset",
-        json_object_new_double((double) ftello(myFile)));
+        json_object_new_double((double) offset));
+    json_object_object_add(part_info, "length",
+        json_object_new_double((double) length));
+
+    return part_info;
+}
+
+/*!
+\brief Write a single mesh part to a MIF file in binary form
+
+The part is written as a small, ascii JSON header holding only the part's mesh
+followed by the raw bytes of each of its variables. Each variable starts at an
+offset that is a multiple of \c binary_align so that a reader can use the bytes
+in place from a memory map of the file.
+
+\return A JSON object like write_mesh_part() returns but with an additional
+\c vars array giving the exact offset and length of each variable in the file.
+*/
+static json_object *write_mesh_part_binary(
+    FILE *myFile,          /**< [in] The file handle being used in a MIF dump */
+    char const *fileName,  /**< [in] Name of the MIF file */
+    json_object *part_obj, /**< [in] The json object representing this mesh part */
+    int dumpn              /**< [in] The number/index of this dump */
+)
+{
+    int i, j;
+    json_object *part_info = json_object_new_object();
+    json_object *header = json_object_new_object();
+    json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
+    json_object *var_infos = json_object_new_array();
+    MACSIO_TIMING_GroupMask_t main_dump_mif_grp = MACSIO_TIMING_GroupMask("main_dump_mif");
+    MACSIO_TIMING_TimerId_t main_dump_mif_tid;
+    double timer_dt;
+    off_t offset, length;
+    static char const zeros[4096] = {0};
+
+    fseeko(myFile, 0, SEEK_END);
+    offset = ftello(myFile);
+
+    /* The header holds just the mesh. The variables are described in the root file */
+    json_object_object_add(header, "Mesh", json_object_get(json_object_path_get_object(part_obj, "Mesh")));
+    main_dump_mif_tid = MT_StartTimer("write_json_to_file", main_dump_mif_grp, dumpn);
+    fprintf(myFile, "%s\n", json_object_to_json_string_ext(header, JSON_C_TO_STRING_PLAIN));
+    timer_dt = MT_StopTimer(main_dump_mif_tid);
+    json_object_put(header);
+    length = ftello(myFile) - offset;
+
+    main_dump_mif_tid = MT_StartTimer("write_raw_to_file", main_dump_mif_grp, dumpn);
+    for (i = 0; i < json_object_array_length(vars_array); i++)
+    {
+        json_object *var_obj = json_object_array_get_idx(vars_array, i);
+        json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
+        json_object *var_info = json_object_new_object();
+        json_object *dims_array = json_object_new_array();
+        enum json_extarr_type type = json_object_extarr_type(extarr_obj);
+        size_t nbytes = json_object_extarr_nvals(extarr_obj) * MACSIO_UTILS_ExtarrValSize(type);
+        off_t pos = ftello(myFile);
+        off_t pad = binary_align > 1 ? (binary_align - pos % binary_align) % binary_align : 0;
+
+        while (pad > 0)
+        {
+            size_t n = pad < (off_t) sizeof(zeros) ? (size_t) pad : sizeof(zeros);
+            fwrite(zeros, 1, n, myFile);
+            pad -= n;
+        }
+        pos = ftello(myFile);
+        if (fwrite(json_object_extarr_data(extarr_obj), 1, nbytes, myFile) != nbytes)
+            MACSIO_LOG_MSG(Die, ("Short write of \"%s\" to \"%s\"",
+                json_object_path_get_string(var_obj, "name"), fileName));
+
+        for (j = 0; j < json_object_extarr_ndims(extarr_obj); j++)
+            json_object_array_add(dims_array, json_object_new_int(json_object_extarr_dim(extarr_obj, j)));
+        json_object_object_add(var_info, "name",
+            json_object_new_string(json_object_path_get_string(var_obj, "name")));
+        json_object_object_add(var_info, "centering",
+            json_object_new_string(json_object_path_get_string(var_obj, "centering")));
+        json_object_object_add(var_info, "type", json_object_new_int((int) type));
+        json_object_object_add(var_info, "dims", dims_array);
+        json_object_object_add(var_info, "offset", json_object_new_double((double) pos));
+        json_object_object_add(var_info, "length", json_object_new_double((double) nbytes));
+        json_object_array_add(var_infos, var_info);
+    }
+    timer_dt = MT_StopTimer(main_dump_mif_tid);
+
+    json_object_object_add(part_info, "partid",
+        json_object_new_int(json_object_path_get_int(part_obj, "Mesh/ChunkID")));
+    json_object_object_add(part_info, "file",
+        json_object_new_string(fileName));
+    json_object_object_add(part_info, "offset",
+        json_object_new_double((double) offset));
+    json_object_object_add(part_info, "length",
+        json_object_new_double((double) length));
+    json_object_object_add(part_info, "vars", var_infos);
 
     return part_info;
 }
 
+/*!
+\brief Write the root (or master) file
+
+The root file is a single JSON array of every task's \c part_infos. Each task
+serializes its own entries to a string, an \c MPI_Exscan of the string lengths gives
+each task its offset in the file and all tasks then write their strings with one
+collective MPI-IO call. No task ever holds more than its own entries and the cost no
+longer grows linearly with the task count as it would passing a baton through
+every task.
+*/
+static void write_root_file(
+    char const *fileName,    /**< [in] Name of the root file */
+    json_object *part_infos, /**< [in] This task's part_info objects */
+    char const *mpi_hints,   /**< [in] MACSio's --mpi_hints for the MPI-IO open */
+    int dumpn                /**< [in] The number/index of this dump */
+)
+{
+    MACSIO_TIMING_GroupMask_t main_dump_mif_grp = MACSIO_TIMING_GroupMask("main_dump_mif");
+    MACSIO_TIMING_TimerId_t main_dump_mif_tid;
+    double timer_dt;
+    int i, n = json_object_array_length(part_infos);
+    char const *head = "[\n", *tail = "\n]\n";
+    char *body;
+    size_t body_len = 0;
+    long long len_and_count[2], offset_and_count[2] = {0, 0};
+
+    main_dump_mif_tid = MT_StartTimer("write_root_file", main_dump_mif_grp, dumpn);
+
+    /* Serialize this task's entries, comma-separated, into one buffer */
+    for (i = 0; i < n; i++)
+        body_len += strlen(json_object_to_json_string_ext(
+            json_object_array_get_idx(part_infos, i), JSON_C_TO_STRING_PRETTY)) + 2;
+    body = (char *) malloc(body_len + 3);
+    body[0] = '\0';
+    body_len = 0;
+    for (i = 0; i < n; i++)
+    {
+        char const *str = json_object_to_json_string_ext(
+            json_object_array_get_idx(part_infos, i), JSON_C_TO_STRING_PRETTY);
+        if (i) body_len += sprintf(body + body_len, ",\n");
+        body_len += sprintf(body + body_len, "%s", str);
+    }
+
+#ifdef HAVE_MPI
+    {
+        int rank, size;
+        char *buf = body;
+        MPI_File fh;
+        MPI_Status status;
+        MPI_Info mpiInfo = MACSIO_UTILS_MPIInfoFromHints(mpi_hints);
+
+        MPI_Comm_rank(MACSIO_MAIN_Comm, &rank);
+        MPI_Comm_size(MACSIO_MAIN_Comm, &size);
+
+        /* Tasks after the first with any entries need a leading separator */
+        len_and_count[0] = (long long) body_len;
+        len_and_count[1] = n ? 1 : 0;
+        MPI_Exscan(len_and_count, offset_and_count, 2, MPI_LONG_LONG, MPI_SUM, MACSIO_MAIN_Comm);
+        if (rank == 0) offset_and_count[0] = offset_and_count[1] = 0;
+        if (n && offset_and_count[1])
+        {
+            buf = (char *) malloc(body_len + 3);
+            sprintf(buf, ",\n%s", body);
+            body_len += 2;
+        }
+        len_and_count[0] = (long long) body_len;
+        MPI_Exscan(len_and_count, offset_and_count, 1, MPI_LONG_LONG, MPI_SUM, MACSIO_MAIN_Comm);
+        if (rank == 0) offset_and_count[0] = 0;
+
+        mpi_errno = MPI_File_open(MACSIO_MAIN_Comm, (char *) fileName,
+            MPI_MODE_CREATE | MPI_MODE_WRONLY, mpiInfo, &fh);
+        if (mpi_errno != MPI_SUCCESS)
+            MACSIO_LOG_MSG(Die, ("Unable to open root file \"%s\"", fileName));
+        MPI_File_set_size(fh, 0);
+        if (rank == 0)
+            MPI_File_write_at(fh, 0, (void *) head, (int) strlen(head), MPI_CHAR, &status);
+        MPI_File_write_at_all(fh, (MPI_Offset) (strlen(head) + offset_and_count[0]),
+            buf, (int) body_len, MPI_CHAR, &status);
+        if (rank == size - 1)
+            MPI_File_write_at(fh, (MPI_Offset) (strlen(head) + offset_and_count[0] + body_len),
+                (void *) tail, (int) strlen(tail), MPI_CHAR, &status);
+        MPI_File_close(&fh);
+        if (mpiInfo != MPI_INFO_NULL)
+            MPI_Info_free(&mpiInfo);
+
+        if (buf != body) free(buf);
+    }
+#else
+    {
+        FILE *rootFile = fopen(fileName, "w");
+        if (!rootFile)
+            MACSIO_LOG_MSG(Die, ("Unable to open root file \"%s\"", fileName));
+        fprintf(rootFile, "%s%s%s", head, body, tail);
+        fclose(rootFile);
+    }
+#endif
+
+    free(body);
+    timer_dt = MT_StopTimer(main_dump_mif_tid);
+}
+
 /*!
 \brief Main MIF dump implementation for this plugin
 
 This is the function MACSio main calls to do the actual dump of data with this plugin.
 
-It uses \ref MACSIO_MIF twice; once for the main dump and a second time to create the
-root (or master) file. However, in the second use, the file count is set to 1. That
-means that the root file is effectively written using serial (e.g. non-parallel) I/O.
-
-It is a useful exercise to ask how we might improve the implementation here to avoid
-writing the root file using serial I/O.
+It uses \ref MACSIO_MIF for the main dump. The root (or master) file is then
+written by all tasks together with write_root_file().
 */
 static void main_dump(
     int argi,               /**< [in] Command-line argument index at which first plugin-specific arg appears */
@@ -260,6 +471,9 @@ static void main_dump(
     bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 3,
         CreateMyFile, OpenMyFile, CloseMyFile, 0);
 
+    MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+        (unsigned long long) json_object_object_nbytes(JsonGetObj(main_obj, "problem"), JSON_C_FALSE));
+
     rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
 
     /* Construct name for the silo file */
@@ -277,7 +491,14 @@ static void main_dump(
     for (i = 0; i < json_object_array_length(parts); i++)
     {
         json_object *this_part = json_object_array_get_idx(parts, i);
-        json_object_array_add(part_infos, write_mesh_part(myFile, fileName, this_part, dumpn));
+        json_object *part_info = binary_mode ?
+            write_mesh_part_binary(myFile, fileName, this_part, dumpn) :
+            write_mesh_part(myFile, fileName, this_part, dumpn);
+
+        /* Record where in the group's baton chain this part was written */
+        json_object_object_add(part_info, "order",
+            json_object_new_int(MACSIO_MIF_PositionInChain(bat)));
+        json_object_array_add(part_infos, part_info);
     }
 
     /* Hand off the baton to the next processor. This winds up closing
@@ -288,14 +509,7 @@ static void main_dump(
     /* We're done using MACSIO_MIF for these files, so finish it off */
     MACSIO_MIF_Finish(bat);
 
-    /* Use MACSIO_MIF a second time to manage writing of the master/root
-       file contents. This winds up being serial I/O but also means we
-       never collect all info on all parts to any single processor. */
-//#warning THERE IS A BETTER WAY TO DO USING LOOP OF NON-BLOCKING RECIEVES
-    bat = MACSIO_MIF_Init(1, ioFlags, MACSIO_MAIN_Comm, 5,
-        CreateMyFile, OpenMyFile, CloseMyFile, 0);
-
-    /* Construct name for the silo file */
+    /* Construct name for the root file */
     sprintf(fileName, "%s_json_root_%03d.%s",
         json_object_path_get_string(main_obj, "clargs/filebase"),
         dumpn,
@@ -303,20 +517,195 @@ static void main_dump(
 
     MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
 
+    /* All tasks write their part_infos to the root file together */
+    write_root_file(fileName, part_infos, JsonGetStr(main_obj, "clargs/mpi_hints"), dumpn);
 
-    /* Wait for MACSIO_MIF to give this processor exclusive access */
-    myFile = (FILE *) MACSIO_MIF_WaitForBaton(bat, fileName, 0);
+    /* decriment ref-count (and free) part_infos */
+    json_object_put(part_infos);
+}
 
-//#warning FIX THE STRING THAT WE PRODUCE HERE SO ITS A SINGLE JSON ARRAY OBJECT
-    /* This processor's work on the file is just to write its part_infos */
-    fprintf(myFile, "%s\n", json_object_to_json_string_ext(part_infos, JSON_C_TO_STRING_PRETTY));
+/*! \brief A file mapped into memory by main_load() */
+typedef struct _mapped_file_t
+{
+    char *name;  /**< Name of the mapped file */
+    void *base;  /**< Address at which it is mapped */
+    size_t len;  /**< Length of the mapping */
+} mapped_file_t;
 
-    MACSIO_MIF_HandOffBaton(bat, myFile);
+static mapped_file_t *mapped_files = 0; /**< Files mapped by the most recent load */
+static int num_mapped_files = 0;        /**< Number of entries in \c mapped_files */
 
-    MACSIO_MIF_Finish(bat);
+/*! \brief Return the memory map of a file, mapping it if not already mapped */
+static char const *map_file(char const *fileName)
+{
+    int i, fd;
+    struct stat st;
+    void *base;
 
-    /* decriment ref-count (and free) part_infos */
-    json_object_put(part_infos);
+    for (i = 0; i < num_mapped_files; i++)
+    {
+        if (!strcmp(mapped_files[i].name, fileName))
+            return (char const *) mapped_files[i].base;
+    }
+
+    fd = open(fileName, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\"", fileName));
+    base = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        MACSIO_LOG_MSG(Die, ("Unable to mmap \"%s\"", fileName));
+
+    mapped_files = (mapped_file_t *) realloc(mapped_files, (num_mapped_files+1) * sizeof(mapped_file_t));
+    mapped_files[num_mapped_files].name = strdup(fileName);
+    mapped_files[num_mapped_files].base = base;
+    mapped_files[num_mapped_files].len = (size_t) st.st_size;
+    num_mapped_files++;
+
+    return (char const *) base;
+}
+
+/*! \brief Unmap all the files mapped by the previous load */
+static void unmap_files(void)
+{
+    int i;
+    for (i = 0; i < num_mapped_files; i++)
+    {
+        munmap(mapped_files[i].base, mapped_files[i].len);
+        free(mapped_files[i].name);
+    }
+    free(mapped_files);
+    mapped_files = 0;
+    num_mapped_files = 0;
+}
+
+/*!
+\brief Main load implementation for this plugin
+
+Reads files written with \c --binary. The root file named by \c path is read by
+rank 0 and broadcast. The parts it lists are then divided evenly among the tasks.
+Each task maps the files holding its parts and returns each selected variable
+(see \c --read_vars) as an extarr whose data points directly into the mapping.
+No variable data is copied. The mappings stay valid until the next load.
+*/
+static void main_load(
+    int argi,                    /**< [in] Command-line argument index at which first plugin-specific arg appears */
+    int argc,                    /**< [in] argc from main */
+    char **argv,                 /**< [in] argv from main */
+    char const *path,            /**< [in] Name of the root file to read */
+    json_object *main_obj,       /**< [in] The main json object */
+    json_object **data_read_obj  /**< [out] The data read, in the same shape as main_obj's "problem" */
+)
+{
+    int i, j, k;
+    int rank = JsonGetInt(main_obj, "parallel/mpi_rank");
+    int size = JsonGetInt(main_obj, "parallel/mpi_size");
+    char const *read_vars = JsonGetStr(main_obj, "clargs/read_vars");
+    long long len = 0;
+    char *buf = 0;
+    json_object *root, *parts_out, *problem;
+    MACSIO_TIMING_GroupMask_t main_load_grp = MACSIO_TIMING_GroupMask("main_load");
+    MACSIO_TIMING_TimerId_t main_load_tid;
+    double timer_dt;
+
+    process_args(argi, argc, argv);
+
+    /* Read the root file on rank 0 and give it to everyone */
+    main_load_tid = MT_StartTimer("read_root_file", main_load_grp, 0);
+    if (rank == 0)
+    {
+        FILE *rootFile = fopen(path, "r");
+        if (!rootFile)
+            MACSIO_LOG_MSG(Die, ("Unable to open root file \"%s\"", path));
+        fseeko(rootFile, 0, SEEK_END);
+        len = (long long) ftello(rootFile);
+        fseeko(rootFile, 0, SEEK_SET);
+        buf = (char *) malloc(len + 1);
+        if (fread(buf, 1, (size_t) len, rootFile) != (size_t) len)
+            MACSIO_LOG_MSG(Die, ("Unable to read root file \"%s\"", path));
+        fclose(rootFile);
+    }
+#ifdef HAVE_MPI
+    MPI_Bcast(&len, 1, MPI_LONG_LONG, 0, MACSIO_MAIN_Comm);
+    if (rank != 0)
+        buf = (char *) malloc(len + 1);
+    MPI_Bcast(buf, (int) len, MPI_CHAR, 0, MACSIO_MAIN_Comm);
+#endif
+    buf[len] = '\0';
+    root = json_tokener_parse(buf);
+    free(buf);
+    if (!root)
+        MACSIO_LOG_MSG(Die, ("Unable to parse root file \"%s\"", path));
+    timer_dt = MT_StopTimer(main_load_tid);
+
+    unmap_files();
+
+    /* This task's share of the parts */
+    parts_out = json_object_new_array();
+    main_load_tid = MT_StartTimer("map_parts", main_load_grp, 0);
+    for (k = (int) ((long long) rank * json_object_array_length(root) / size);
+         k < (int) ((long long) (rank+1) * json_object_array_length(root) / size); k++)
+    {
+        json_object *part_info = json_object_array_get_idx(root, k);
+        json_object *var_infos = json_object_path_get_array(part_info, "vars");
+        char const *fileName = json_object_path_get_string(part_info, "file");
+        char const *base;
+        char *header_str;
+        size_t header_len;
+        json_object *part_obj, *vars_out;
+
+        if (!var_infos)
+            MACSIO_LOG_MSG(Die, ("\"%s\" was not written with --binary", path));
+
+        base = map_file(fileName);
+
+        /* Parse the part's small JSON header for its mesh */
+        header_len = (size_t) json_object_path_get_double(part_info, "length");
+        header_str = (char *) malloc(header_len + 1);
+        memcpy(header_str, base + (size_t) json_object_path_get_double(part_info, "offset"), header_len);
+        header_str[header_len] = '\0';
+        part_obj = json_tokener_parse(header_str);
+        free(header_str);
+        if (!part_obj)
+            MACSIO_LOG_MSG(Die, ("Unable to parse header of part %d in \"%s\"", k, fileName));
+
+        /* Wrap each selected variable's bytes in the mapping as an extarr */
+        vars_out = json_object_new_array();
+        for (i = 0; i < json_object_array_length(var_infos); i++)
+        {
+            json_object *var_info = json_object_array_get_idx(var_infos, i);
+            json_object *dims_array = json_object_path_get_array(var_info, "dims");
+            json_object *var_obj;
+            char const *name = json_object_path_get_string(var_info, "name");
+            int ndims = json_object_array_length(dims_array);
+            int dims[4];
+
+            if (!MACSIO_UTILS_VarIsSelected(read_vars, name))
+                continue;
+
+            for (j = 0; j < ndims && j < 4; j++)
+                dims[j] = json_object_get_int(json_object_array_get_idx(dims_array, j));
+
+            var_obj = json_object_new_object();
+            json_object_object_add(var_obj, "name", json_object_new_string(name));
+            json_object_object_add(var_obj, "centering",
+                json_object_new_string(json_object_path_get_string(var_info, "centering")));
+            json_object_object_add(var_obj, "data", json_object_new_extarr(
+                base + (size_t) json_object_path_get_double(var_info, "offset"),
+                (enum json_extarr_type) json_object_path_get_int(var_info, "type"), ndims, dims, 0));
+            json_object_array_add(vars_out, var_obj);
+        }
+        json_object_object_add(part_obj, "Vars", vars_out);
+        json_object_array_add(parts_out, part_obj);
+    }
+    timer_dt = MT_StopTimer(main_load_tid);
+
+    json_object_put(root);
+
+    problem = json_object_new_object();
+    json_object_object_add(problem, "parts", parts_out);
+    *data_read_obj = json_object_new_object();
+    json_object_object_add(*data_read_obj, "problem", problem);
 }
 
 /*!
@@ -339,6 +728,7 @@ static int register_this_interface()
     strcpy(iface.name, iface_name);
     strcpy(iface.ext, iface_ext);
     iface.dumpFunc = main_dump;
+    iface.loadFunc = main_load;
     iface.processArgsFunc = process_args;
 
     /* Register this plugin */
@@ -0,0 +1,516 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+end-of-copyright-header */
+
+#include <json-cwx/json.h>
+
+#include <macsio_clargs.h>
+#include <macsio_iface.h>
+#include <macsio_log.h>
+#include <macsio_main.h>
+#include <macsio_utils.h>
+#include <macsio_timing.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+\addtogroup plugins
+@{
+*/
+
+/*!
+\addtogroup MPIIO
+\brief A plugin writing global arrays with MPI-IO and no I/O library
+
+Each variable is written to a single shared file as one global array spanning the
+whole mesh, the same arrays the HDF5 plugin writes in SIF mode. A part's piece of
+an array is described with \c MPI_Type_create_subarray from its \c GlobalLogOrigin
+and \c LogDims. The pieces of all of a part's variables are combined into one file
+view and one memory type, so each part is one \c MPI_File_set_view and one write.
+The timings isolate the MPI-IO layer (e.g. ROMIO's two-phase collective buffering)
+from any overhead HDF5 adds on top of it.
+
+The file holds the variables' arrays back to back with no header. A small JSON file
+written by rank 0 gives each variable's name, centering, type, dimensions and offset.
+@{
+*/
+
+static char const *iface_name = "mpiio"; /**< Name of the interface this plugin uses */
+static char const *iface_ext = "dat";    /**< Default file extension for files generated by this plugin */
+static char *write_method = 0;           /**< One of collective, independent or nonblocking */
+
+#ifdef HAVE_MPI
+
+/*! \brief Ways of writing each part */
+typedef enum _write_mode_t
+{
+    WRITE_COLLECTIVE,  /**< MPI_File_write_all */
+    WRITE_INDEPENDENT, /**< MPI_File_write */
+    WRITE_NONBLOCKING  /**< MPI_File_iwrite_all */
+} write_mode_t;
+
+static write_mode_t write_mode = WRITE_COLLECTIVE; /**< Decoded \c write_method */
+
+#endif
+
+/*!
+\brief Process command-line arguments specific to this plugin
+
+Uses MACSIO_CLARGS_ProcessCmdline() to do its work. MPI-IO hints come from
+MACSio's \c --mpi_hints argument.
+*/
+static int process_args(
+    int argi,      /**< [in] Argument index of first argument that is specific to this plugin */
+    int argc,      /**< [in] argc as passed into main */
+    char *argv[]   /**< [in] argv as passed into main */
+)
+{
+    const MACSIO_CLARGS_ArgvFlags_t argFlags = {MACSIO_CLARGS_WARN, MACSIO_CLARGS_TOMEM};
+
+    MACSIO_CLARGS_ProcessCmdline(0, argFlags, argi, argc, argv,
+        "--method %s", "collective",
+            "How each part is written. One of \"collective\" (MPI_File_write_all),\n"
+            "\"independent\" (MPI_File_write) or \"nonblocking\" (MPI_File_iwrite_all).\n"
+            "With nonblocking, the next part's datatypes are built while the previous\n"
+            "part's write is in flight.",
+            &write_method,
+           MACSIO_CLARGS_END_OF_ARGS);
+
+#ifdef HAVE_MPI
+    if (!strcmp(write_method, "collective"))
+        write_mode = WRITE_COLLECTIVE;
+    else if (!strcmp(write_method, "independent"))
+        write_mode = WRITE_INDEPENDENT;
+    else if (!strcmp(write_method, "nonblocking"))
+    {
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+        write_mode = WRITE_NONBLOCKING;
+#else
+        MACSIO_LOG_MSG(Warn, ("MPI_File_iwrite_all needs MPI 3.1. Using collective writes."));
+        write_mode = WRITE_COLLECTIVE;
+#endif
+    }
+    else
+        MACSIO_LOG_MSG(Die, ("Unknown --method \"%s\"", write_method));
+#endif
+
+    return 0;
+}
+
+#ifdef HAVE_MPI
+
+/*! \brief A variable's global array in the file */
+typedef struct _global_var_t
+{
+    char const *name;           /**< Name of the variable */
+    int is_zonal;               /**< Zone- rather than node-centered */
+    enum json_extarr_type type; /**< Type of its values */
+    int dims[3];                /**< Global dimensions, x first */
+    MPI_Aint offset;            /**< Offset, in bytes, of the array in the file */
+} global_var_t;
+
+/*! \brief MPI datatype of an extarr type */
+static MPI_Datatype extarr_mpi_type(enum json_extarr_type type)
+{
+    switch (type)
+    {
+        case json_extarr_type_byt08: return MPI_BYTE;
+        case json_extarr_type_int32: return MPI_INT;
+        case json_extarr_type_int64: return MPI_LONG_LONG;
+        case json_extarr_type_flt32: return MPI_FLOAT;
+        case json_extarr_type_flt64: return MPI_DOUBLE;
+        default: break;
+    }
+    MACSIO_LOG_MSG(Die, ("Unsupported extarr type %d", (int) type));
+    return MPI_DATATYPE_NULL;
+}
+
+/*!
+\brief Lay out the global arrays of the variables in the file
+
+The variables and their types come from the first part. Node-centered arrays span
+the global \c LogDims, zone-centered ones one fewer value per part in each dimension.
+
+\return The total size of the file in bytes
+*/
+static MPI_Offset layout_global_vars(
+    json_object *main_obj, /**< [in] The main JSON object */
+    int ndims,             /**< [in] Number of mesh dimensions */
+    global_var_t **vars,   /**< [out] The variables, malloc'd */
+    int *nvars)            /**< [out] Number of variables */
+{
+    json_object *first_part = JsonGetObj(main_obj, "problem/parts", 0);
+    json_object *vars_array = JsonGetObj(first_part, "Vars");
+    MPI_Offset offset = 0;
+    int i, v;
+
+    *nvars = json_object_array_length(vars_array);
+    *vars = (global_var_t *) calloc(*nvars ? *nvars : 1, sizeof(global_var_t));
+    for (v = 0; v < *nvars; v++)
+    {
+        json_object *var_obj = json_object_array_get_idx(vars_array, v);
+        global_var_t *gv = &(*vars)[v];
+        int size;
+        MPI_Offset nvals = 1;
+
+        gv->name = JsonGetStr(var_obj, "name");
+        gv->is_zonal = !strcmp(JsonGetStr(var_obj, "centering"), "zone");
+        gv->type = json_object_extarr_type(JsonGetObj(var_obj, "data"));
+        for (i = 0; i < ndims; i++)
+        {
+            gv->dims[i] = JsonGetInt(main_obj, "problem/global/LogDims", i);
+            if (gv->is_zonal)
+                gv->dims[i] -= JsonGetInt(main_obj, "problem/global/PartsLogDims", i);
+            nvals *= gv->dims[i];
+        }
+        MPI_Type_size(extarr_mpi_type(gv->type), &size);
+        gv->offset = (MPI_Aint) offset;
+        offset += nvals * size;
+    }
+    return offset;
+}
+
+/*!
+\brief Build the file view and memory type for all of a part's variables
+
+The file type is a struct of one subarray per variable, each displaced by its
+array's offset in the file. Since the arrays follow one another, the type map
+increases monotonically as MPI-IO requires. The memory type is a struct of the
+variables' buffers at their absolute addresses, to be used with \c MPI_BOTTOM.
+*/
+static void make_part_types(
+    json_object *part_obj,      /**< [in] The part */
+    global_var_t const *vars,   /**< [in] The global arrays */
+    int nvars,                  /**< [in] Number of variables */
+    int ndims,                  /**< [in] Number of mesh dimensions */
+    MPI_Datatype *ftype,        /**< [out] The file type */
+    MPI_Datatype *mtype)        /**< [out] The memory type */
+{
+    json_object *vars_array = JsonGetObj(part_obj, "Vars");
+    MPI_Datatype *subs = (MPI_Datatype *) malloc((nvars+1) * sizeof(MPI_Datatype));
+    MPI_Datatype *etypes = (MPI_Datatype *) malloc((nvars+1) * sizeof(MPI_Datatype));
+    MPI_Aint *addrs = (MPI_Aint *) malloc((nvars+1) * sizeof(MPI_Aint));
+    MPI_Aint *disps = (MPI_Aint *) malloc((nvars+1) * sizeof(MPI_Aint));
+    int *ones = (int *) malloc((nvars+1) * sizeof(int));
+    int *counts = (int *) malloc((nvars+1) * sizeof(int));
+    int i, v;
+
+    for (v = 0; v < nvars; v++)
+    {
+        json_object *data_obj = JsonGetObj(json_object_array_get_idx(vars_array, v), "data");
+        int sizes[3], subsizes[3], starts[3];
+        int nvals = 1;
+
+        /* MPI_ORDER_C has the last dimension varying fastest, so x goes last */
+        for (i = 0; i < ndims; i++)
+        {
+            sizes[ndims-1-i] = vars[v].dims[i];
+            subsizes[ndims-1-i] = JsonGetInt(part_obj, "Mesh/LogDims", i);
+            starts[ndims-1-i] = JsonGetInt(part_obj, "GlobalLogOrigin", i);
+            if (vars[v].is_zonal)
+            {
+                subsizes[ndims-1-i]--;
+                starts[ndims-1-i] -= JsonGetInt(part_obj, "GlobalLogIndices", i);
+            }
+            nvals *= subsizes[ndims-1-i];
+        }
+        if (nvals != json_object_extarr_nvals(data_obj))
+            MACSIO_LOG_MSG(Die, ("Variable \"%s\" of part %d has %d values, not %d",
+                vars[v].name, JsonGetInt(part_obj, "Mesh/ChunkID"),
+                json_object_extarr_nvals(data_obj), nvals));
+
+        etypes[v] = extarr_mpi_type(vars[v].type);
+        MPI_Type_create_subarray(ndims, sizes, subsizes, starts, MPI_ORDER_C, etypes[v], &subs[v]);
+        disps[v] = vars[v].offset;
+        ones[v] = 1;
+        MPI_Get_address((void *) json_object_extarr_data(data_obj), &addrs[v]);
+        counts[v] = nvals;
+    }
+
+    MPI_Type_create_struct(nvars, ones, disps, subs, ftype);
+    MPI_Type_commit(ftype);
+    MPI_Type_create_struct(nvars, counts, addrs, etypes, mtype);
+    MPI_Type_commit(mtype);
+
+    for (v = 0; v < nvars; v++)
+        MPI_Type_free(&subs[v]);
+    free(subs);
+    free(etypes);
+    free(addrs);
+    free(disps);
+    free(ones);
+    free(counts);
+}
+
+/*! \brief Write the JSON file describing the global arrays (rank 0 only) */
+static void write_layout_file(
+    char const *layoutName,   /**< [in] Name of the JSON file */
+    char const *dataName,     /**< [in] Name of the data file it describes */
+    global_var_t const *vars, /**< [in] The global arrays */
+    int nvars,                /**< [in] Number of variables */
+    int ndims)                /**< [in] Number of mesh dimensions */
+{
+    json_object *layout = json_object_new_object();
+    json_object *vars_array = json_object_new_array();
+    FILE *file;
+    int i, v;
+
+    for (v = 0; v < nvars; v++)
+    {
+        json_object *var_obj = json_object_new_object();
+        json_object *dims_array = json_object_new_array();
+
+        /* Slowest varying first, as in the file */
+        for (i = ndims-1; i >= 0; i--)
+            json_object_array_add(dims_array, json_object_new_int(vars[v].dims[i]));
+        json_object_object_add(var_obj, "name", json_object_new_string(vars[v].name));
+        json_object_object_add(var_obj, "centering", json_object_new_string(vars[v].is_zonal ? "zone" : "node"));
+        json_object_object_add(var_obj, "type", json_object_new_int((int) vars[v].type));
+        json_object_object_add(var_obj, "dims", dims_array);
+        json_object_object_add(var_obj, "offset", json_object_new_double((double) vars[v].offset));
+        json_object_array_add(vars_array, var_obj);
+    }
+    json_object_object_add(layout, "file", json_object_new_string(dataName));
+    json_object_object_add(layout, "vars", vars_array);
+
+    file = fopen(layoutName, "w");
+    if (!file)
+        MACSIO_LOG_MSG(Die, ("Unable to create \"%s\"", layoutName));
+    fprintf(file, "%s\n", json_object_to_json_string_ext(layout, JSON_C_TO_STRING_PRETTY));
+    fclose(file);
+    json_object_put(layout);
+}
+
+/*! \brief Log the collective buffering hints MPI-IO is actually using */
+static void log_cb_hints(MPI_File fh)
+{
+    static char const *keys[] = {"romio_cb_write", "cb_nodes", "cb_buffer_size", "striping_factor",
+                                 "striping_unit", "romio_ds_write"};
+    MPI_Info info;
+    char value[MPI_MAX_INFO_VAL+1];
+    int i, flag;
+
+    MPI_File_get_info(fh, &info);
+    for (i = 0; i < (int) (sizeof(keys)/sizeof(keys[0])); i++)
+    {
+        MPI_Info_get(info, (char *) keys[i], MPI_MAX_INFO_VAL, value, &flag);
+        if (flag)
+            MACSIO_LOG_MSG(Dbg1, ("MPI-IO hint %s=%s", keys[i], value));
+    }
+    MPI_Info_free(&info);
+}
+
+#endif
+
+/*!
+\brief Main dump implementation for this plugin
+
+All tasks open one file per dump. Every task makes the same number of
+\c MPI_File_set_view calls (the most parts on any task) since the call is
+collective. Tasks with fewer parts set an empty view and write nothing for
+the rest.
+*/
+static void main_dump(
+    int argi,               /**< [in] Command-line argument index at which first plugin-specific arg appears */
+    int argc,               /**< [in] argc from main */
+    char **argv,            /**< [in] argv from main */
+    json_object *main_obj,  /**< [in] The main json object representing all data to be dumped */
+    int dumpn,              /**< [in] The number/index of this dump */
+    double dumpt            /**< [in] The time to be associated with this dump (like a simulation's time) */
+)
+{
+#ifdef HAVE_MPI
+    MACSIO_TIMING_GroupMask_t grp = MACSIO_TIMING_GroupMask("main_dump");
+    MACSIO_TIMING_TimerId_t tid;
+    int rank = JsonGetInt(main_obj, "parallel/mpi_rank");
+    int ndims = JsonGetInt(main_obj, "clargs/part_dim");
+    json_object *parts = JsonGetObj(main_obj, "problem/parts");
+    int nparts = json_object_array_length(parts);
+    int part_range[2] = {-nparts, nparts};
+    char fileName[256], layoutName[256];
+    json_object *parfmode_obj;
+    char const *modestr;
+    global_var_t *vars;
+    int nvars, p, mpi_errno;
+    MPI_Offset file_size;
+    MPI_Info info;
+    MPI_File fh;
+    MPI_Request req = MPI_REQUEST_NULL;
+    MPI_Status status;
+
+    process_args(argi, argc, argv);
+
+    parfmode_obj = JsonGetObj(main_obj, "clargs/parallel_file_mode");
+    if (parfmode_obj)
+        modestr = json_object_get_string(json_object_array_get_idx(parfmode_obj, 0));
+    else
+        modestr = JsonGetStr(main_obj, "clargs/parallel_file_mode");
+    if (strcmp(modestr, "SIF"))
+        MACSIO_LOG_MSG(Warn, ("The mpiio plugin writes one file per dump. Ignoring %s mode.", modestr));
+
+    /* The fewest and most parts on any task */
+    MPI_Allreduce(MPI_IN_PLACE, part_range, 2, MPI_INT, MPI_MAX, MACSIO_MAIN_Comm);
+    if (part_range[0] == 0)
+        MACSIO_LOG_MSG(Die, ("The mpiio plugin needs at least one part on every task. "
+                             "Set --avg_num_parts to 1 or more."));
+
+    file_size = layout_global_vars(main_obj, ndims, &vars, &nvars);
+
+    sprintf(fileName, "%s_mpiio_%03d.%s", JsonGetStr(main_obj, "clargs/filebase"), dumpn, iface_ext);
+    sprintf(layoutName, "%s_mpiio_%03d.json", JsonGetStr(main_obj, "clargs/filebase"), dumpn);
+    MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
+    MACSIO_UTILS_RecordOutputFiles(dumpn, layoutName);
+
+    info = MACSIO_UTILS_MPIInfoFromHints(JsonGetStr(main_obj, "clargs/mpi_hints"));
+
+    tid = MT_StartTimer("MPI_File_open", grp, dumpn);
+    mpi_errno = MPI_File_open(MACSIO_MAIN_Comm, fileName, MPI_MODE_CREATE|MPI_MODE_WRONLY, info, &fh);
+    if (mpi_errno != MPI_SUCCESS)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\"", fileName));
+    MPI_File_set_size(fh, file_size);
+    MT_StopTimer(tid);
+    if (rank == 0 && dumpn == 0)
+        log_cb_hints(fh);
+
+    for (p = 0; p < part_range[1]; p++)
+    {
+        MPI_Datatype ftype = MPI_BYTE, mtype = MPI_BYTE;
+        int count = 0;
+
+        tid = MT_StartTimer("make types", grp, dumpn);
+        if (p < nparts)
+        {
+            make_part_types(json_object_array_get_idx(parts, p), vars, nvars, ndims, &ftype, &mtype);
+            count = 1;
+        }
+        MT_StopTimer(tid);
+
+        /* A view can't change under a pending write */
+        if (req != MPI_REQUEST_NULL)
+        {
+            tid = MT_StartTimer("MPI_Wait", grp, dumpn);
+            MPI_Wait(&req, &status);
+            MT_StopTimer(tid);
+        }
+
+        tid = MT_StartTimer("MPI_File_set_view", grp, dumpn);
+        MPI_File_set_view(fh, 0, MPI_BYTE, ftype, (char *) "native", info);
+        MT_StopTimer(tid);
+
+        tid = MT_StartTimer("write", grp, dumpn);
+        if (write_mode == WRITE_INDEPENDENT)
+        {
+            if (count)
+                MPI_File_write(fh, MPI_BOTTOM, count, mtype, &status);
+        }
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+        else if (write_mode == WRITE_NONBLOCKING)
+            MPI_File_iwrite_all(fh, MPI_BOTTOM, count, mtype, &req);
+#endif
+        else
+            MPI_File_write_all(fh, MPI_BOTTOM, count, mtype, &status);
+        MT_StopTimer(tid);
+
+        /* Types may be freed while an operation using them is pending */
+        if (count)
+        {
+            MPI_Type_free(&ftype);
+            MPI_Type_free(&mtype);
+        }
+    }
+
+    if (req != MPI_REQUEST_NULL)
+    {
+        tid = MT_StartTimer("MPI_Wait", grp, dumpn);
+        MPI_Wait(&req, &status);
+        MT_StopTimer(tid);
+    }
+
+    tid = MT_StartTimer("MPI_File_close", grp, dumpn);
+    MPI_File_close(&fh);
+    MT_StopTimer(tid);
+    if (info != MPI_INFO_NULL)
+        MPI_Info_free(&info);
+
+    if (rank == 0)
+        write_layout_file(layoutName, fileName, vars, nvars, ndims);
+
+    free(vars);
+#else
+    MACSIO_LOG_MSG(Die, ("The mpiio plugin needs MACSio built with MPI"));
+#endif
+}
+
+/*!
+\brief Method to register this plugin with MACSio main
+
+Due to its use to initialize a file-scope, static const variable, this
+function winds up being called at load time (e.g. before main is even called).
+
+Its purpose is to add key information about this plugin to MACSio's global
+interface table.
+*/
+static int register_this_interface()
+{
+    MACSIO_IFACE_Handle_t iface;
+
+    if (strlen(iface_name) >= MACSIO_IFACE_MAX_NAME)
+        MACSIO_LOG_MSG(Die, ("Interface name \"%s\" too long", iface_name));
+
+    /* Populate information about this plugin */
+    strcpy(iface.name, iface_name);
+    strcpy(iface.ext, iface_ext);
+    iface.dumpFunc = main_dump;
+    iface.processArgsFunc = process_args;
+
+    /* Register this plugin */
+    if (!MACSIO_IFACE_Register(&iface))
+        MACSIO_LOG_MSG(Die, ("Failed to register interface \"%s\"", iface_name));
+
+    return 0;
+}
+
+/*!
+\brief Dummy initializer to trigger register_this_interface by the loader
+
+This one statement is the only statement requiring compilation by
+a C++ compiler. That is because it involves initialization and non
+constant expressions (a function call in this case). This function
+call is guaranteed to occur during *initialization* (that is before
+even 'main' is called) and so will have the effect of populating the
+iface_map array merely by virtue of the fact that this code is linked
+with a main.
+*/
+static int const dummy = register_this_interface();
+
+/*!@}*/
+
+/*!@}*/
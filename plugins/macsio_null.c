@@ -0,0 +1,474 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+end-of-copyright-header */
+
+#include <json-cwx/json.h>
+
+#include <macsio_clargs.h>
+#include <macsio_iface.h>
+#include <macsio_log.h>
+#include <macsio_main.h>
+#include <macsio_utils.h>
+#include <macsio_timing.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_HDF5
+#include <hdf5.h>
+#endif
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+\addtogroup plugins
+@{
+*/
+
+/*!
+\addtogroup Null
+\brief A plugin that marshals each dump and throws it away
+
+This plugin goes through the whole dump path, iterating over \c problem/parts and
+turning each part into bytes the way a real plugin would, and then discards the
+bytes into a memory buffer or \c /dev/null. Nothing reaches storage, so its timings
+are the CPU and memory bandwidth cost of marshaling alone. When dumps slow down,
+comparing them with this plugin's tells whether the library path or the storage
+is to blame.
+
+The bytes can be made as the miftmpl plugin makes them (JSON text), as the raw
+plugin does (the extarrs packed at an alignment) or, when built with HDF5, as an
+HDF5 file in memory from the core VFD with no backing store.
+@{
+*/
+
+static char const *iface_name = "null"; /**< Name of the interface this plugin uses */
+static char const *iface_ext = "null";  /**< Default file extension for files generated by this plugin */
+static char *format_str = 0;            /**< How to marshal parts: json, raw or hdf5 */
+static char *sink_str = 0;              /**< Where the bytes go: memory or devnull */
+static int align = 8;                   /**< Alignment, in bytes, of each extarr in raw format */
+
+/*! \brief Ways of marshaling a part */
+typedef enum _format_t
+{
+    FORMAT_JSON, /**< JSON text, as the miftmpl plugin writes */
+    FORMAT_RAW,  /**< Extarrs packed at \c align, as the raw plugin writes */
+    FORMAT_HDF5  /**< An HDF5 file image from the core VFD */
+} format_t;
+
+static format_t format = FORMAT_RAW; /**< Decoded \c format_str */
+static int sink_devnull = 0;         /**< Discard into /dev/null rather than memory */
+
+/*!
+\brief Process command-line arguments specific to this plugin
+
+Uses MACSIO_CLARGS_ProcessCmdline() to do its work.
+*/
+static int process_args(
+    int argi,      /**< [in] Argument index of first argument that is specific to this plugin */
+    int argc,      /**< [in] argc as passed into main */
+    char *argv[]   /**< [in] argv as passed into main */
+)
+{
+    const MACSIO_CLARGS_ArgvFlags_t argFlags = {MACSIO_CLARGS_WARN, MACSIO_CLARGS_TOMEM};
+
+    MACSIO_CLARGS_ProcessCmdline(0, argFlags, argi, argc, argv,
+        "--format %s", "raw",
+            "How each part is marshaled. One of \"json\" (JSON text, as miftmpl writes),\n"
+            "\"raw\" (the extarrs packed at --align, as the raw plugin writes) or \"hdf5\"\n"
+            "(an HDF5 file built in memory by the core VFD with no backing store).",
+            &format_str,
+        "--sink %s", "memory",
+            "Where the marshaled bytes go. One of \"memory\" (copied into a buffer that\n"
+            "is reused every dump) or \"devnull\" (written to /dev/null).",
+            &sink_str,
+        "--align %d", "8",
+            "Alignment, in bytes, of each extarr in raw format. Must be a power of 2.",
+            &align,
+           MACSIO_CLARGS_END_OF_ARGS);
+
+    if (!strcmp(format_str, "json"))
+        format = FORMAT_JSON;
+    else if (!strcmp(format_str, "raw"))
+        format = FORMAT_RAW;
+    else if (!strcmp(format_str, "hdf5"))
+    {
+#ifdef HAVE_HDF5
+        format = FORMAT_HDF5;
+#else
+        MACSIO_LOG_MSG(Die, ("The null plugin was built without HDF5"));
+#endif
+    }
+    else
+        MACSIO_LOG_MSG(Die, ("Unknown --format \"%s\"", format_str));
+
+    if (!strcmp(sink_str, "memory"))
+        sink_devnull = 0;
+    else if (!strcmp(sink_str, "devnull"))
+        sink_devnull = 1;
+    else
+        MACSIO_LOG_MSG(Die, ("Unknown --sink \"%s\"", sink_str));
+
+    if (align < 1 || (align & (align - 1)))
+        MACSIO_LOG_MSG(Die, ("--align %d is not a power of 2", align));
+
+    return 0;
+}
+
+/*! \brief Where marshaled bytes are discarded */
+typedef struct _sink_t
+{
+    int fd;                   /**< Descriptor of /dev/null, or -1 for memory */
+    unsigned long long total; /**< Bytes discarded this dump */
+} sink_t;
+
+static char *sink_buf = 0;     /**< The memory sink, kept from dump to dump */
+static size_t sink_cap = 0;    /**< Size of \c sink_buf */
+
+/*! \brief Discard \c len bytes into the sink */
+static void sink_bytes(
+    sink_t *sink,       /**< [in] The sink */
+    void const *buf,    /**< [in] The bytes */
+    size_t len,         /**< [in] Number of bytes */
+    int dumpn)          /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_TimerId_t tid = MT_StartTimer("sink", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+
+    if (sink->fd < 0)
+    {
+        /* Touch every byte as a write to storage would, without keeping more than the largest */
+        if (len > sink_cap)
+        {
+            free(sink_buf);
+            sink_buf = (char *) malloc(len);
+            sink_cap = len;
+        }
+        memcpy(sink_buf, buf, len);
+    }
+    else
+    {
+        char const *p = (char const *) buf;
+        size_t left = len;
+        while (left > 0)
+        {
+            ssize_t n = write(sink->fd, p, left);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                MACSIO_LOG_MSG(Die, ("Write to /dev/null failed: %s", strerror(errno)));
+            p += n;
+            left -= (size_t) n;
+        }
+    }
+    sink->total += len;
+
+    MT_StopTimer(tid);
+}
+
+/*! \brief Where packing of a part's extarrs has got to */
+typedef struct _pack_state_t
+{
+    char *buf;  /**< Buffer to pack into, or null to only size it */
+    size_t pos; /**< Offset of the next free byte in \c buf */
+} pack_state_t;
+
+/*!
+\brief Pack an extarr at the next multiple of \c align (a MACSIO_UTILS_ExtarrVisitor_t)
+
+With a null buffer, only advances the position, so a first pass can size the buffer.
+*/
+static void pack_extarr(
+    json_object *obj, /**< [in] The extarr */
+    char const *path, /**< [in] Its path within the part (unused) */
+    void *data)       /**< [in/out] The pack_state_t */
+{
+    pack_state_t *st = (pack_state_t *) data;
+    size_t len = json_object_extarr_nvals(obj) * MACSIO_UTILS_ExtarrValSize(json_object_extarr_type(obj));
+    size_t start = (st->pos + align - 1) & ~((size_t) align - 1);
+
+    (void) path;
+    if (st->buf)
+    {
+        memset(st->buf + st->pos, 0, start - st->pos);
+        memcpy(st->buf + start, json_object_extarr_data(obj), len);
+    }
+    st->pos = start + len;
+}
+
+/*! \brief Marshal a part as JSON text, as the miftmpl plugin does, and sink it */
+static void marshal_json(
+    sink_t *sink,          /**< [in] The sink */
+    json_object *part_obj, /**< [in] The part */
+    int dumpn)             /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_TimerId_t tid = MT_StartTimer("marshal", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+    char const *str = json_object_to_json_string_ext(part_obj, JSON_C_TO_STRING_PLAIN);
+    MT_StopTimer(tid);
+
+    sink_bytes(sink, str, strlen(str), dumpn);
+    json_object_free_printbuf(part_obj);
+}
+
+/*! \brief Marshal a part's extarrs packed at \c align, as the raw plugin does, and sink them */
+static void marshal_raw(
+    sink_t *sink,          /**< [in] The sink */
+    json_object *part_obj, /**< [in] The part */
+    int dumpn)             /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_TimerId_t tid = MT_StartTimer("marshal", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+    pack_state_t st = {0, 0};
+
+    MACSIO_UTILS_ForEachExtarr(part_obj, pack_extarr, &st);
+    st.buf = (char *) malloc(st.pos ? st.pos : 1);
+    st.pos = 0;
+    MACSIO_UTILS_ForEachExtarr(part_obj, pack_extarr, &st);
+    MT_StopTimer(tid);
+
+    sink_bytes(sink, st.buf, st.pos, dumpn);
+    free(st.buf);
+}
+
+#ifdef HAVE_HDF5
+
+/*! \brief HDF5 native type of an extarr type */
+static hid_t extarr_h5type(enum json_extarr_type type)
+{
+    switch (type)
+    {
+        case json_extarr_type_byt08: return H5T_NATIVE_UCHAR;
+        case json_extarr_type_int32: return H5T_NATIVE_INT;
+        case json_extarr_type_int64: return H5T_NATIVE_LLONG;
+        case json_extarr_type_flt32: return H5T_NATIVE_FLOAT;
+        case json_extarr_type_flt64: return H5T_NATIVE_DOUBLE;
+        default: break;
+    }
+    MACSIO_LOG_MSG(Die, ("Unsupported extarr type %d", (int) type));
+    return -1;
+}
+
+/*! \brief Where a part's extarrs are written */
+typedef struct _h5_dest_t
+{
+    hid_t loc;  /**< Group of the part */
+    hid_t lcpl; /**< Link creation properties creating intermediate groups */
+} h5_dest_t;
+
+/*! \brief Write an extarr as a dataset named by its path (a MACSIO_UTILS_ExtarrVisitor_t) */
+static void write_h5_extarr(
+    json_object *obj, /**< [in] The extarr */
+    char const *path, /**< [in] Its path within the part */
+    void *data)       /**< [in] The h5_dest_t */
+{
+    h5_dest_t const *dest = (h5_dest_t const *) data;
+    int i, ndims = json_object_extarr_ndims(obj);
+    hsize_t dims[4];
+    hid_t type = extarr_h5type(json_object_extarr_type(obj));
+    hid_t space, ds;
+
+    /* HDF5 has the last dimension varying fastest */
+    for (i = 0; i < ndims; i++)
+        dims[ndims-1-i] = (hsize_t) json_object_extarr_dim(obj, i);
+    space = H5Screate_simple(ndims, dims, 0);
+    ds = H5Dcreate2(dest->loc, path, type, space, dest->lcpl, H5P_DEFAULT, H5P_DEFAULT);
+    H5Dwrite(ds, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, json_object_extarr_data(obj));
+    H5Dclose(ds);
+    H5Sclose(space);
+}
+
+/*!
+\brief Marshal all parts into one HDF5 file in memory and sink its image
+
+The file uses the core VFD with its backing store disabled, as the HDF5 plugin's
+\c --core_staging does, so nothing is written to disk. Each part is a group
+holding one dataset per extarr.
+*/
+static void marshal_hdf5(
+    sink_t *sink,          /**< [in] The sink */
+    json_object *main_obj, /**< [in] The main JSON object */
+    int dumpn)             /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_GroupMask_t grp = MACSIO_TIMING_GroupMask("main_dump");
+    MACSIO_TIMING_TimerId_t tid = MT_StartTimer("marshal", grp, dumpn);
+    json_object *parts = JsonGetObj(main_obj, "problem/parts");
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+    char fileName[256], groupName[64];
+    ssize_t image_size;
+    void *image;
+    hid_t h5File;
+    int i;
+
+    H5Pset_fapl_core(fapl, 1<<20, 0);
+    H5Pset_create_intermediate_group(lcpl, 1);
+    sprintf(fileName, "%s_null_%05d_%03d.h5", JsonGetStr(main_obj, "clargs/filebase"),
+        JsonGetInt(main_obj, "parallel/mpi_rank"), dumpn);
+    h5File = H5Fcreate(fileName, H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    if (h5File < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to create in-memory HDF5 file"));
+
+    for (i = 0; i < json_object_array_length(parts); i++)
+    {
+        json_object *part_obj = json_object_array_get_idx(parts, i);
+        h5_dest_t dest;
+
+        sprintf(groupName, "domain_%07d", JsonGetInt(part_obj, "Mesh/ChunkID"));
+        dest.loc = H5Gcreate2(h5File, groupName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        dest.lcpl = lcpl;
+        MACSIO_UTILS_ForEachExtarr(part_obj, write_h5_extarr, &dest);
+        H5Gclose(dest.loc);
+    }
+
+    H5Fflush(h5File, H5F_SCOPE_GLOBAL);
+    image_size = H5Fget_file_image(h5File, 0, 0);
+    image = malloc(image_size > 0 ? (size_t) image_size : 1);
+    if (image_size > 0)
+        H5Fget_file_image(h5File, image, (size_t) image_size);
+    H5Fclose(h5File);
+    H5Pclose(lcpl);
+    H5Pclose(fapl);
+    MT_StopTimer(tid);
+
+    sink_bytes(sink, image, image_size > 0 ? (size_t) image_size : 0, dumpn);
+    free(image);
+}
+
+#endif
+
+/*!
+\brief Main dump implementation for this plugin
+
+Marshals this task's parts in the chosen format and discards the bytes. No task
+waits on another, and no file is recorded. Rank 0 logs the bytes marshaled over
+all tasks and the slowest task's time.
+*/
+static void main_dump(
+    int argi,               /**< [in] Command-line argument index at which first plugin-specific arg appears */
+    int argc,               /**< [in] argc from main */
+    char **argv,            /**< [in] argv from main */
+    json_object *main_obj,  /**< [in] The main json object representing all data to be dumped */
+    int dumpn,              /**< [in] The number/index of this dump */
+    double dumpt            /**< [in] The time to be associated with this dump (like a simulation's time) */
+)
+{
+    json_object *parts = JsonGetObj(main_obj, "problem/parts");
+    sink_t sink = {-1, 0};
+    unsigned long long total;
+    double t0 = MT_Time(), dt;
+    char nbytes_str[32], seconds_str[32], bandwidth_str[32];
+    int i;
+
+    process_args(argi, argc, argv);
+
+    if (sink_devnull)
+    {
+        sink.fd = open("/dev/null", O_WRONLY);
+        if (sink.fd < 0)
+            MACSIO_LOG_MSG(Die, ("Unable to open /dev/null: %s", strerror(errno)));
+    }
+
+#ifdef HAVE_HDF5
+    if (format == FORMAT_HDF5)
+        marshal_hdf5(&sink, main_obj, dumpn);
+    else
+#endif
+    for (i = 0; i < json_object_array_length(parts); i++)
+    {
+        json_object *part_obj = json_object_array_get_idx(parts, i);
+        if (format == FORMAT_JSON)
+            marshal_json(&sink, part_obj, dumpn);
+        else
+            marshal_raw(&sink, part_obj, dumpn);
+    }
+
+    if (sink.fd >= 0)
+        close(sink.fd);
+    dt = MT_Time() - t0;
+
+    total = sink.total;
+#ifdef HAVE_MPI
+    MPI_Reduce(MACSIO_MAIN_Rank ? &total : MPI_IN_PLACE, &total, 1, MPI_UNSIGNED_LONG_LONG,
+        MPI_SUM, 0, MACSIO_MAIN_Comm);
+    MPI_Reduce(MACSIO_MAIN_Rank ? &dt : MPI_IN_PLACE, &dt, 1, MPI_DOUBLE, MPI_MAX, 0, MACSIO_MAIN_Comm);
+    if (MACSIO_MAIN_Rank)
+        return;
+#endif
+
+    MACSIO_LOG_MSG(Info, ("Dump %02d %s to %s: %s/%s = %s", dumpn, format_str, sink_str,
+        MACSIO_UTILS_PrintBytes(total, 0, nbytes_str, sizeof(nbytes_str)),
+        MACSIO_UTILS_PrintSeconds(dt, 0, seconds_str, sizeof(seconds_str)),
+        MACSIO_UTILS_PrintBandwidth(total, dt, 0, bandwidth_str, sizeof(bandwidth_str))));
+}
+
+/*!
+\brief Method to register this plugin with MACSio main
+
+Due to its use to initialize a file-scope, static const variable, this
+function winds up being called at load time (e.g. before main is even called).
+
+Its purpose is to add key information about this plugin to MACSio's global
+interface table.
+*/
+static int register_this_interface()
+{
+    MACSIO_IFACE_Handle_t iface;
+
+    if (strlen(iface_name) >= MACSIO_IFACE_MAX_NAME)
+        MACSIO_LOG_MSG(Die, ("Interface name \"%s\" too long", iface_name));
+
+    /* Populate information about this plugin */
+    strcpy(iface.name, iface_name);
+    strcpy(iface.ext, iface_ext);
+    iface.dumpFunc = main_dump;
+    iface.processArgsFunc = process_args;
+
+    /* Register this plugin */
+    if (!MACSIO_IFACE_Register(&iface))
+        MACSIO_LOG_MSG(Die, ("Failed to register interface \"%s\"", iface_name));
+
+    return 0;
+}
+
+/*!
+\brief Dummy initializer to trigger register_this_interface by the loader
+
+This one statement is the only statement requiring compilation by
+a C++ compiler. That is because it involves initialization and non
+constant expressions (a function call in this case). This function
+call is guaranteed to occur during *initialization* (that is before
+even 'main' is called) and so will have the effect of populating the
+iface_map array merely by virtue of the fact that this code is linked
+with a main.
+*/
+static int const dummy = register_this_interface();
+
+/*!@}*/
+
+/*!@}*/
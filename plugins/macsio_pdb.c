@@ -137,6 +137,9 @@ static void main_dump_mif(json_object *main_obj, int numFiles, int dumpn, double
     MACSIO_MIF_baton_t *bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 3,
         CreatePDBFile, OpenPDBFile, ClosePDBFile, 0);
 
+    MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+        (unsigned long long) json_object_object_nbytes(JsonGetObj(main_obj, "problem"), JSON_C_FALSE));
+
     rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
     size = json_object_path_get_int(main_obj, "parallel/mpi_size");
 
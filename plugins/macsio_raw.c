@@ -0,0 +1,654 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+end-of-copyright-header */
+
+#include <json-cwx/json.h>
+
+#include <macsio_clargs.h>
+#include <macsio_iface.h>
+#include <macsio_log.h>
+#include <macsio_main.h>
+#include <macsio_mif.h>
+#include <macsio_utils.h>
+#include <macsio_timing.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+\addtogroup plugins
+@{
+*/
+
+/*!
+\addtogroup Raw
+\brief A reference plugin writing raw bytes with POSIX calls
+
+This plugin writes the bytes of every extarr in every mesh part with \c pwritev
+(or, with \c --direct, one \c pwrite of an aligned staging buffer) and no I/O
+library in between. Where each extarr landed is recorded in a small index file.
+Its timings are a "speed of light" against which the overhead of the library
+plugins can be judged for any mesh configuration.
+
+In MIF mode, tasks take turns appending to their group's file with \ref MACSIO_MIF.
+In SIF mode, every task writes to one shared file at an offset given by an
+\c MPI_Exscan of the number of bytes each task writes.
+@{
+*/
+
+static char const *iface_name = "raw"; /**< Name of the interface this plugin uses */
+static char const *iface_ext = "raw";  /**< Default file extension for files generated by this plugin */
+static int use_direct = 0;             /**< Open files with O_DIRECT */
+static int align = 0;                  /**< Alignment, in bytes, of each extarr in the file */
+static int preallocate = 0;            /**< posix_fallocate each task's range before writing */
+static char *fsync_policy = 0;         /**< When to fsync: none, close or write */
+
+/*! \brief Set of file sync policies */
+typedef enum _fsync_mode_t
+{
+    FSYNC_NONE,  /**< Never sync */
+    FSYNC_CLOSE, /**< fsync each file once, just before closing it */
+    FSYNC_WRITE  /**< fdatasync after every write */
+} fsync_mode_t;
+
+static fsync_mode_t fsync_mode = FSYNC_NONE; /**< Decoded \c fsync_policy */
+static int dump_num = 0;                     /**< Number of the dump in progress, for timers */
+
+/*!
+\brief Process command-line arguments specific to this plugin
+
+Uses MACSIO_CLARGS_ProcessCmdline() to do its work.
+*/
+static int process_args(
+    int argi,      /**< [in] Argument index of first argument that is specific to this plugin */
+    int argc,      /**< [in] argc as passed into main */
+    char *argv[]   /**< [in] argv as passed into main */
+)
+{
+    const MACSIO_CLARGS_ArgvFlags_t argFlags = {MACSIO_CLARGS_WARN, MACSIO_CLARGS_TOMEM};
+
+    MACSIO_CLARGS_ProcessCmdline(0, argFlags, argi, argc, argv,
+        "--direct", "",
+            "Open files with O_DIRECT. Each task's extarrs are copied into one aligned\n"
+            "buffer which is written with a single pwrite.",
+            &use_direct,
+        "--align %d", "0",
+            "Alignment, in bytes, of each extarr in the file and of each task's range.\n"
+            "Zero means 4096 with --direct and 8 otherwise.",
+            &align,
+        "--preallocate", "",
+            "posix_fallocate each task's range of the file before writing it.",
+            &preallocate,
+        "--fsync %s", "none",
+            "When to sync data to storage. One of \"none\", \"close\" (fsync each file\n"
+            "just before closing it) or \"write\" (fdatasync after every write).",
+            &fsync_policy,
+           MACSIO_CLARGS_END_OF_ARGS);
+
+    if (!strcmp(fsync_policy, "none"))
+        fsync_mode = FSYNC_NONE;
+    else if (!strcmp(fsync_policy, "close"))
+        fsync_mode = FSYNC_CLOSE;
+    else if (!strcmp(fsync_policy, "write"))
+        fsync_mode = FSYNC_WRITE;
+    else
+        MACSIO_LOG_MSG(Die, ("Unknown --fsync policy \"%s\"", fsync_policy));
+
+    if (align == 0)
+        align = use_direct ? 4096 : 8;
+    if (align < 1 || (align & (align - 1)))
+        MACSIO_LOG_MSG(Die, ("--align %d is not a power of 2", align));
+
+#ifndef O_DIRECT
+    if (use_direct)
+        MACSIO_LOG_MSG(Die, ("O_DIRECT is not available on this platform"));
+#endif
+
+    return 0;
+}
+
+/*! \brief Flags for opening files for writing */
+static int open_flags(void)
+{
+    int flags = O_WRONLY;
+#ifdef O_DIRECT
+    if (use_direct)
+        flags |= O_DIRECT;
+#endif
+    return flags;
+}
+
+/*! \brief Open a file for writing and return its descriptor in malloc'd memory */
+static void *open_raw_file(
+    char const *fname, /**< [in] Name of the file */
+    int flags)         /**< [in] Flags in addition to open_flags() */
+{
+    int *fd = (int *) malloc(sizeof(int));
+
+    *fd = open(fname, open_flags() | flags, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    if (*fd < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\": %s", fname, strerror(errno)));
+    return (void *) fd;
+}
+
+/*!
+\brief CreateFile MIF Callback
+
+\return A void pointer to the file's descriptor
+*/
+static void *CreateRawFile(
+    const char *fname,     /**< [in] Name of the MIF file to create */
+    const char *nsname,    /**< [in] Name of the namespace within the file for caller should use. */
+    void *userData         /**< [in] Optional plugin-specific user-defined data */
+)
+{
+    return open_raw_file(fname, O_CREAT|O_TRUNC);
+}
+
+/*!
+\brief OpenFile MIF Callback
+
+\return A void pointer to the file's descriptor
+*/
+static void *OpenRawFile(
+    const char *fname,            /**< [in] Name of the MIF file to open */
+    const char *nsname,           /**< [in] Name of the namespace within the file caller should use */
+    MACSIO_MIF_ioFlags_t ioFlags, /**< [in] Various flags indicating behavior/options */
+    void *userData                /**< [in] Optional plugin-specific user-defined data */
+)
+{
+    return open_raw_file(fname, 0);
+}
+
+/*!
+\brief CloseFile MIF Callback
+
+Syncs the file first if the fsync policy is \c close.
+*/
+static int CloseRawFile(
+    void *file,      /**< [in] A void pointer to the file's descriptor */
+    void *userData   /**< [in] Optional plugin specific user-defined data */
+)
+{
+    int fd = *((int *) file);
+    int retval;
+
+    if (fsync_mode == FSYNC_CLOSE)
+    {
+        MACSIO_TIMING_TimerId_t tid = MT_StartTimer("fsync", MACSIO_TIMING_GroupMask("main_dump"), dump_num);
+        if (fsync(fd) != 0)
+            MACSIO_LOG_MSG(Warn, ("fsync failed: %s", strerror(errno)));
+        MT_StopTimer(tid);
+    }
+    retval = close(fd);
+    free(file);
+    return retval;
+}
+
+/*! \brief One extarr to be written and where it goes relative to the task's range */
+typedef struct _raw_seg_t
+{
+    json_object *extarr; /**< The extarr */
+    char *path;          /**< Its path within the part, e.g. Mesh/Coords/XAxisCoords */
+    int partid;          /**< ChunkID of the part holding it */
+    void const *data;    /**< Its bytes */
+    size_t len;          /**< Number of bytes */
+    off_t off;           /**< Offset of its first byte from the start of the task's range */
+} raw_seg_t;
+
+/*! \brief All the extarrs a task writes in a dump */
+typedef struct _raw_layout_t
+{
+    raw_seg_t *segs; /**< The extarrs in file order */
+    int nsegs;       /**< Number of entries in \c segs */
+    off_t nbytes;    /**< Size of the task's range, a multiple of \c align */
+} raw_layout_t;
+
+/*! \brief Round \c n up to a multiple of \c align */
+static off_t align_up(off_t n)
+{
+    return (n + align - 1) & ~((off_t) align - 1);
+}
+
+/*! \brief Append an extarr to a layout (a MACSIO_UTILS_ExtarrVisitor_t) */
+static void collect_extarr(
+    json_object *obj, /**< [in] The extarr */
+    char const *path, /**< [in] Its path within the part */
+    void *data)       /**< [in/out] The raw_layout_t to append to */
+{
+    raw_layout_t *layout = (raw_layout_t *) data;
+    raw_seg_t *seg;
+
+    layout->segs = (raw_seg_t *) realloc(layout->segs, (layout->nsegs + 1) * sizeof(raw_seg_t));
+    seg = &layout->segs[layout->nsegs++];
+    seg->extarr = obj;
+    seg->path = strdup(path);
+    seg->partid = -1;
+    seg->data = json_object_extarr_data(obj);
+    seg->len = json_object_extarr_nvals(obj) * MACSIO_UTILS_ExtarrValSize(json_object_extarr_type(obj));
+    seg->off = align_up(layout->nbytes);
+    layout->nbytes = seg->off + (off_t) seg->len;
+}
+
+/*! \brief Lay out every extarr of every part on this task */
+static void make_layout(
+    json_object *main_obj, /**< [in] The main JSON object */
+    raw_layout_t *layout)  /**< [out] The layout */
+{
+    int i, j;
+    json_object *parts = json_object_path_get_array(main_obj, "problem/parts");
+
+    layout->segs = 0;
+    layout->nsegs = 0;
+    layout->nbytes = 0;
+    for (i = 0; i < json_object_array_length(parts); i++)
+    {
+        json_object *part_obj = json_object_array_get_idx(parts, i);
+        int first = layout->nsegs;
+        MACSIO_UTILS_ForEachExtarr(part_obj, collect_extarr, layout);
+        for (j = first; j < layout->nsegs; j++)
+            layout->segs[j].partid = JsonGetInt(part_obj, "Mesh/ChunkID");
+    }
+    layout->nbytes = align_up(layout->nbytes);
+}
+
+/*! \brief Free the memory of a layout */
+static void free_layout(raw_layout_t *layout)
+{
+    int i;
+    for (i = 0; i < layout->nsegs; i++)
+        free(layout->segs[i].path);
+    free(layout->segs);
+}
+
+/*! \brief pwritev all of \c iov, retrying short and interrupted writes */
+static void pwritev_all(int fd, struct iovec *iov, int niov, off_t off, char const *fileName)
+{
+    while (niov > 0)
+    {
+        ssize_t n = pwritev(fd, iov, niov < IOV_MAX ? niov : IOV_MAX, off);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            MACSIO_LOG_MSG(Die, ("pwritev to \"%s\" failed: %s", fileName, strerror(errno)));
+        off += n;
+        while (niov > 0 && (size_t) n >= iov->iov_len)
+        {
+            n -= (ssize_t) iov->iov_len;
+            iov++;
+            niov--;
+        }
+        if (niov > 0)
+        {
+            iov->iov_base = (char *) iov->iov_base + n;
+            iov->iov_len -= (size_t) n;
+        }
+    }
+}
+
+/*!
+\brief Write a task's extarrs to its range of a file
+
+Without \c --direct, the extarrs and the zero padding between them are written
+in place with \c pwritev. With \c --direct, they are first copied into one buffer
+aligned to \c align and written with one \c pwrite.
+*/
+static void write_layout(
+    int fd,                      /**< [in] Descriptor of the file */
+    char const *fileName,        /**< [in] Name of the file */
+    raw_layout_t const *layout,  /**< [in] The task's extarrs */
+    off_t base,                  /**< [in] Offset of the task's range in the file */
+    int dumpn)                   /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_GroupMask_t main_dump_grp = MACSIO_TIMING_GroupMask("main_dump");
+    MACSIO_TIMING_TimerId_t tid;
+    static char const zeros[4096] = {0};
+    int i;
+
+    if (layout->nbytes == 0)
+        return;
+
+    if (preallocate)
+    {
+        int err;
+        tid = MT_StartTimer("fallocate", main_dump_grp, dumpn);
+        err = posix_fallocate(fd, base, layout->nbytes);
+        if (err)
+            MACSIO_LOG_MSG(Warn, ("posix_fallocate of \"%s\" failed: %s", fileName, strerror(err)));
+        MT_StopTimer(tid);
+    }
+
+    if (use_direct)
+    {
+        char *buf;
+        if (posix_memalign((void **) &buf, (size_t) align, (size_t) layout->nbytes))
+            MACSIO_LOG_MSG(Die, ("Unable to allocate %lld aligned bytes", (long long) layout->nbytes));
+        tid = MT_StartTimer("stage", main_dump_grp, dumpn);
+        memset(buf, 0, (size_t) layout->nbytes);
+        for (i = 0; i < layout->nsegs; i++)
+            memcpy(buf + layout->segs[i].off, layout->segs[i].data, layout->segs[i].len);
+        MT_StopTimer(tid);
+        tid = MT_StartTimer("pwrite", main_dump_grp, dumpn);
+        if (MACSIO_UTILS_PwriteAll(fd, buf, (size_t) layout->nbytes, base) != 0)
+            MACSIO_LOG_MSG(Die, ("pwrite to \"%s\" failed: %s", fileName, strerror(errno)));
+        MT_StopTimer(tid);
+        free(buf);
+    }
+    else
+    {
+        struct iovec *iov;
+        int pass, niov = 0;
+
+        /* First pass counts the iovecs, second fills them in */
+        for (pass = 0; pass < 2; pass++)
+        {
+            off_t pos = 0;
+            if (pass)
+                iov = (struct iovec *) malloc(niov * sizeof(struct iovec));
+            niov = 0;
+            for (i = 0; i <= layout->nsegs; i++)
+            {
+                off_t next = i < layout->nsegs ? layout->segs[i].off : layout->nbytes;
+
+                /* Padding up to the next extarr (or the end of the range) comes from zeros */
+                while (pos < next)
+                {
+                    size_t n = next - pos < (off_t) sizeof(zeros) ? (size_t) (next - pos) : sizeof(zeros);
+                    if (pass)
+                    {
+                        iov[niov].iov_base = (void *) zeros;
+                        iov[niov].iov_len = n;
+                    }
+                    niov++;
+                    pos += n;
+                }
+                if (i < layout->nsegs && layout->segs[i].len)
+                {
+                    if (pass)
+                    {
+                        iov[niov].iov_base = (void *) layout->segs[i].data;
+                        iov[niov].iov_len = layout->segs[i].len;
+                    }
+                    niov++;
+                    pos += layout->segs[i].len;
+                }
+            }
+        }
+
+        tid = MT_StartTimer("pwrite", main_dump_grp, dumpn);
+        pwritev_all(fd, iov, niov, base, fileName);
+        MT_StopTimer(tid);
+        free(iov);
+    }
+
+    if (fsync_mode == FSYNC_WRITE)
+    {
+        tid = MT_StartTimer("fsync", main_dump_grp, dumpn);
+        if (fdatasync(fd) != 0)
+            MACSIO_LOG_MSG(Warn, ("fdatasync of \"%s\" failed: %s", fileName, strerror(errno)));
+        MT_StopTimer(tid);
+    }
+}
+
+/*!
+\brief Write the index file
+
+The index holds one JSON object per line for each extarr written in the dump,
+giving the part it belongs to, its path in the part, its type and dimensions and
+the file, offset and length of its bytes. Each task formats its own lines and
+writes them with \c pwrite at an offset given by an \c MPI_Exscan of their lengths.
+*/
+static void write_index_file(
+    char const *indexName,      /**< [in] Name of the index file */
+    raw_layout_t const *layout, /**< [in] This task's extarrs */
+    char const *fileName,       /**< [in] File this task's extarrs are in */
+    off_t base,                 /**< [in] Offset of this task's range in that file */
+    int dumpn)                  /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_TimerId_t tid = MT_StartTimer("write index", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+    size_t cap = 256 * (layout->nsegs + 1), len = 0;
+    char *buf = (char *) malloc(cap);
+    long long mine, before = 0;
+    int i, j, fd;
+
+    buf[0] = '\0';
+    for (i = 0; i < layout->nsegs; i++)
+    {
+        raw_seg_t const *seg = &layout->segs[i];
+        int ndims = json_object_extarr_ndims(seg->extarr);
+
+        if (cap - len < 512 + strlen(seg->path) + strlen(fileName))
+        {
+            cap = 2 * cap + 512 + strlen(seg->path) + strlen(fileName);
+            buf = (char *) realloc(buf, cap);
+        }
+        len += sprintf(buf + len, "{\"partid\":%d,\"path\":\"%s\",\"type\":%d,\"dims\":[",
+            seg->partid, seg->path, (int) json_object_extarr_type(seg->extarr));
+        for (j = 0; j < ndims; j++)
+            len += sprintf(buf + len, "%s%d", j ? "," : "", json_object_extarr_dim(seg->extarr, j));
+        len += sprintf(buf + len, "],\"file\":\"%s\",\"offset\":%lld,\"length\":%lld}\n",
+            fileName, (long long) (base + seg->off), (long long) seg->len);
+    }
+
+    mine = (long long) len;
+#ifdef HAVE_MPI
+    if (MACSIO_MAIN_Rank == 0)
+#endif
+    {
+        fd = open(indexName, O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+        if (fd < 0)
+            MACSIO_LOG_MSG(Die, ("Unable to create index file \"%s\": %s", indexName, strerror(errno)));
+        close(fd);
+    }
+#ifdef HAVE_MPI
+    before = MACSIO_UTILS_ExscanOffset(mine, MACSIO_MAIN_Comm);
+    MPI_Barrier(MACSIO_MAIN_Comm);
+#endif
+
+    if (len)
+    {
+        fd = open(indexName, O_WRONLY);
+        if (fd < 0)
+            MACSIO_LOG_MSG(Die, ("Unable to open index file \"%s\": %s", indexName, strerror(errno)));
+        if (MACSIO_UTILS_PwriteAll(fd, buf, len, (off_t) before) != 0)
+            MACSIO_LOG_MSG(Die, ("pwrite to \"%s\" failed: %s", indexName, strerror(errno)));
+        close(fd);
+    }
+
+    free(buf);
+    MT_StopTimer(tid);
+}
+
+/*!
+\brief Main dump implementation for this plugin
+
+Lays out this task's extarrs, writes them to a MIF or SIF file and then writes
+their locations to the index file.
+*/
+static void main_dump(
+    int argi,               /**< [in] Command-line argument index at which first plugin-specific arg appears */
+    int argc,               /**< [in] argc from main */
+    char **argv,            /**< [in] argv from main */
+    json_object *main_obj,  /**< [in] The main json object representing all data to be dumped */
+    int dumpn,              /**< [in] The number/index of this dump */
+    double dumpt            /**< [in] The time to be associated with this dump (like a simulation's time) */
+)
+{
+    int rank, size, numFiles, use_sif = 0;
+    char fileName[256], indexName[256];
+    raw_layout_t layout;
+    off_t base;
+
+    /* process cl args */
+    process_args(argi, argc, argv);
+    dump_num = dumpn;
+
+    rank = JsonGetInt(main_obj, "parallel/mpi_rank");
+    size = JsonGetInt(main_obj, "parallel/mpi_size");
+
+    /* determine the file mode and, for MIF, the file count */
+    json_object *parfmode_obj = JsonGetObj(main_obj, "clargs/parallel_file_mode");
+    if (parfmode_obj)
+    {
+        json_object *modestr = json_object_array_get_idx(parfmode_obj, 0);
+        json_object *filecnt = json_object_array_get_idx(parfmode_obj, 1);
+        if (modestr && !strcmp(json_object_get_string(modestr), "SIF"))
+            use_sif = 1;
+        numFiles = filecnt ? json_object_get_int(filecnt) : size;
+    }
+    else
+    {
+        char const * modestr = JsonGetStr(main_obj, "clargs/parallel_file_mode");
+        if (!strcmp(modestr, "SIF"))
+            use_sif = 1;
+        numFiles = size;
+    }
+
+    make_layout(main_obj, &layout);
+
+    if (use_sif)
+    {
+        MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE, 0};
+        int *fd = 0;
+
+        sprintf(fileName, "%s_raw_%03d.%s",
+            JsonGetStr(main_obj, "clargs/filebase"), dumpn, iface_ext);
+        MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
+
+        base = 0;
+#ifdef HAVE_MPI
+        base = (off_t) MACSIO_UTILS_ExscanOffset((long long) layout.nbytes, MACSIO_MAIN_Comm);
+#endif
+
+        /* Rank 0 creates (truncates) the file before anyone else opens it */
+        if (rank == 0)
+            fd = (int *) CreateRawFile(fileName, 0, 0);
+#ifdef HAVE_MPI
+        MPI_Barrier(MACSIO_MAIN_Comm);
+#endif
+        if (rank != 0)
+            fd = (int *) OpenRawFile(fileName, 0, ioFlags, 0);
+        write_layout(*fd, fileName, &layout, base, dumpn);
+        CloseRawFile(fd, 0);
+    }
+    else
+    {
+        MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE,(unsigned int) JsonGetInt(main_obj,"clargs/exercise_scr")&0x1};
+        MACSIO_MIF_baton_t *bat;
+        struct stat st;
+        int *fd;
+
+        if (numFiles < 1 || numFiles > size)
+        {
+            MACSIO_LOG_MSG(Warn, ("Using %d files instead of %d", size, numFiles));
+            numFiles = size;
+        }
+
+        bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 7,
+            CreateRawFile, OpenRawFile, CloseRawFile, 0);
+
+        MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+            (unsigned long long) layout.nbytes);
+
+        sprintf(fileName, "%s_raw_%05d_%03d.%s",
+            JsonGetStr(main_obj, "clargs/filebase"),
+            MACSIO_MIF_RankOfGroup(bat, rank), dumpn, iface_ext);
+        MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
+
+        fd = (int *) MACSIO_MIF_WaitForBaton(bat, fileName, 0);
+
+        /* Every task's range is a multiple of align, so the end of the file is aligned */
+        if (fstat(*fd, &st) != 0)
+            MACSIO_LOG_MSG(Die, ("Unable to stat \"%s\": %s", fileName, strerror(errno)));
+        base = align_up(st.st_size);
+        write_layout(*fd, fileName, &layout, base, dumpn);
+
+        MACSIO_MIF_HandOffBaton(bat, fd);
+        MACSIO_MIF_Finish(bat);
+    }
+
+    sprintf(indexName, "%s_raw_index_%03d.json", JsonGetStr(main_obj, "clargs/filebase"), dumpn);
+    MACSIO_UTILS_RecordOutputFiles(dumpn, indexName);
+    write_index_file(indexName, &layout, fileName, base, dumpn);
+
+    free_layout(&layout);
+}
+
+/*!
+\brief Method to register this plugin with MACSio main
+
+Due to its use to initialize a file-scope, static const variable, this
+function winds up being called at load time (e.g. before main is even called).
+
+Its purpose is to add key information about this plugin to MACSio's global
+interface table.
+*/
+static int register_this_interface()
+{
+    MACSIO_IFACE_Handle_t iface;
+
+    if (strlen(iface_name) >= MACSIO_IFACE_MAX_NAME)
+        MACSIO_LOG_MSG(Die, ("Interface name \"%s\" too long", iface_name));
+
+    /* Populate information about this plugin */
+    strcpy(iface.name, iface_name);
+    strcpy(iface.ext, iface_ext);
+    iface.dumpFunc = main_dump;
+    iface.processArgsFunc = process_args;
+
+    /* Register this plugin */
+    if (!MACSIO_IFACE_Register(&iface))
+        MACSIO_LOG_MSG(Die, ("Failed to register interface \"%s\"", iface_name));
+
+    return 0;
+}
+
+/*!
+\brief Dummy initializer to trigger register_this_interface by the loader
+
+This one statement is the only statement requiring compilation by
+a C++ compiler. That is because it involves initialization and non
+constant expressions (a function call in this case). This function
+call is guaranteed to occur during *initialization* (that is before
+even 'main' is called) and so will have the effect of populating the
+iface_map array merely by virtue of the fact that this code is linked
+with a main.
+*/
+static int const dummy = register_this_interface();
+
+/*!@}*/
+
+/*!@}*/
@@ -28,6 +28,7 @@ Place, Suite 330, Boston, MA 02111-1307 USA
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #ifdef _WIN32
   #ifndef WINDOWS_LEAN_AND_MEAN
     #define WINDOWS_LEAN_AND_MEAN
@@ -43,6 +44,7 @@ Place, Suite 330, Boston, MA 02111-1307 USA
 #include <macsio_log.h>
 #include <macsio_main.h>
 #include <macsio_mif.h>
+#include <macsio_timing.h>
 #include <macsio_utils.h>
 
 #include <silo.h>
@@ -267,6 +269,7 @@ static const char *filename;
 static int has_mesh = 0;
 static int driver = DB_HDF5;
 static int show_all_errors = FALSE;
+static int explicit_names = 0;
 //#warning MOVE LOG HANDLE TO IO CONTEXT
 
 static int process_args(int argi, int argc, char *argv[])
@@ -297,6 +300,10 @@ static int process_args(int argi, int argc, char *argv[])
         "--show-all-errors", "",
             "Show all errors Silo encounters",
             &show_all_errors,
+        "--explicit_names", "",
+            "Write multi-block objects with an explicit list of block names\n"
+            "instead of nameschemes (larger root file, written more slowly)",
+            &explicit_names,
     MACSIO_CLARGS_END_OF_ARGS);
 
     if (driver_str)
@@ -533,6 +540,64 @@ static void write_mesh_part(DBfile *dbfile, json_object *part)
         write_ucdzoo_mesh_part(dbfile, part, "arbitrary");
 }
 
+/*!
+\brief Write the multi-block objects with nameschemes
+
+Instead of a name for every block, the multimesh and multivars carry a
+namescheme for the block's directory and object and, when there is more than
+one file, one for the file holding it. Blocks don't map to files by a simple
+expression in general, since tasks can own varying numbers of parts, so the
+file namescheme indexes a small integer array, \c block_groups, of the group
+(file) number of each block that is written once to the root file.
+*/
+static void WriteMultiXXXObjectsNS(json_object *main_obj, DBfile *siloFile, int dumpn,
+    MACSIO_MIF_baton_t *bat, int mblockType, int vblockType)
+{
+    int i, j, numGroups = 1;
+    int numChunks = JsonGetInt(main_obj, "problem/global/TotalParts");
+    int *blockGroups = (int *) malloc(numChunks * sizeof(int));
+    char file_ns[512], block_ns[512];
+    DBoptlist *optlist = DBMakeOptlist(3);
+
+    for (i = 0; i < numChunks; i++)
+    {
+        int rank_owning_chunk = MACSIO_DATA_GetRankOwningPart(main_obj, i);
+        blockGroups[i] = MACSIO_MIF_RankOfGroup(bat, rank_owning_chunk);
+        if (blockGroups[i] + 1 > numGroups)
+            numGroups = blockGroups[i] + 1;
+    }
+
+    /* With a single file every block is in the root file and needs no file namescheme */
+    if (numGroups > 1)
+    {
+        DBWrite(siloFile, "block_groups", blockGroups, &numChunks, 1, DB_INT);
+        snprintf(file_ns, sizeof(file_ns), "|%s_silo_%%05d_%03d.%s|#block_groups[n]",
+            JsonGetStr(main_obj, "clargs/filebase"), dumpn,
+            JsonGetStr(main_obj, "clargs/fileext"));
+        DBAddOption(optlist, DBOPT_MB_FILE_NS, file_ns);
+    }
+    free(blockGroups);
+
+    snprintf(block_ns, sizeof(block_ns), "|/domain_%%07d/mesh|n");
+    DBAddOption(optlist, DBOPT_MB_BLOCK_NS, block_ns);
+    DBAddOption(optlist, DBOPT_MB_BLOCK_TYPE, &mblockType);
+    DBPutMultimesh(siloFile, "multi_mesh", numChunks, 0, 0, optlist);
+
+    json_object *first_part = JsonGetObj(main_obj, "problem/parts", 0);
+    json_object *vars_array = JsonGetObj(first_part, "Vars");
+    int numVars = json_object_array_length(vars_array);
+    DBClearOption(optlist, DBOPT_MB_BLOCK_TYPE);
+    DBAddOption(optlist, DBOPT_MB_BLOCK_TYPE, &vblockType);
+    for (j = 0; j < numVars; j++)
+    {
+        snprintf(block_ns, sizeof(block_ns), "|/domain_%%07d/%s|n",
+            JsonGetStr(vars_array, "", j, "name"));
+        DBPutMultivar(siloFile, JsonGetStr(vars_array, "", j, "name"), numChunks, 0, 0, optlist);
+    }
+
+    DBFreeOptlist(optlist);
+}
+
 static void WriteMultiXXXObjects(json_object *main_obj, DBfile *siloFile, int dumpn, MACSIO_MIF_baton_t *bat)
 {
     int i, j;
@@ -567,6 +632,14 @@ static void WriteMultiXXXObjects(json_object *main_obj, DBfile *siloFile, int du
     /* Go to root directory in the silo file */
     DBSetDir(siloFile, "/");
 
+    if (!explicit_names)
+    {
+        WriteMultiXXXObjectsNS(main_obj, siloFile, dumpn, bat, mblockType, vblockType);
+        free(blockNames);
+        free(blockTypes);
+        return;
+    }
+
     /* Construct the lists of individual object names */
     for (i = 0; i < numChunks; i++)
     {
@@ -761,6 +834,9 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
     bat = MACSIO_MIF_Init(numGroups, ioFlags, MACSIO_MAIN_Comm, 1,
         CreateSiloFile, OpenSiloFile, CloseSiloFile, &driver);
 
+    MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+        (unsigned long long) json_object_object_nbytes(JsonGetObj(main_obj, "problem"), JSON_C_FALSE));
+
     /* Construct name for the silo file */
 //#warning CHANGE NAMING SCHEME SO LS WORKS BETTER
     sprintf(fileName, "%s_silo_%05d_%03d.%s",
@@ -799,7 +875,10 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
     /* If this is the 'root' processor, also write Silo's multi-XXX objects */
     if (rank == 0)
     {
+        MACSIO_TIMING_GroupMask_t main_dump_grp = MACSIO_TIMING_GroupMask("main_dump");
+        MACSIO_TIMING_TimerId_t tid = MT_StartTimer("multi-block objects", main_dump_grp, dumpn);
         WriteMultiXXXObjects(main_obj, siloFile, dumpn, bat);
+        MT_StopTimer(tid);
 
 //#warning DECOMP MESH SHOULDN'T BE INCLUDED IN PERFORMANCE NUMBERS
         /* output a top-level quadmesh and vars to indicate processor decomp */
@@ -816,6 +895,15 @@ static void main_dump(int argi, int argc, char **argv, json_object *main_obj, in
 
     /* We're done using MACSIO_MIF, so finish it off */
     MACSIO_MIF_Finish(bat);
+
+    if (rank == 0)
+    {
+        struct stat st;
+        if (!stat(fileName, &st))
+            MACSIO_LOG_MSG(Dbg1, ("Root file \"%s\" is %lld bytes with %s for %d blocks",
+                fileName, (long long) st.st_size, explicit_names ? "explicit names" : "nameschemes",
+                JsonGetInt(main_obj, "problem/global/TotalParts")));
+    }
 }
 
 //#warning TO BE MOVED TO SILO LIBRARY
@@ -866,165 +954,451 @@ DBGetFilename(DBfile const *f)
     return f->pub.name;
 }
 
-//#warning SHOULD USE MACSIO_MIF FOR READ TOO BUT INTERFACE IS LACKING
-static
-void main_load(int argi, int argc, char **argv, char const *path, json_object *main_obj, json_object **data_read_obj)
+/*!
+\brief Fully qualified name, \c file:/dir/obj, of a block of a multimesh
+
+A block name without a file part lives in the root file. A relative file name
+is relative to the directory holding the root file. Returns 0 for an empty block.
+*/
+static char *
+multimesh_block_name(
+    char const *rootFileName, /**< name of the file holding the multimesh */
+    DBmultimesh const *mm,    /**< the multimesh */
+    DBnamescheme *file_ns,    /**< namescheme for the files of the blocks, if any */
+    DBnamescheme *block_ns,   /**< namescheme for the blocks, if any */
+    int i                     /**< index of the block */
+)
 {
+    char *name, *fileName, *objName, *qname;
+    char const *slash;
+    int k, rootDirLen = 0;
+
+    for (k = 0; k < mm->empty_cnt; k++)
+        if (mm->empty_list[k] == i) return 0;
+
+    /* DBGetName returns a pointer into a small circular buffer so copy right away */
+    if (block_ns)
+    {
+        char const *bname = DBGetName(block_ns, i);
+        if (file_ns)
+        {
+            char const *fname = DBGetName(file_ns, i);
+            name = (char *) malloc(strlen(fname) + strlen(bname) + 2);
+            sprintf(name, "%s:%s", fname, bname);
+        }
+        else
+        {
+            name = strdup(bname);
+        }
+    }
+    else
+    {
+        if (!strcmp(mm->meshnames[i], "EMPTY"))
+            return 0;
+        name = strdup(mm->meshnames[i]);
+    }
+
+    objName = strchr(name, ':');
+    if (objName)
+    {
+        *objName++ = '\0';
+        fileName = name;
+    }
+    else
+    {
+        objName = name;
+        fileName = 0;
+    }
+
+    if ((slash = strrchr(rootFileName, '/')) && fileName && fileName[0] != '/')
+        rootDirLen = (int) (slash - rootFileName) + 1;
+
+    qname = (char *) malloc(strlen(rootFileName) + strlen(name) + strlen(objName) + 3);
+    sprintf(qname, "%.*s%s:%s%s", rootDirLen, rootFileName,
+        fileName ? fileName : rootFileName, objName[0] == '/' ? "" : "/", objName);
+    free(name);
+
+    return qname;
+}
+
+/*! \brief Entry of the list of blocks sorted by the file holding them */
+typedef struct _block_name_t
+{
+    int id;     /**< index of the block in the multimesh */
+    char *name; /**< fully qualified name of the block */
+} block_name_t;
+
+static int
+compare_block_files(void const *a, void const *b)
+{
+    block_name_t const *ba = (block_name_t const *) a;
+    block_name_t const *bb = (block_name_t const *) b;
+    size_t la = strchr(ba->name, ':') - ba->name;
+    size_t lb = strchr(bb->name, ':') - bb->name;
+    int c = strncmp(ba->name, bb->name, la < lb ? la : lb);
+
+    if (c) return c;
+    if (la != lb) return la < lb ? -1 : 1;
+    return ba->id - bb->id;
+}
+
+/*! \brief Copy the values of a Silo variable into a new json extarr */
+static json_object *
+silo_vals_to_extarr(
+    void const *vals, /**< the variable's values */
+    int datatype,     /**< Silo type of the values */
+    int ndims,        /**< number of dimensions */
+    int const *dims   /**< size in each dimension */
+)
+{
+    enum json_extarr_type etype;
+    size_t esize, nvals = 1;
+    json_object *data_obj;
+    int d;
+
+    switch (datatype)
+    {
+        case DB_DOUBLE:    etype = json_extarr_type_flt64; esize = sizeof(double); break;
+        case DB_FLOAT:     etype = json_extarr_type_flt32; esize = sizeof(float); break;
+        case DB_INT:       etype = json_extarr_type_int32; esize = sizeof(int); break;
+        case DB_LONG_LONG: etype = json_extarr_type_int64; esize = sizeof(long long); break;
+        case DB_CHAR:      etype = json_extarr_type_byt08; esize = sizeof(char); break;
+        default: return 0;
+    }
+
+    for (d = 0; d < ndims; d++)
+        nvals *= dims[d];
+    data_obj = json_object_new_extarr_alloc(etype, ndims, dims, 0);
+    memcpy((void *) json_object_extarr_data(data_obj), vals, nvals * esize);
+
+    return data_obj;
+}
+
+/*! \brief Read one variable from the current directory of a Silo file into a json var object */
+static json_object *
+read_silo_var(
+    DBfile *partFile,  /**< file, set to the block's directory */
+    char const *vname  /**< name of the variable */
+)
+{
+    json_object *data_obj = 0, *var_obj;
+
+    switch (DBInqVarType(partFile, vname))
+    {
+        case DB_QUADVAR:
+        {
+            DBquadvar *qv = DBGetQuadvar(partFile, vname);
+            if (qv)
+                data_obj = silo_vals_to_extarr(qv->vals[0], qv->datatype, qv->ndims, qv->dims);
+            DBFreeQuadvar(qv);
+            break;
+        }
+        case DB_UCDVAR:
+        {
+            DBucdvar *uv = DBGetUcdvar(partFile, vname);
+            if (uv)
+                data_obj = silo_vals_to_extarr(uv->vals[0], uv->datatype, 1, &uv->nels);
+            DBFreeUcdvar(uv);
+            break;
+        }
+        case DB_POINTVAR:
+        {
+            DBmeshvar *pv = DBGetPointvar(partFile, vname);
+            if (pv)
+                data_obj = silo_vals_to_extarr(pv->vals[0], pv->datatype, 1, &pv->nels);
+            DBFreeMeshvar(pv);
+            break;
+        }
+        default: break;
+    }
+
+    if (!data_obj)
+        return 0;
+
+    var_obj = json_object_new_object();
+    json_object_object_add(var_obj, "name", json_object_new_string(vname));
+    json_object_object_add(var_obj, "data", data_obj);
+    return var_obj;
+}
+
+/*!
+\brief Read the blocks of a multimesh on any number of tasks
+
+Task 0 expands the multimesh's block names, from its explicit list or its
+nameschemes, and sorts them by file. Each task gets a contiguous, balanced run
+of the sorted list so that it opens each file holding its blocks only once and
+the blocks of a file are spread over as few tasks as possible. The number of
+reading tasks need not match the number of tasks or files that wrote the data.
+*/
+static void
+main_load(
+    int argi,                   /**< arg index at which to start processing \c argv */
+    int argc,                   /**< \c argc from main */
+    char **argv,                /**< \c argv from main */
+    char const *path,           /**< name of the root file */
+    json_object *main_obj,      /**< main json data object */
+    json_object **data_read_obj /**< [out] the data read, shaped like main_obj's "problem" */
+)
+{
+    static int loadn = 0;
+    static json_object *last_read_obj = 0;
+    MACSIO_TIMING_GroupMask_t main_load_grp = MACSIO_TIMING_GroupMask("main_load");
+    MACSIO_TIMING_TimerId_t tid;
+    double timer_dt;
     int my_rank = JsonGetInt(main_obj, "parallel/mpi_rank");
-    int mpi_size = JsonGetInt(main_obj, "parallel/mpi_rank");
-    int i, num_parts, my_part_cnt, use_ns = 0, maxlen = 0, bcast_data[3];
-    char *all_meshnames, *my_meshnames;
-    char *var_names_list = strdup(JsonGetStr(main_obj, "clargs/read_vars"));
-    char *var_names_list_orig = var_names_list;
-    char *vname;
-    int *my_part_ids, *all_part_cnts;
+    int mpi_size = JsonGetInt(main_obj, "parallel/mpi_size");
+    int i, num_parts = 0, my_part_cnt, maxlen = 0, bcast_data[2];
+    char const *read_vars = JsonGetStr(main_obj, "clargs/read_vars");
+    char const *mesh_name = JsonGetStr(main_obj, "clargs/read_mesh");
+    char *all_meshnames = 0, *my_meshnames;
+    int *all_part_ids = 0, *my_part_ids, *all_part_cnts;
     DBfile *partFile = 0;
     int silo_driver = DB_UNKNOWN;
+    json_object *parts_out, *problem;
+
+    process_args(argi, argc, argv);
+
+    if (last_read_obj)
+        json_object_put(last_read_obj);
 
-    /* Open the root file */
+    if (!mesh_name || !strcmp(mesh_name, "null"))
+        mesh_name = "multi_mesh";
+
+    /* Open the root file and expand the multimesh's block names */
     if (my_rank == 0)
     {
-        DBfile *rootFile = DBOpen(path, DB_UNKNOWN, DB_READ);
-        DBmultimesh *mm = DBGetMultimesh(rootFile, JsonGetStr(main_obj, "clargs/read_mesh"));
+        DBfile *rootFile;
+        DBmultimesh *mm;
+        DBnamescheme *file_ns = 0, *block_ns = 0;
+        block_name_t *blocks;
+        int nblocks;
+
+        tid = MT_StartTimer("DBOpen", main_load_grp, loadn);
+        rootFile = DBOpen(path, DB_UNKNOWN, DB_READ);
+        timer_dt = MT_StopTimer(tid);
+        if (!rootFile)
+            MACSIO_LOG_MSG(Die, ("Unable to open Silo root file \"%s\"", path));
+        silo_driver = DBGetDriverType(rootFile);
+
+        tid = MT_StartTimer("multimesh read", main_load_grp, loadn);
+        mm = DBGetMultimesh(rootFile, mesh_name);
+        timer_dt = MT_StopTimer(tid);
+        if (!mm)
+            MACSIO_LOG_MSG(Die, ("Unable to read multimesh \"%s\" from \"%s\"", mesh_name, path));
+
+        /* Nameschemes that reference external arrays ('$' or '#') read them from the root file */
+        if (mm->block_ns)
+        {
+            block_ns = strpbrk(mm->block_ns, "$#") ?
+                DBMakeNamescheme(mm->block_ns, 0, rootFile, 0) : DBMakeNamescheme(mm->block_ns);
+            if (mm->file_ns)
+                file_ns = strpbrk(mm->file_ns, "$#") ?
+                    DBMakeNamescheme(mm->file_ns, 0, rootFile, 0) : DBMakeNamescheme(mm->file_ns);
+            if (!block_ns || (mm->file_ns && !file_ns))
+                MACSIO_LOG_MSG(Die, ("Unable to interpret nameschemes of multimesh \"%s\"", mesh_name));
+        }
+
+        blocks = (block_name_t *) malloc(mm->nblocks * sizeof(block_name_t));
+        for (nblocks = 0, i = 0; i < mm->nblocks; i++)
+        {
+            char *name = multimesh_block_name(path, mm, file_ns, block_ns, i);
+            int len;
+            if (!name) continue;
+            blocks[nblocks].id = i;
+            blocks[nblocks++].name = name;
+            len = (int) strlen(name) + 1;
+            if (len > maxlen) maxlen = len;
+        }
+        num_parts = nblocks;
 
-        /* Examine multimesh for count of mesh pieces and count of files */
-        num_parts = mm->nblocks;
-        use_ns = mm->block_ns ? 1 : 0;
+        if (file_ns) DBFreeNamescheme(file_ns);
+        if (block_ns) DBFreeNamescheme(block_ns);
+        DBFreeMultimesh(mm);
+        DBClose(rootFile);
+
+        /* Group the blocks by file, keeping block order within a file */
+        qsort(blocks, num_parts, sizeof(block_name_t), compare_block_files);
 
-        /* Reformat all the meshname strings to a single, long buffer */
-        if (!use_ns)
+        all_meshnames = (char *) calloc((size_t) num_parts * maxlen, sizeof(char));
+        all_part_ids = (int *) malloc(num_parts * sizeof(int));
+        for (i = 0; i < num_parts; i++)
         {
-            int i;
-            for (i = 0; i < num_parts; i++)
-            {
-                int len = strlen(mm->meshnames[i]);
-                if (len > maxlen) maxlen = len;
-            }
-            maxlen++; /* for nul char */
-            all_meshnames = (char *) calloc(num_parts * maxlen, sizeof(char));
-            for (i = 0; i < num_parts; i++)
-                strcpy(&all_meshnames[i*maxlen], mm->meshnames[i]);
+            strcpy(&all_meshnames[(size_t) i * maxlen], blocks[i].name);
+            all_part_ids[i] = blocks[i].id;
+            free(blocks[i].name);
         }
+        free(blocks);
 
         bcast_data[0] = num_parts;
-        bcast_data[1] = use_ns;
-        bcast_data[2] = maxlen;
-
-        DBClose(rootFile);
+        bcast_data[1] = maxlen;
     }
 #ifdef HAVE_MPI
     MPI_Bcast(bcast_data, NARRVALS(bcast_data), MPI_INT, 0, MACSIO_MAIN_Comm);
+    MPI_Bcast(&silo_driver, 1, MPI_INT, 0, MACSIO_MAIN_Comm);
 #endif
     num_parts = bcast_data[0];
-    use_ns    = bcast_data[1];
-    maxlen    = bcast_data[2];
-
-#if 0
-    MACSIO_DATA_SimpleAssignKPartsToNProcs(num_parts, mpi_size, my_rank, &all_part_cnts,
-        &my_part_cnt, &my_part_ids);
-#endif
+    maxlen    = bcast_data[1];
 
-    my_meshnames = (char *) calloc(my_part_cnt * maxlen, sizeof(char));
+    /* Task r reads blocks [num_parts*r/mpi_size, num_parts*(r+1)/mpi_size) of the sorted list */
+    all_part_cnts = (int *) malloc(mpi_size * sizeof(int));
+    for (i = 0; i < mpi_size; i++)
+        all_part_cnts[i] = (int) ((long long) num_parts * (i + 1) / mpi_size -
+                                  (long long) num_parts * i / mpi_size);
+    my_part_cnt = all_part_cnts[my_rank];
 
-    if (use_ns)
-    {
-    }
 #ifdef HAVE_MPI
-    else
-    { 
-        int *displs = 0;
+    {
+        int *name_cnts = 0, *name_displs = 0, *id_displs = 0;
+
+        my_meshnames = (char *) calloc((size_t) (my_part_cnt ? my_part_cnt : 1) * maxlen, sizeof(char));
+        my_part_ids = (int *) malloc((my_part_cnt ? my_part_cnt : 1) * sizeof(int));
 
         if (my_rank == 0)
         {
-            displs = (int *) malloc(num_parts * sizeof(int));
-            displs[0] = 0;
-            for (i = 1; i < num_parts; i++)
-               displs[i] = displs[i-1] + all_part_cnts[i-1] * maxlen;
+            name_cnts = (int *) malloc(mpi_size * sizeof(int));
+            name_displs = (int *) malloc(mpi_size * sizeof(int));
+            id_displs = (int *) malloc(mpi_size * sizeof(int));
+            for (i = 0; i < mpi_size; i++)
+            {
+                id_displs[i] = (int) ((long long) num_parts * i / mpi_size);
+                name_displs[i] = id_displs[i] * maxlen;
+                name_cnts[i] = all_part_cnts[i] * maxlen;
+            }
         }
 
-        /* MPI_scatter the block names or the external arrays for any namescheme */
-        MPI_Scatterv(all_meshnames, all_part_cnts, displs, MPI_CHAR,
-                 my_meshnames, my_part_cnt, MPI_CHAR, 0, MACSIO_MAIN_Comm);
+        MPI_Scatterv(all_meshnames, name_cnts, name_displs, MPI_CHAR,
+                 my_meshnames, my_part_cnt * maxlen, MPI_CHAR, 0, MACSIO_MAIN_Comm);
+        MPI_Scatterv(all_part_ids, all_part_cnts, id_displs, MPI_INT,
+                 my_part_ids, my_part_cnt, MPI_INT, 0, MACSIO_MAIN_Comm);
 
-        if (my_rank == 0)
-            free(displs);
+        free(name_cnts);
+        free(name_displs);
+        free(id_displs);
     }
+#else
+    my_meshnames = all_meshnames;
+    my_part_ids = all_part_ids;
 #endif
 
     /* Iterate finding correct file/dir combo and reading mesh pieces and variables */
+    parts_out = json_object_new_array();
     for (i = 0; i < my_part_cnt; i++)
     {
         char *partFileName, *partDirName, *partObjName;
-        DBObjectType silo_objtype;
-
-        DBSplitMultiName(&my_meshnames[i*maxlen], &partFileName, &partDirName, &partObjName);
+        json_object *part_obj, *mesh_obj, *vars_out;
+        char **vnames = 0;
+        int v, nvnames = 0;
 
-        /* if filename is different from current, close current */
-        if (partFile && strcmp(DBGetFilename(partFile), partFileName))
-            DBClose(partFile);
+        DBSplitMultiName(&my_meshnames[(size_t) i * maxlen], &partFileName, &partDirName, &partObjName);
 
-        /* Open the file containing this part */
-        partFile = DBOpen(partFileName, silo_driver, DB_READ);
-        silo_driver = DBGetDriverType(partFile);
+        /* Blocks are grouped by file so only open a file when it changes */
+        if (!partFile || strcmp(DBGetFilename(partFile), partFileName))
+        {
+            if (partFile)
+            {
+                tid = MT_StartTimer("DBClose", main_load_grp, loadn);
+                DBClose(partFile);
+                timer_dt = MT_StopTimer(tid);
+            }
+            tid = MT_StartTimer("DBOpen", main_load_grp, loadn);
+            partFile = DBOpen(partFileName, silo_driver, DB_READ);
+            timer_dt = MT_StopTimer(tid);
+            if (!partFile)
+                MACSIO_LOG_MSG(Die, ("Unable to open Silo file \"%s\"", partFileName));
+            silo_driver = DBGetDriverType(partFile);
+        }
 
-        DBSetDir(partFile, partDirName);
+        DBSetDir(partFile, partDirName && *partDirName ? partDirName : "/");
 
         /* Get the mesh part */
-        silo_objtype = (DBObjectType) DBInqMeshtype(partFile, partObjName);
-
-        switch (silo_objtype)
+        tid = MT_StartTimer("mesh read", main_load_grp, loadn);
+        switch (DBInqMeshtype(partFile, partObjName))
         {
             case DB_QUADRECT:
             case DB_QUADCURV:
             case DB_QUADMESH:
             {
-                DBquadmesh *qm = DBGetQuadmesh(partFile, partObjName);
+                DBFreeQuadmesh(DBGetQuadmesh(partFile, partObjName));
                 break;
             }
             case DB_UCDMESH:
             {
+                DBFreeUcdmesh(DBGetUcdmesh(partFile, partObjName));
                 break;
             }
             case DB_POINTMESH:
             {
+                DBFreePointmesh(DBGetPointmesh(partFile, partObjName));
                 break;
             }
             default:
             {
+                MACSIO_LOG_MSG(Warn, ("Unable to read mesh \"%s\" in \"%s\"",
+                    partObjName, partFileName));
             }
         }
+        timer_dt = MT_StopTimer(tid);
 
-        while (vname = strsep(&var_names_list, ", "))
+        /* The variables to read are the block directory's vars that --read_vars selects */
+        tid = MT_StartTimer("var read", main_load_grp, loadn);
         {
-            DBObjectType silo_vartype = DBInqVarType(partFile, vname);
-            switch (silo_vartype)
-            {
-                case DB_QUADVAR:
-                {
-                    DBquadvar *qv = DBGetQuadvar(partFile, vname);
-                    break;
-                }
-                case DB_POINTVAR:
-                {
-                    break;
-                }
-                case DB_UCDVAR:
-                {
-                    break;
-                }
-                default: continue;
-            }
+            DBtoc const *toc = DBGetToc(partFile);
+            int ntoc = toc->nqvar + toc->nucdvar + toc->nptvar;
+            vnames = (char **) malloc((ntoc ? ntoc : 1) * sizeof(char *));
+            for (v = 0; v < toc->nqvar; v++)
+                if (MACSIO_UTILS_VarIsSelected(read_vars, toc->qvar_names[v]))
+                    vnames[nvnames++] = strdup(toc->qvar_names[v]);
+            for (v = 0; v < toc->nucdvar; v++)
+                if (MACSIO_UTILS_VarIsSelected(read_vars, toc->ucdvar_names[v]))
+                    vnames[nvnames++] = strdup(toc->ucdvar_names[v]);
+            for (v = 0; v < toc->nptvar; v++)
+                if (MACSIO_UTILS_VarIsSelected(read_vars, toc->ptvar_names[v]))
+                    vnames[nvnames++] = strdup(toc->ptvar_names[v]);
+        }
+
+        vars_out = json_object_new_array();
+        for (v = 0; v < nvnames; v++)
+        {
+            json_object *var_obj = read_silo_var(partFile, vnames[v]);
+            if (var_obj)
+                json_object_array_add(vars_out, var_obj);
+            free(vnames[v]);
         }
-        free(var_names_list_orig);
+        free(vnames);
+        timer_dt = MT_StopTimer(tid);
 
         /* Add the mesh part to the returned json object */
+        part_obj = json_object_new_object();
+        mesh_obj = json_object_new_object();
+        json_object_object_add(mesh_obj, "ChunkID", json_object_new_int(my_part_ids[i]));
+        json_object_object_add(part_obj, "Mesh", mesh_obj);
+        json_object_object_add(part_obj, "Vars", vars_out);
+        json_object_array_add(parts_out, part_obj);
 
         DBSetDir(partFile, "/");
     }
 
+    if (partFile)
+    {
+        tid = MT_StartTimer("DBClose", main_load_grp, loadn);
+        DBClose(partFile);
+        timer_dt = MT_StopTimer(tid);
+    }
+
+#ifdef HAVE_MPI
     free(my_meshnames);
-    if (my_rank == 0)
-        free(all_meshnames);
+    free(my_part_ids);
+#endif
+    free(all_meshnames);
+    free(all_part_ids);
+    free(all_part_cnts);
+
+    problem = json_object_new_object();
+    json_object_object_add(problem, "parts", parts_out);
+    *data_read_obj = json_object_new_object();
+    json_object_object_add(*data_read_obj, "problem", problem);
+    last_read_obj = *data_read_obj;
+    loadn++;
 }
 
 static int register_this_interface()
@@ -1,5 +1,6 @@
 /* Written by James Dickson */
 
+#include <limits.h>
 #include <math.h>
 #include <time.h>
 #include <unistd.h>
@@ -79,13 +80,39 @@ static int process_args(
 	    "Explicitly set the mpi file hint for striping factor.",
 	    &striping_factor,
         "--no_collective", "",
-            "Use independent, not collective I/O calls in SIF mode.",
+            "Use independent, not collective I/O calls in SIF and MSF modes. Tasks may\n"
+            "hold different numbers of parts in those modes, but every task needs at\n"
+            "least one.",
             &no_collective,
 	MACSIO_CLARGS_END_OF_ARGS);
 
     return 0;
 }
 
+/*!
+\brief Make the MPI_Info for opening shared files
+
+Starts from MACSio's \c --mpi_hints and adds any of this plugin's own hint args.
+
+\return An MPI_Info the caller must free or MPI_INFO_NULL if there are no hints
+*/
+static MPI_Info make_mpi_info(
+    json_object *main_obj) /**< [in] The main JSON object */
+{
+    MPI_Info mpiInfo = MACSIO_UTILS_MPIInfoFromHints(JsonGetStr(main_obj, "clargs/mpi_hints"));
+
+    if ((romio_cb_write || romio_ds_write || striping_factor) && mpiInfo == MPI_INFO_NULL)
+	MPI_Info_create(&mpiInfo);
+    if (romio_cb_write)
+	MPI_Info_set(mpiInfo, "romio_cb_write", (char *) romio_cb_write);
+    if (romio_ds_write)
+	MPI_Info_set(mpiInfo, "romio_ds_write", (char *) romio_ds_write);
+    if (striping_factor)
+	MPI_Info_set(mpiInfo, "striping_factor", (char *) striping_factor);
+
+    return mpiInfo;
+}
+
 /*!
 \brief Return the current date as a formatted string
 
@@ -537,6 +564,9 @@ static void main_dump_mif(
     MACSIO_MIF_baton_t *bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 1,
                               CreateTyphonIOFile, OpenTyphonIOFile, CloseTyphonIOFile, &userData);
 
+    MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+        (unsigned long long) json_object_object_nbytes(JsonGetObj(main_obj, "problem"), JSON_C_FALSE));
+
     rank = json_object_path_get_int(main_obj, "parallel/mpi_rank");
     size = json_object_path_get_int(main_obj, "parallel/mpi_size");
 
@@ -582,511 +612,386 @@ static void main_dump_mif(
     MACSIO_MIF_Finish(bat);
 }
 
+/*!
+\brief Where a task's parts land among the chunks of a shared file
+
+Every part becomes one TyphonIO chunk. A task's chunks are numbered consecutively
+from \c first_chunk, which is an exclusive scan of the part counts over the tasks
+sharing the file. MACSio hands out parts in ChunkID order and all parts have the
+same logical dimensions, so the extents of any chunk in the file follow from its
+ChunkID and the global part layout without exchanging them. Every task needs at
+least one part, because the mesh shape and the quantities to create are taken
+from a task's first part.
+*/
+typedef struct _chunk_layout {
+    int nparts;        /**< Number of parts on this task */
+    int first_chunk;   /**< File chunk index of this task's first part */
+    int nchunks;       /**< Total number of chunks in the file */
+    int base_id;       /**< Global ChunkID of the file's chunk 0 */
+    int min_parts;     /**< Fewest parts on any task sharing the file */
+    int part_dims[3];  /**< Nodal logical dimensions of every part */
+    int parts_dims[3]; /**< Number of parts in each dimension of the global mesh */
+} chunk_layout_t;
+
+/*!
+\brief Compute this task's chunk layout in a file shared over \c comm
+*/
+static void get_chunk_layout(
+    MPI_Comm comm,          /**< [in] Communicator of the tasks sharing the file */
+    json_object *main_obj,  /**< [in] The main JSON object containing mesh data */
+    chunk_layout_t *cl)     /**< [out] The chunk layout */
+{
+    int i, comm_rank;
+    int ndims = JsonGetInt(main_obj, "clargs/part_dim");
+    json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
+    int vals[3];
+
+    cl->nparts = json_object_array_length(part_array);
+    cl->first_chunk = 0;
+    MPI_Comm_rank(comm, &comm_rank);
+    MPI_Exscan(&cl->nparts, &cl->first_chunk, 1, MPI_INT, MPI_SUM, comm);
+    if (comm_rank == 0)
+        cl->first_chunk = 0;
+
+    /* One reduction yields the chunk count, the file's first ChunkID and the fewest parts */
+    vals[0] = cl->first_chunk + cl->nparts;
+    vals[1] = cl->nparts ? JsonGetInt(json_object_array_get_idx(part_array, 0), "Mesh/ChunkID") -
+                           cl->first_chunk : INT_MIN;
+    vals[2] = -cl->nparts;
+    MPI_Allreduce(MPI_IN_PLACE, vals, 3, MPI_INT, MPI_MAX, comm);
+    cl->nchunks = vals[0];
+    cl->base_id = vals[1];
+    cl->min_parts = -vals[2];
+
+    if (cl->min_parts == 0)
+        MACSIO_LOG_MSG(Die, ("TyphonIO plugin needs at least one part on every task in "
+                             "SIF and MSF modes. Set --avg_num_parts to 1 or more."));
+
+    for (i = 0; i < 3; i++)
+    {
+        cl->part_dims[i] = 1;
+        cl->parts_dims[i] = 1;
+    }
+    for (i = 0; i < ndims; i++)
+    {
+        cl->parts_dims[i] = JsonGetInt(main_obj, "problem/global/PartsLogDims", i);
+        cl->part_dims[i] = JsonGetInt(main_obj, "problem/global/LogDims", i) / cl->parts_dims[i];
+    }
+}
+
+/*!
+\brief Compute the global logical extents [il, ih, jl, jh, kl, kh] of a chunk in the file
+*/
+static void get_chunk_indices(
+    chunk_layout_t const *cl, /**< [in] The chunk layout */
+    int ndims,                /**< [in] Number of mesh dimensions */
+    int chunk,                /**< [in] File chunk index */
+    TIO_Size_t *indices)      /**< [out] The six chunk extents */
+{
+    int i;
+    int id = cl->base_id + chunk;
+    int part_index[3];
+
+    /* Mirrors the i, j, k part loop nesting in MACSIO_DATA_GenerateTimeZeroDumpObject */
+    part_index[2] = id % cl->parts_dims[2];
+    part_index[1] = (id / cl->parts_dims[2]) % cl->parts_dims[1];
+    part_index[0] = id / (cl->parts_dims[2] * cl->parts_dims[1]);
+
+    for (i = 0; i < 6; i++)
+        indices[i] = 0;
+    for (i = 0; i < ndims; i++)
+    {
+        indices[i*2] = (TIO_Size_t) part_index[i] * cl->part_dims[i];
+        indices[i*2+1] = indices[i*2] + cl->part_dims[i] - 1;
+    }
+}
+
+/*!
+\brief Choose the transfer mode for the write of a task's p'th part
+
+Every task has at least \c min_parts parts, so writes of those can be collective.
+Writes of the extra parts that only some tasks have are always independent.
+*/
+static TIO_Xfer_t part_xfer(
+    chunk_layout_t const *cl, /**< [in] The chunk layout */
+    int p)                    /**< [in] Index of the part on this task */
+{
+    if (no_collective || p >= cl->min_parts)
+        return TIO_XFER_INDEPENDENT;
+    return TIO_XFER_COLLECTIVE;
+}
+
+/*!
+\brief Write all quad mesh parts to a shared file
+
+Each task writes the coordinates and variables of its own parts as chunks of the
+file's mesh.
+
+This method is used for both Rectilinear (Colinear) and Curvilinear (Non-Colinear)
+Quad meshes.
+*/
 static void write_quad_mesh_whole(
-    MACSIO_MSF_baton_t const *bat,
+    MPI_Comm comm,          /**< [in] Communicator of the tasks sharing the file */
     TIO_File_t file_id,     /**< [in] The file id being used in SIF dump */
     TIO_Object_t state_id,  /**< [in] The state id of the current dump */
     json_object *main_obj,  /**< [in] The main JSON object containing mesh data */
-    TIO_Mesh_t mesh_type)   /**< [in] Type of mesh [TIO_MESH_QUAD_COLINEAR/TIO_MESH_QUAD_NONCOLINEAR] */    
+    TIO_Mesh_t mesh_type)   /**< [in] Type of mesh [TIO_MESH_QUAD_COLINEAR/TIO_MESH_QUAD_NONCOLINEAR] */
 {
     TIO_Object_t mesh_id;
     TIO_Object_t object_id;
-    int ndims;
-    int i, v, p;
-    int use_part_count;
-    const TIO_Xfer_t TIO_XFER = no_collective ? TIO_XFER_INDEPENDENT : TIO_XFER_COLLECTIVE;
+    int i, v, p, c;
+    chunk_layout_t cl;
+    TIO_Size_t dims[3] = {1, 1, 1};
+    int ndims = JsonGetInt(main_obj, "clargs/part_dim");
+    TIO_Dims_t ndims_tio = (TIO_Dims_t)ndims;
 
-    TIO_Size_t dims[3];
+    get_chunk_layout(comm, main_obj, &cl);
 
-    ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
+    for (i = 0; i < ndims; i++)
+        dims[i] = (TIO_Size_t) JsonGetInt(main_obj, "problem/global/LogDims", i);
 
     /* Get the list of vars on the first part as a guide to loop over vars */
     json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
     json_object *first_part_obj = json_object_array_get_idx(part_array, 0);
     json_object *first_part_vars_array = json_object_path_get_array(first_part_obj, "Vars");
 
-    json_object *part_log_dims_array = json_object_path_get_array(first_part_obj, "Mesh/LogDims");
+    TIO_Call( TIO_Create_Mesh(file_id, state_id, "mesh", &mesh_id, mesh_type,
+                              TIO_COORD_CARTESIAN, TIO_FALSE, "mesh_group", (TIO_Size_t)1,
+                              TIO_DATATYPE_NULL, TIO_DOUBLE, ndims_tio,
+                              dims[0], dims[1], dims[2],
+                              TIO_GHOSTS_NONE, (TIO_Size_t)cl.nchunks,
+                              NULL, NULL, NULL,
+                              NULL, NULL, NULL),
+              "Mesh Create Failed\n");
+
+    /* Chunk metadata is set identically on every task */
+    for (c = 0; c < cl.nchunks; c++)
+    {
+        TIO_Size_t idx[6];
+        get_chunk_indices(&cl, ndims, c, idx);
+        TIO_Call( TIO_Set_Quad_Chunk(file_id, mesh_id, (TIO_Size_t)c, ndims_tio,
+                                     idx[0], idx[1], idx[2], idx[3], idx[4], idx[5],
+                                     (TIO_Size_t)0, (TIO_Size_t)0),
+                  "Set Quad Mesh Chunk Failed\n");
+    }
 
-    for (i = 0; i < ndims; i++)
-    {      
-        dims[i] = (TIO_Size_t) JsonGetInt(part_log_dims_array, "", i) * MACSIO_MSF_SizeOfGroup(bat);
+    /* Each task writes the coordinates of its own chunks */
+    for (p = 0; p < cl.nparts; p++)
+    {
+        json_object *coords = JsonGetObj(json_object_array_get_idx(part_array, p), "Mesh/Coords");
+        char const *coordnames[2][3] = {{"XAxisCoords", "YAxisCoords", "ZAxisCoords"},
+                                        {"XCoords", "YCoords", "ZCoords"}};
+        int curv = mesh_type == TIO_MESH_QUAD_COLINEAR ? 0 : 1;
+
+        TIO_Call( TIO_Write_QuadMesh_Chunk(file_id, mesh_id, (TIO_Size_t)(cl.first_chunk + p), part_xfer(&cl, p),
+                                           TIO_DOUBLE,
+                                           json_object_extarr_data(json_object_path_get_extarr(coords, coordnames[curv][0])),
+                                           json_object_extarr_data(json_object_path_get_extarr(coords, coordnames[curv][1])),
+                                           json_object_extarr_data(json_object_path_get_extarr(coords, coordnames[curv][2]))),
+                  "Write Quad Mesh Chunk Failed\n");
     }
 
     /* Loop over vars and then over parts */
-    /* currently assumes all vars exist on all ranks. but not all parts */
-    for (v = -1; v < json_object_array_length(first_part_vars_array); v++) /* -1 start is for Mesh */
+    /* currently assumes all vars exist on all ranks */
+    for (v = 0; v < json_object_array_length(first_part_vars_array); v++)
     {
         /* Inspect the first part's var object for name, datatype, etc. */
         json_object *var_obj = json_object_array_get_idx(first_part_vars_array, v);
+        char const *varName = json_object_path_get_string(var_obj, "name");
+        json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
+        TIO_Data_t dtype_id = json_object_extarr_type(dataobj) == json_extarr_type_flt64 ? TIO_DOUBLE : TIO_INT;
+        TIO_Centre_t tio_centering = strcmp(json_object_path_get_string(var_obj, "centering"), "zone") ?
+                                     TIO_CENTRE_NODE : TIO_CENTRE_CELL;
 
-        char *centering = (char*)malloc(sizeof(char)*5);
-        TIO_Data_t dtype_id;
-
-        //MESH
-        TIO_Dims_t ndims_tio = (TIO_Dims_t)ndims;
-
-        if (v == -1) { 
-            TIO_Call( TIO_Create_Mesh(file_id, state_id, "mesh", &mesh_id, mesh_type,
-                                      TIO_COORD_CARTESIAN, TIO_FALSE, "mesh_group", (TIO_Size_t)1,
-                                      TIO_DATATYPE_NULL, TIO_DOUBLE, ndims_tio,
-                                      dims[0], dims[1], dims[2],
-                                      TIO_GHOSTS_NONE, (TIO_Size_t)MACSIO_MSF_SizeOfGroup(bat),
-                                      NULL, NULL, NULL,
-                                      NULL, NULL, NULL),
-
-                      "Mesh Create Failed\n");
-            //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-        } else{
-            char const *varName = json_object_path_get_string(var_obj, "name");
-            centering = strdup(json_object_path_get_string(var_obj, "centering"));
-            json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
-            dtype_id = json_object_extarr_type(dataobj) == json_extarr_type_flt64 ? TIO_DOUBLE : TIO_INT;
-            TIO_Centre_t tio_centering = strcmp(centering, "zone") ? TIO_CENTRE_NODE : TIO_CENTRE_CELL;
-
-            TIO_Call( TIO_Create_Quant(file_id, mesh_id, varName, &object_id, dtype_id, tio_centering,
-                                        TIO_GHOSTS_NONE, TIO_FALSE, "qunits"),
-                    "Quant Create Failed\n");
-            //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-
-            free(centering);
-        }
+        TIO_Call( TIO_Create_Quant(file_id, mesh_id, varName, &object_id, dtype_id, tio_centering,
+                                   TIO_GHOSTS_NONE, TIO_FALSE, "qunits"),
+                  "Quant Create Failed\n");
 
-        /* Loop to make write calls for this var for each part on this rank */
-        use_part_count = (int) ceil(json_object_path_get_double(main_obj, "clargs/avg_num_parts"));
-        for (p = 0; p < use_part_count; p++)
+        for (p = 0; p < cl.nparts; p++)
         {
-            json_object *part_obj = json_object_array_get_idx(part_array, p);
-            json_object *var_obj = 0;
-
-            void const *buf = 0;
-            void const *x_coord = 0;
-            void const *y_coord = 0;
-            void const *z_coord = 0;
-
-            void *x_coord_root = 0;
-            void *y_coord_root = 0;
-            void *z_coord_root = 0;
-
-            if (part_obj)
-            {
-                if (v == -1) {
-                    //Mesh
-                    json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
-                    json_object *global_log_origin_array = json_object_path_get_array(part_obj, "GlobalLogOrigin");
-                    json_object *global_log_indices_array = json_object_path_get_array(part_obj, "GlobalLogIndices");
-                    json_object *mesh_dims_array = json_object_path_get_array(mesh_obj, "LogDims");
-                    int local_mesh_dims[3];
-                    TIO_Size_t local_chunk_indices[6] = {0,0,0,0,0,0};  /* local_chunk_indices [il, ih, jl, jh, kl, kh] */
-                    
-                    for (i = 0; i < ndims; i++)
-                    {
-                        local_mesh_dims[i] = json_object_get_int(json_object_array_get_idx(mesh_dims_array, i));
-                        int start = json_object_get_int(json_object_array_get_idx(global_log_origin_array, i));
-                        int count = json_object_get_int(json_object_array_get_idx(mesh_dims_array, i)) - 1;
-
-                        local_chunk_indices[i*2] = start;
-                        local_chunk_indices[(i*2)+1] = start + count;
-                    }
-                                    
-                    TIO_Size_t chunk_indices[MACSIO_MSF_SizeOfGroup(bat)][6];
-                    MPI_Allgather(local_chunk_indices, 6, MPI_UNSIGNED_LONG, chunk_indices, 6, MPI_UNSIGNED_LONG, MACSIO_MSF_CommOfGroup(bat));
-
-                    for (int k=0; k<MACSIO_MSF_SizeOfGroup(bat); k++){
-                        TIO_Call( TIO_Set_Quad_Chunk(file_id, mesh_id, k, ndims_tio,
-                                                chunk_indices[k][0], chunk_indices[k][1],
-                                                chunk_indices[k][2], chunk_indices[k][3],
-                                                chunk_indices[k][4], chunk_indices[k][5],
-                                                 (TIO_Size_t)0, (TIO_Size_t)0),
-                             "Set Quad Mesh Chunk Failed\n");
-                        //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-                    }
-
-                    json_object *coords = json_object_path_get_object(mesh_obj, "Coords");
-
-                    int coord_array_size[] = {0, 0, 0};
-                    
-                    if (mesh_type == TIO_MESH_QUAD_COLINEAR){
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XAxisCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YAxisCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZAxisCoords"));  
-                        coord_array_size[0] = dims[0];
-                        coord_array_size[1] = dims[1];
-                        coord_array_size[2] = dims[2];  
-
-                        int parts = json_object_path_get_int(main_obj, "problem/global/TotalParts");;
-
-                        if (MACSIO_MAIN_Rank == MACSIO_MSF_RootOfGroup(bat)){
-                            x_coord_root = malloc(coord_array_size[0] * sizeof(double));
-                            if (ndims > 1) y_coord_root = malloc(coord_array_size[1] * sizeof(double));
-                            if (ndims > 2) z_coord_root = malloc(coord_array_size[2] * sizeof(double));
-                        }
-
-                        json_object *bounds = json_object_path_get_array(mesh_obj, "Bounds");
-                        int bound_array[] = {0,0,0,0,0,0};
-
-                        for (int j=0; j<6; j++){
-                            bound_array[j] = JsonGetInt(bounds,"",j);
-                        }
-
-                        MPI_Gather((void*)x_coord, local_mesh_dims[0], MPI_DOUBLE, x_coord_root, local_mesh_dims[0], MPI_DOUBLE, 0, MACSIO_MSF_CommOfGroup(bat));
-                        if (ndims > 1){
-                            MPI_Gather((void*)y_coord, local_mesh_dims[1], MPI_DOUBLE, y_coord_root, local_mesh_dims[1], MPI_DOUBLE, 0, MACSIO_MSF_CommOfGroup(bat));                  
-                            if (ndims > 2){
-                                MPI_Gather((void*)z_coord, local_mesh_dims[2], MPI_DOUBLE, z_coord_root, local_mesh_dims[2], MPI_DOUBLE, 0, MACSIO_MSF_CommOfGroup(bat));
-                            }
-                        }
-                    } else {
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"));
-                    }
-
-                } else {
-                    //Variable 
-                    json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
-                    json_object *var_obj = json_object_array_get_idx(vars_array, v);
-                    json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
-
-                    buf = json_object_extarr_data(extarr_obj);
-                }
-            }
-
-            if (v == -1) { 
-
-                if (mesh_type == TIO_MESH_QUAD_COLINEAR){
-                    if (MACSIO_MAIN_Rank == MACSIO_MSF_RootOfGroup(bat)){                 
-                        TIO_Call( TIO_Write_QuadMesh_All(file_id, mesh_id, TIO_DOUBLE, x_coord_root, y_coord_root, z_coord_root),
-                            "Write Quad Mesh All Failed\n");
-                        //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-                    }
-                } else {
-                    TIO_Call( TIO_Write_QuadMesh_Chunk(file_id, mesh_id, MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank), TIO_XFER,
-                                                        TIO_DOUBLE, x_coord, y_coord, z_coord),
-                                "Write Non-Colinear Mesh Coords failed\n");
-                    //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-                }
-            } else {                
-                TIO_Call( TIO_Write_QuadQuant_Chunk(file_id, object_id, MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank), 
-                                                TIO_XFER, dtype_id, buf, (void*)TIO_NULL),
-                    "Write Quad Quant Chunk Failed\n");
-                //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-
-                TIO_Call( TIO_Close_Quant(file_id, object_id),
-                    "Close Quant Failed\n");
-                //TIO_Call( TIO_Flush(file_id), "Flush Failed\n");
-            }
+            json_object *vars_array = json_object_path_get_array(json_object_array_get_idx(part_array, p), "Vars");
+            void const *buf = json_object_extarr_data(
+                json_object_path_get_extarr(json_object_array_get_idx(vars_array, v), "data"));
 
-            free(x_coord_root);
-            free(y_coord_root);
-            free(z_coord_root);
+            TIO_Call( TIO_Write_QuadQuant_Chunk(file_id, object_id, (TIO_Size_t)(cl.first_chunk + p),
+                                                part_xfer(&cl, p), dtype_id, buf, (void*)TIO_NULL),
+                      "Write Quad Quant Chunk Failed\n");
         }
+
+        TIO_Call( TIO_Close_Quant(file_id, object_id),
+                  "Close Quant Failed\n");
     }
 
     TIO_Call( TIO_Close_Mesh(file_id, mesh_id),
-          "Close Mesh Failed\n");
-
+              "Close Mesh Failed\n");
 }
 
+/*!
+\brief Write all unstructured mesh parts to a shared file
+
+Each task writes the nodes, cells and variables of its own parts as chunks of the
+file's mesh. Node and cell ids are numbered consecutively through the file's chunks.
+
+This method is used for both Unstructured Zoo and Arbitraty
+Unstructured meshes.
+*/
 static void write_ucd_mesh_whole(
-    MACSIO_MSF_baton_t const *bat,
+    MPI_Comm comm,          /**< [in] Communicator of the tasks sharing the file */
     TIO_File_t file_id,     /**< [in] The file id being used in SIF dump */
     TIO_Object_t state_id,  /**< [in] The state id of the current dump */
     json_object *main_obj,  /**< [in] The main JSON object containing mesh data */
-    char *mesh_type)        /**< [in] Type of mesh [TIO_MESH_QUAD_COLINEAR/TIO_MESH_QUAD_NONCOLINEAR] */ 
+    char const *mesh_type)  /**< [in] Topology of unstructured mesh [ucdzoo/arbitrary] */
 {
     TIO_Object_t mesh_id;
     TIO_Object_t object_id;
-    int i, v, p;
-    int use_part_count;
-    const TIO_Xfer_t TIO_XFER = no_collective ? TIO_XFER_INDEPENDENT : TIO_XFER_COLLECTIVE;
-    TIO_File_t dims[3];
-    int nnodes = 1, nzones = 1;
-    TIO_Size_t nconnectivity = 1;
+    int i, v, p, c;
+    chunk_layout_t cl;
+    int chunk_nodes = 1, chunk_cells = 1;
+    int shapesize = 4;
+    TIO_Shape_t shapetype = (TIO_Shape_t)4; /* Arbitrary polygon with 4 nodes */
+    TIO_Size_t nshapes = 1;
+    int ndims = JsonGetInt(main_obj, "clargs/part_dim");
 
-    int ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
+    get_chunk_layout(comm, main_obj, &cl);
+
+    for (i = 0; i < ndims; i++)
+    {
+        chunk_nodes *= cl.part_dims[i];
+        chunk_cells *= cl.part_dims[i] - 1;
+    }
 
     /* Get the list of vars on the first part as a guide to loop over vars */
     json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
     json_object *first_part_obj = json_object_array_get_idx(part_array, 0);
     json_object *first_part_vars_array = json_object_path_get_array(first_part_obj, "Vars");
 
-    json_object *part_log_dims_array = json_object_path_get_array(first_part_obj, "Mesh/LogDims");
+    if (ndims == 1 || !strcmp(mesh_type, "ucdzoo"))
+    {
+        char const *shape = JsonGetStr(first_part_obj, "Mesh/Topology/ElemType");
 
-    for (i = 0; i < ndims; i++)
-    {      
-        dims[i] = (TIO_Size_t) JsonGetInt(part_log_dims_array, "", i) * MACSIO_MSF_SizeOfGroup(bat);
-        nnodes *= dims[i];
-        nzones *= dims[i] - MACSIO_MSF_SizeOfGroup(bat);
+        if (!strcmp(shape, "Beam2"))
+        {
+            shapesize = 2;
+            shapetype = TIO_SHAPE_BAR2;
+        }
+        else if (!strcmp(shape, "Quad4"))
+        {
+            shapesize = 4;
+            shapetype = TIO_SHAPE_QUAD4;
+        }
+        else if (!strcmp(shape, "Hex8"))
+        {
+            shapesize = 8;
+            shapetype = TIO_SHAPE_HEX8;
+        }
+    }
+
+    TIO_Call( TIO_Create_Mesh(file_id, state_id, "mesh", &mesh_id, TIO_MESH_UNSTRUCT,
+                              TIO_COORD_CARTESIAN, TIO_FALSE, "mesh_group", (TIO_Size_t)1,
+                              TIO_INT, TIO_DOUBLE, (TIO_Dims_t)ndims,
+                              (TIO_Size_t)cl.nchunks * chunk_nodes, (TIO_Size_t)cl.nchunks * chunk_cells,
+                              (TIO_Size_t)cl.nchunks * nshapes,
+                              (TIO_Size_t)cl.nchunks * chunk_cells * shapesize, (TIO_Size_t)cl.nchunks,
+                              NULL, NULL, NULL,
+                              NULL, NULL, NULL),
+              "Mesh Create Failed\n");
+
+    /* Chunk metadata is set identically on every task */
+    for (c = 0; c < cl.nchunks; c++)
+    {
+        TIO_Call( TIO_Set_Unstr_Chunk(file_id, mesh_id, (TIO_Size_t)c, (TIO_Dims_t)ndims,
+                                      (TIO_Size_t)chunk_nodes, (TIO_Size_t)chunk_cells,
+                                      nshapes, (TIO_Size_t)chunk_cells * shapesize,
+                                      TIO_GHOSTS_NONE, TIO_GHOSTS_NONE,
+                                      TIO_GHOSTS_NONE, TIO_GHOSTS_NONE,
+                                      (TIO_Size_t)0, (TIO_Size_t)0),
+                  "Set Unstructured Mesh Chunk Failed\n");
+    }
+
+    /* Each task writes its own chunks */
+    for (p = 0; p < cl.nparts; p++)
+    {
+        json_object *part_obj = json_object_array_get_idx(part_array, p);
+        json_object *coords = JsonGetObj(part_obj, "Mesh/Coords");
+        void const *node_connectivity = json_object_extarr_data(JsonGetObj(part_obj, "Mesh/Topology/Nodelist"));
+        int chunk = cl.first_chunk + p;
+        int *nodeIDs = (int*) malloc(sizeof(int) * chunk_nodes);
+        int *cellIDs = (int*) malloc(sizeof(int) * chunk_cells);
+
+        for (i = 0; i < chunk_nodes; i++)
+            nodeIDs[i] = chunk * chunk_nodes + i;
+        for (i = 0; i < chunk_cells; i++)
+            cellIDs[i] = chunk * chunk_cells + i;
+
+        TIO_Call( TIO_Write_UnstrMesh_Chunk(file_id, mesh_id, (TIO_Size_t)chunk, part_xfer(&cl, p),
+                                            TIO_INT, TIO_DOUBLE, nodeIDs, cellIDs, &shapetype,
+                                            &chunk_cells, node_connectivity,
+                                            json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords")),
+                                            json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords")),
+                                            json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"))),
+                  "Write Unstructured Mesh Failed\n");
+
+        free(nodeIDs);
+        free(cellIDs);
     }
 
     /* Loop over vars and then over parts */
-    /* currently assumes all vars exist on all ranks. but not all parts */
-    for (v = -1; v < json_object_array_length(first_part_vars_array); v++) /* -1 start is for Mesh */
+    /* currently assumes all vars exist on all ranks */
+    for (v = 0; v < json_object_array_length(first_part_vars_array); v++)
     {
         /* Inspect the first part's var object for name, datatype, etc. */
         json_object *var_obj = json_object_array_get_idx(first_part_vars_array, v);
+        char const *varName = json_object_path_get_string(var_obj, "name");
+        json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
+        TIO_Data_t dtype_id = json_object_extarr_type(dataobj) == json_extarr_type_flt64 ? TIO_DOUBLE : TIO_INT;
+        TIO_Centre_t tio_centering = strcmp(json_object_path_get_string(var_obj, "centering"), "zone") ?
+                                     TIO_CENTRE_NODE : TIO_CENTRE_CELL;
 
-        char *centering = (char*)malloc(sizeof(char)*5);
-        TIO_Data_t dtype_id;
-        int nshapes =  strcmp(mesh_type, "ucdzoo") ? MACSIO_MAIN_Size : 1;
-
-        if (v == -1){
- 
-            char const *shape = JsonGetStr(first_part_obj, "Mesh/Topology/ElemType");
-
-            if (!strcmp(shape, "Beam2"))
-            {
-                nconnectivity = nzones * 2;
-            }
-            else if (!strcmp(shape, "Quad4"))
-            {
-                nconnectivity = nzones * 4;
-            }
-            else if (!strcmp(shape, "Hex8"))
-            {
-                nconnectivity = nzones * 8;
-            } 
-            else if (!strcmp(shape, "Arbitrary"))
-            {
-                nconnectivity = nzones * 4;
-            }
-
-            TIO_Call( TIO_Create_Mesh(file_id, state_id, "mesh", &mesh_id, TIO_MESH_UNSTRUCT,
-                                    TIO_COORD_CARTESIAN, TIO_FALSE, "mesh_group", (TIO_Size_t)1,
-                                    TIO_INT, TIO_DOUBLE, (TIO_Dims_t)ndims, 
-                                    (TIO_Size_t)nnodes, (TIO_Size_t)nzones, nshapes,//nzones,
-                                    nconnectivity, (TIO_Size_t)MACSIO_MSF_SizeOfGroup(bat),
-                                    NULL, NULL, NULL,
-                                    NULL, NULL, NULL),
-                "Mesh Create Failed\n");
-        } else {
-            char const *varName = json_object_path_get_string(var_obj, "name");
-            centering = strdup(json_object_path_get_string(var_obj, "centering"));
-            TIO_Centre_t tio_centering = strcmp(centering, "zone") ? TIO_CENTRE_NODE : TIO_CENTRE_CELL;
-            json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
-            dtype_id = json_object_extarr_type(dataobj) == json_extarr_type_flt64 ? TIO_DOUBLE : TIO_INT;
-            
-            TIO_Call( TIO_Create_Quant(file_id, mesh_id, varName, &object_id, dtype_id, tio_centering,
-                                        TIO_GHOSTS_NONE, TIO_FALSE, "qunits"),
-                    "Quant Create Failed\n");
-
-            free(centering);
-        }
+        TIO_Call( TIO_Create_Quant(file_id, mesh_id, varName, &object_id, dtype_id, tio_centering,
+                                   TIO_GHOSTS_NONE, TIO_FALSE, "qunits"),
+                  "Quant Create Failed\n");
 
-        use_part_count = (int) ceil(json_object_path_get_double(main_obj, "clargs/avg_num_parts"));
-        for (p = 0; p < use_part_count; p++)
+        for (p = 0; p < cl.nparts; p++)
         {
-            json_object *part_obj = json_object_array_get_idx(part_array, p);
-            json_object *var_obj = 0;
-
-            void const *buf = 0;
-            void const *x_coord = 0;
-            void const *y_coord = 0;
-            void const *z_coord = 0;
-
-            if(part_obj)
-            {
-                if (v == -1){
-                    json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
-                    json_object *global_log_origin_array = json_object_path_get_array(part_obj, "GlobalLogOrigin");
-                    json_object *global_log_indices_array = json_object_path_get_array(part_obj, "GlobalLogIndices");
-                    json_object *mesh_dims_array = json_object_path_get_array(mesh_obj, "LogDims");
-                    int local_mesh_dims[3] = {0, 0, 0};
-                    int chunk_parameters[2] = {1, 1}; /* nnodes, ncells */
-
-                    /* Unused currently */
-                    TIO_Size_t nghost_nodes = TIO_GHOSTS_NONE;
-                    TIO_Size_t nghost_cells = TIO_GHOSTS_NONE;
-                    TIO_Size_t nghost_shapes = TIO_GHOSTS_NONE;
-                    TIO_Size_t nghost_connectivity = TIO_GHOSTS_NONE;
-                    TIO_Size_t nmixcell = 0;
-                    TIO_Size_t nmixcomp = 0;
-
-                    json_object *topoobj = JsonGetObj(part_obj, "Mesh/Topology");
-
-                    int chunk_cells = 1;
-                    int chunk_nodes = 1;
-
-                    for (i = 0; i < ndims; i++)
-                    {
-                        local_mesh_dims[i] = json_object_get_int(json_object_array_get_idx(mesh_dims_array, i));
-                        chunk_nodes *= local_mesh_dims[i]; // nnodes
-                        chunk_cells *= (local_mesh_dims[i]-1); // nzones/ncells
-                    }
-                    
-                    if (!strcmp(mesh_type, "ucdzoo"))
-                    {
-                        int shapesize;
-                        TIO_Shape_t shapetype = TIO_SHAPE_NULL;
-                        int ncells_per_shape = 9801;
-
-                        if (ndims == 1 || !strcmp(mesh_type, "ucdzoo")){                                             
-                             if (!strcmp(JsonGetStr(topoobj, "ElemType"), "Beam2"))
-                            {
-                                shapesize = 2;
-                                shapetype = TIO_SHAPE_BAR2;                             
-                            }
-                            else if (!strcmp(JsonGetStr(topoobj, "ElemType"), "Quad4"))
-                            {
-                                shapesize = 4;
-                                shapetype = TIO_SHAPE_QUAD4;
-                                    
-                            }
-                            else if (!strcmp(JsonGetStr(topoobj, "ElemType"), "Hex8"))
-                            {
-                                shapesize = 8;
-                                shapetype = TIO_SHAPE_HEX8;                         
-                            }
-                        }   
-
-                        int *global_nodes = (int*)malloc(sizeof(int)*MACSIO_MSF_SizeOfGroup(bat));
-                        int *global_cells = (int*)malloc(sizeof(int)*MACSIO_MSF_SizeOfGroup(bat));
-
-                        MPI_Allgather(&chunk_nodes, 1, MPI_INT, global_nodes, 1, MPI_INT, MACSIO_MSF_CommOfGroup(bat));
-                        MPI_Allgather(&chunk_cells, 1, MPI_INT, global_cells, 1, MPI_INT, MACSIO_MSF_CommOfGroup(bat));
-                
-                        for (i=0; i<MACSIO_MSF_SizeOfGroup(bat); i++)
-                        {
-                            nconnectivity = global_cells[i] * shapesize; 
-                            TIO_Call( TIO_Set_Unstr_Chunk(file_id, mesh_id, i, (TIO_Dims_t)ndims,
-                                                        global_nodes[i], global_cells[i],
-                                                        nshapes, nconnectivity,
-                                                        nghost_nodes, nghost_cells,
-                                                        nghost_shapes, nghost_connectivity,
-                                                        nmixcell, nmixcomp),
-                                    "Set UCDZOO Mesh Chunk Failed\n");
-                        }
-
-                        json_object *coords = json_object_path_get_object(mesh_obj, "Coords");
-
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"));
-
-                        int chunkID = MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank); //JsonGetInt(mesh_obj, "ChunkID");
-                        void const *node_connectivity = (void const*) json_object_extarr_data(JsonGetObj(topoobj, "Nodelist"));
-                        int *nodeIDs = (int*) malloc(sizeof(int) * chunk_nodes);
-                        int *cellIDs = (int*) malloc(sizeof(int) * chunk_cells);
-
-                        for (int k = 0; k < chunk_nodes; k++){
-                            nodeIDs[k] = k + ((int)global_nodes[chunkID] * chunkID);
-                        }
-
-                        for (int cell = 0; cell < chunk_cells; cell++){
-                            cellIDs[cell] = cell + ((int)global_cells[chunkID] * chunkID);
-                        }
-
-                        void const *node_ptr = nodeIDs;
-                        void const *cell_ptr = cellIDs;
-
-                        TIO_Call( TIO_Write_UnstrMesh_Chunk(file_id, mesh_id, (TIO_Size_t)MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank), TIO_XFER, 
-                                                    TIO_INT, TIO_DOUBLE, node_ptr, cell_ptr, &shapetype, 
-                                                    &ncells_per_shape, node_connectivity, x_coord, y_coord, z_coord),
-                                    "Write Unstructured Mesh Failed\n");
-
-                        free((void*)nodeIDs);
-                        free((void*)cellIDs);
-                    } else if (!strcmp(mesh_type, "arbitrary"))
-                    {       
-                        TIO_Size_t nshapes = MACSIO_MAIN_Size;
-                        int shapesize;
-                        TIO_Shape_t *shapetype = (TIO_Shape_t*)malloc(nshapes * sizeof(TIO_Shape_t));
-                        int ncells_per_shape = 9801;
-
-                        for (int s = 0; s<nshapes; s++){
-                            shapetype[s] = (TIO_Shape_t)4;
-                        }
-
-                        int *global_nodes = (int*)malloc(sizeof(int)*MACSIO_MSF_SizeOfGroup(bat));
-                        int *global_cells = (int*)malloc(sizeof(int)*MACSIO_MSF_SizeOfGroup(bat));
-
-                        MPI_Allgather(&chunk_nodes, 1, MPI_INT, global_nodes, 1, MPI_INT, MACSIO_MSF_CommOfGroup(bat));
-                        MPI_Allgather(&chunk_cells, 1, MPI_INT, global_cells, 1, MPI_INT, MACSIO_MSF_CommOfGroup(bat));
-                
-                        for (i=0; i<MACSIO_MSF_SizeOfGroup(bat); i++)
-                        {
-                            nconnectivity = global_cells[i] * shapesize; 
-                            TIO_Call( TIO_Set_Unstr_Chunk(file_id, mesh_id, i, (TIO_Dims_t)ndims,
-                                                        global_nodes[i], global_cells[i],
-                                                        nshapes, nconnectivity,
-                                                        nghost_nodes, nghost_cells,
-                                                        nghost_shapes, nghost_connectivity,
-                                                        nmixcell, nmixcomp),
-                                    "Set UCDZOO Mesh Chunk Failed\n");
-                        }
-
-                        json_object *coords = json_object_path_get_object(mesh_obj, "Coords");
-
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"));
-
-                        int chunkID = MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank); //JsonGetInt(mesh_obj, "ChunkID");
-                        void const *node_connectivity = (void const*) json_object_extarr_data(JsonGetObj(topoobj, "Nodelist"));
-                        int *nodeIDs = (int*) malloc(sizeof(int) * chunk_nodes);
-                        int *cellIDs = (int*) malloc(sizeof(int) * chunk_cells);
-
-                        for (int k = 0; k < chunk_nodes; k++){
-                            nodeIDs[k] = k + ((int)global_nodes[chunkID] * chunkID);
-                        }
-
-                        for (int cell = 0; cell < chunk_cells; cell++){
-                            cellIDs[cell] = cell + ((int)global_cells[chunkID] * chunkID);
-                        }
-
-                        void const *node_ptr = nodeIDs;
-                        void const *cell_ptr = cellIDs;
-
-                        TIO_Call( TIO_Write_UnstrMesh_Chunk(file_id, mesh_id, (TIO_Size_t)chunkID, TIO_XFER, 
-                                                    TIO_INT, TIO_DOUBLE, node_ptr, cell_ptr, shapetype, 
-                                                    &ncells_per_shape, node_connectivity, x_coord, y_coord, z_coord),
-                                    "Write Unstructured Mesh Failed\n");
-
-                        free((void*)nodeIDs);
-                        free((void*)cellIDs);
-                    }
-
-                } else {
-                    json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
-                    json_object *var_obj = json_object_array_get_idx(vars_array, v);
-                    json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
-
-                    buf = json_object_extarr_data(extarr_obj);
-
-                    TIO_Call( TIO_Write_UnstrQuant_Chunk(file_id, object_id, MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank), TIO_XFER,
-                                                        dtype_id, buf, (void*)TIO_NULL),
-                                        "Write UCDZOO Quant Chunk Failed\n")
-
-                    TIO_Call(TIO_Close_Quant(file_id, object_id),
-                            "Close Quant Failed");
-                }
-            }
+            json_object *vars_array = json_object_path_get_array(json_object_array_get_idx(part_array, p), "Vars");
+            void const *buf = json_object_extarr_data(
+                json_object_path_get_extarr(json_object_array_get_idx(vars_array, v), "data"));
 
+            TIO_Call( TIO_Write_UnstrQuant_Chunk(file_id, object_id, (TIO_Size_t)(cl.first_chunk + p),
+                                                 part_xfer(&cl, p), dtype_id, buf, (void*)TIO_NULL),
+                      "Write Unstructured Quant Chunk Failed\n");
         }
 
+        TIO_Call( TIO_Close_Quant(file_id, object_id),
+                  "Close Quant Failed\n");
     }
 
     TIO_Call( TIO_Close_Mesh(file_id, mesh_id),
-                "Close Mesh Failed");
+              "Close Mesh Failed\n");
 }
 
-static void write_mesh_hybrid(
-    MACSIO_MSF_baton_t const *bat,
-    TIO_File_t file_id,             /**< [in] The file id being used in MIF dump */
-    TIO_Object_t state_id,          /**< [in] The state id of the current dump */
-    json_object *main_obj)  /**< [in] JSON object representing this mesh part */
+/*!
+\brief Calls the relevant method for different mesh types writing a shared file
+
+This method checks the JSON object for the type of mesh and passes writing to
+the correct method with a corresponding mesh type flag
+*/
+static void write_mesh_whole(
+    MPI_Comm comm,          /**< [in] Communicator of the tasks sharing the file */
+    TIO_File_t file_id,     /**< [in] The file id being used in SIF/MSF dump */
+    TIO_Object_t state_id,  /**< [in] The state id of the current dump */
+    json_object *main_obj)  /**< [in] The main JSON object containing mesh data */
 {
-    json_object *parts = json_object_path_get_array(main_obj, "problem/parts");
-    json_object *first_part = json_object_array_get_idx(parts, 0);
-
-    if (!strcmp(JsonGetStr(first_part, "Mesh/MeshType"), "rectilinear"))
-        write_quad_mesh_whole(bat, file_id, state_id, main_obj, TIO_MESH_QUAD_COLINEAR);
-    else if (!strcmp(JsonGetStr(first_part, "Mesh/MeshType"), "curvilinear"))
-        write_quad_mesh_whole(bat, file_id, state_id, main_obj, TIO_MESH_QUAD_NONCOLINEAR);
-    else if (!strcmp(JsonGetStr(first_part, "Mesh/MeshType"), "ucdzoo"))
-        write_ucd_mesh_whole(bat, file_id, state_id, main_obj, "ucdzoo");
-    else if (!strcmp(JsonGetStr(first_part, "Mesh/MeshType"), "arbitrary"))
-        write_ucd_mesh_whole(bat, file_id, state_id, main_obj, "arbitrary");
+    char const *mesh_type = JsonGetStr(main_obj, "clargs/part_type");
+
+    if (!strcmp(mesh_type, "rectilinear"))
+        write_quad_mesh_whole(comm, file_id, state_id, main_obj, TIO_MESH_QUAD_COLINEAR);
+    else if (!strcmp(mesh_type, "curvilinear"))
+        write_quad_mesh_whole(comm, file_id, state_id, main_obj, TIO_MESH_QUAD_NONCOLINEAR);
+    else if (!strcmp(mesh_type, "ucdzoo"))
+        write_ucd_mesh_whole(comm, file_id, state_id, main_obj, "ucdzoo");
+    else if (!strcmp(mesh_type, "arbitrary"))
+        write_ucd_mesh_whole(comm, file_id, state_id, main_obj, "arbitrary");
 }
 
 /*!
@@ -1094,18 +999,18 @@ static void write_mesh_hybrid(
 
 This function is called to handle MSF file dumps.
 
-The files and states are created before passing off to write_quad_mesh_part_shared
-or write_ucd_mesh_part_shared to handle the dump of the data.
+The tasks of each group share one file. The file and state are created before
+passing off to \ref write_mesh_whole to handle the dump of the data.
 */
 static void main_dump_msf(
-    json_object *main_obj,
-    int numFiles,
-    int dumpn,
-    double dumpt)
+    json_object *main_obj,  /**< [in] The main JSON object representing all data to be dumped */
+    int numFiles,           /**< [in] Number of files in the output dump */
+    int dumpn,              /**< [in] The number/index of this dump */
+    double dumpt)           /**< [in] The time the be associated with this dump */
 {
     int size, rank;
-    TIO_t *tioFile_ptr;
     TIO_File_t tioFile;
+    TIO_Object_t state_id;
     char fileName[256];
     char stateName[256];
     group_data_t userData;
@@ -1127,547 +1032,28 @@ static void main_dump_msf(
 
     MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
 
-    /* Create */
-    //MPI_Comm *groupComm = (MPI_Comm*)userData;
     char *date = getDate();
+    MPI_Info mpiInfo = make_mpi_info(main_obj);
     TIO_Call( TIO_Create(fileName, &tioFile, TIO_ACC_REPLACE, "MACSio",
-                         "1.0", date, (char*)fileName, MACSIO_MSF_CommOfGroup(bat), MPI_INFO_NULL, MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank)),
+                         "1.0", date, (char*)fileName, MACSIO_MSF_CommOfGroup(bat), mpiInfo, MACSIO_MSF_RankInGroup(bat, MACSIO_MAIN_Rank)),
               "File Creation Failed\n");
-    /* Create */ 
+    if (mpiInfo != MPI_INFO_NULL)
+        MPI_Info_free(&mpiInfo);
 
-    json_object *parts = json_object_path_get_array(main_obj, "problem/parts");
+    TIO_Call( TIO_Create_State(tioFile, stateName, &state_id, 1, (TIO_Time_t)0.0, "us"),
+              "State Create Failed\n");
 
-    for (int i = 0; i < json_object_array_length(parts); i++)
-    {
-        char domain_dir[256];
-        json_object *this_part = json_object_array_get_idx(parts, i);
-        TIO_Object_t domain_group_id;
-
-        snprintf(domain_dir, sizeof(domain_dir), "domain_%07d",
-                 json_object_path_get_int(this_part, "Mesh/ChunkID"));
-
-        TIO_Call( TIO_Create_State(tioFile, domain_dir, &domain_group_id, 1, (TIO_Time_t)0.0, "us"),
-                  "State Create Failed\n");
+    write_mesh_whole(MACSIO_MSF_CommOfGroup(bat), tioFile, state_id, main_obj);
 
-        write_mesh_hybrid(bat, tioFile, domain_group_id, main_obj);
+    TIO_Call( TIO_Close_State(tioFile, state_id),
+              "State Close Failed\n");
 
-        TIO_Call( TIO_Close_State(tioFile, domain_group_id),
-                  "State Close Failed\n");
-    }
     /* Close the checkpoint file */
     TIO_Call( TIO_Close(tioFile),
       "Close File failed\n");
 
-    /* We're done using MACSIO_MIF, so finish it off */
+    /* We're done using MACSIO_MSF, so finish it off */
     MACSIO_MSF_Finish(bat);
-
-
-}
-
-/*!
-\brief Write all quad mesh parts to a SIF file
-
-This method serializes the JSON object for all mesh parts and then
-appends/writes to the end of the shared file.
-
-This method is used for both Rectilinear (Colinear) and Curvilinear (Non-Colinear)
-Quad meshes.
-*/ 
-static void write_quad_mesh_whole(
-    TIO_File_t file_id,     /**< [in] The file id being used in SIF dump */
-    TIO_Object_t state_id,  /**< [in] The state id of the current dump */
-    json_object *main_obj,  /**< [in] The main JSON object containing mesh data */
-    TIO_Mesh_t mesh_type)   /**< [in] Type of mesh [TIO_MESH_QUAD_COLINEAR/TIO_MESH_QUAD_NONCOLINEAR] */    
-{
-    TIO_Object_t mesh_id;
-    TIO_Object_t object_id;
-    int ndims;
-    int i, v, p;
-    int use_part_count;
-    const TIO_Xfer_t TIO_XFER = no_collective ? TIO_XFER_INDEPENDENT : TIO_XFER_COLLECTIVE;
-
-    TIO_Size_t dims[3];
-
-    ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
-    json_object *global_log_dims_array = json_object_path_get_array(main_obj, "problem/global/LogDims");
-    json_object *global_parts_log_dims_array = json_object_path_get_array(main_obj, "problem/global/PartsLogDims");
-    
-
-    for (i = 0; i < ndims; i++)
-    {
-        dims[i] = (TIO_Size_t) JsonGetInt(global_log_dims_array, "", i);
-    }
-
-    /* Get the list of vars on the first part as a guide to loop over vars */
-    json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
-    json_object *first_part_obj = json_object_array_get_idx(part_array, 0);
-    json_object *first_part_vars_array = json_object_path_get_array(first_part_obj, "Vars");
-
-    /* Loop over vars and then over parts */
-    /* currently assumes all vars exist on all ranks. but not all parts */
-    for (v = -1; v < json_object_array_length(first_part_vars_array); v++) /* -1 start is for Mesh */
-    {
-        /* Inspect the first part's var object for name, datatype, etc. */
-        json_object *var_obj = json_object_array_get_idx(first_part_vars_array, v);
-
-        char *centering = (char*)malloc(sizeof(char)*5);
-        TIO_Data_t dtype_id;
-
-        //MESH
-        TIO_Dims_t ndims_tio = (TIO_Dims_t)ndims;
-
-        if (v == -1) { 
-            TIO_Call( TIO_Create_Mesh(file_id, state_id, "mesh", &mesh_id, mesh_type,
-                                      TIO_COORD_CARTESIAN, TIO_FALSE, "mesh_group", (TIO_Size_t)1,
-                                      TIO_DATATYPE_NULL, TIO_DOUBLE, ndims_tio,
-                                      dims[0], dims[1], dims[2],
-                                      TIO_GHOSTS_NONE, (TIO_Size_t)MACSIO_MAIN_Size,
-                                      NULL, NULL, NULL,
-                                      NULL, NULL, NULL),
-
-                      "Mesh Create Failed\n");
-        } else{
-            char const *varName = json_object_path_get_string(var_obj, "name");
-            centering = strdup(json_object_path_get_string(var_obj, "centering"));
-            json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
-            dtype_id = json_object_extarr_type(dataobj) == json_extarr_type_flt64 ? TIO_DOUBLE : TIO_INT;
-            TIO_Centre_t tio_centering = strcmp(centering, "zone") ? TIO_CENTRE_NODE : TIO_CENTRE_CELL;
-
-            TIO_Call( TIO_Create_Quant(file_id, mesh_id, varName, &object_id, dtype_id, tio_centering,
-                                        TIO_GHOSTS_NONE, TIO_FALSE, "qunits"),
-                    "Quant Create Failed\n");
-
-            free(centering);
-        }
-
-        /* Loop to make write calls for this var for each part on this rank */
-        use_part_count = (int) ceil(json_object_path_get_double(main_obj, "clargs/avg_num_parts"));
-        for (p = 0; p < use_part_count; p++)
-        {
-            json_object *part_obj = json_object_array_get_idx(part_array, p);
-            json_object *var_obj = 0;
-
-            void const *buf = 0;
-            void const *x_coord = 0;
-            void const *y_coord = 0;
-            void const *z_coord = 0;
-
-            void *x_coord_root = 0;
-            void *y_coord_root = 0;
-            void *z_coord_root = 0;
-
-            if (part_obj)
-            {
-                if (v == -1) {
-                    //Mesh
-                    json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
-                    json_object *global_log_origin_array = json_object_path_get_array(part_obj, "GlobalLogOrigin");
-                    json_object *global_log_indices_array = json_object_path_get_array(part_obj, "GlobalLogIndices");
-                    json_object *mesh_dims_array = json_object_path_get_array(mesh_obj, "LogDims");
-                    int local_mesh_dims[3];
-                    TIO_Size_t local_chunk_indices[6] = {0,0,0,0,0,0};  /* local_chunk_indices [il, ih, jl, jh, kl, kh] */
-                    
-                    for (i = 0; i < ndims; i++)
-                    {
-                        local_mesh_dims[i] = json_object_get_int(json_object_array_get_idx(mesh_dims_array, i));
-                        int start = json_object_get_int(json_object_array_get_idx(global_log_origin_array, i));
-                        int count = json_object_get_int(json_object_array_get_idx(mesh_dims_array, i)) - 1;
-
-                        local_chunk_indices[i*2] = start;
-                        local_chunk_indices[(i*2)+1] = start + count;
-                    }
-                                    
-                    TIO_Size_t chunk_indices[MACSIO_MAIN_Size][6];
-                    MPI_Allgather(local_chunk_indices, 6, MPI_DOUBLE, chunk_indices, 6, MPI_DOUBLE, MACSIO_MAIN_Comm);
-
-                    for (int k=0; k<MACSIO_MAIN_Size; k++){
-                        TIO_Call( TIO_Set_Quad_Chunk(file_id, mesh_id, k, ndims_tio,
-                                                chunk_indices[k][0], chunk_indices[k][1],
-                                                chunk_indices[k][2], chunk_indices[k][3],
-                                                chunk_indices[k][4], chunk_indices[k][5],
-                                                 (TIO_Size_t)0, (TIO_Size_t)0),
-                             "Set Quad Mesh Chunk Failed\n");
-                    }
-
-                    json_object *coords = json_object_path_get_object(mesh_obj, "Coords");
-
-                    int coord_array_size[] = {0, 0, 0};
-                    
-                    if (mesh_type == TIO_MESH_QUAD_COLINEAR){
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XAxisCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YAxisCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZAxisCoords"));  
-                        coord_array_size[0] = dims[0];
-                        coord_array_size[1] = dims[1];
-                        coord_array_size[2] = dims[2];  
-
-                        int parts = json_object_path_get_int(main_obj, "problem/global/TotalParts");;
-
-                        if (MACSIO_MAIN_Rank == 0){
-                            x_coord_root = malloc(coord_array_size[0] * sizeof(double));
-                            if (ndims > 1) y_coord_root = malloc(coord_array_size[1] * sizeof(double));
-                            if (ndims > 2) z_coord_root = malloc(coord_array_size[2] * sizeof(double));
-                        }
-
-                        json_object *bounds = json_object_path_get_array(mesh_obj, "Bounds");
-
-                        int color = (JsonGetInt(bounds,"",1) == 0 && JsonGetInt(bounds,"",2) ==0) ? 1: MPI_UNDEFINED;
-                        MPI_Comm comm;
-                        MPI_Comm_split(MACSIO_MAIN_Comm, color, MACSIO_MAIN_Rank, &comm);
-                        if (color == 1){
-                        MPI_Gather((void*)x_coord, local_mesh_dims[0], MPI_DOUBLE, x_coord_root, local_mesh_dims[0], MPI_DOUBLE, 0, comm);
-                        }
-                        if (ndims > 1){
-                            color = (JsonGetInt(bounds, "", 0)==0 && JsonGetInt(bounds,"",2)==0) ? 1: MPI_UNDEFINED;
-                            MPI_Comm_split(MACSIO_MAIN_Comm, color, MACSIO_MAIN_Rank, &comm);
-                            if (color == 1){
-                            MPI_Gather((void*)y_coord, local_mesh_dims[1], MPI_DOUBLE, y_coord_root, local_mesh_dims[1], MPI_DOUBLE, 0, comm);
-                            }                   
-                        }
-                        if (ndims > 2){
-                            color = (JsonGetInt(bounds, "", 0)==0 && JsonGetInt(bounds,"",1)==0) ? 1: MPI_UNDEFINED;
-                            MPI_Comm_split(MACSIO_MAIN_Comm, color, MACSIO_MAIN_Rank, &comm);
-                            if (color == 1)
-                            MPI_Gather((void*)z_coord, local_mesh_dims[2], MPI_DOUBLE, z_coord_root, local_mesh_dims[2], MPI_DOUBLE, 0, comm);
-
-                        }
-                    } else {
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"));
-                    }
-
-                } else {
-                    //Variable 
-                    json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
-                    json_object *var_obj = json_object_array_get_idx(vars_array, v);
-                    json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
-
-                    buf = json_object_extarr_data(extarr_obj);
-                }
-            }
-
-            if (v == -1) { 
-
-                if (mesh_type == TIO_MESH_QUAD_COLINEAR){
-                    if (MACSIO_MAIN_Rank == 0){                 
-                        TIO_Call( TIO_Write_QuadMesh_All(file_id, mesh_id, TIO_DOUBLE, x_coord_root, y_coord_root, z_coord_root),
-                            "Write Quad Mesh All Failed\n");
-                    }
-                } else {
-                    TIO_Call( TIO_Write_QuadMesh_Chunk(file_id, mesh_id, MACSIO_MAIN_Rank, TIO_XFER,
-                                                        TIO_DOUBLE, x_coord, y_coord, z_coord),
-                                "Write Non-Colinear Mesh Coords failed\n");
-                }
-            } else {                
-                TIO_Call( TIO_Write_QuadQuant_Chunk(file_id, object_id, MACSIO_MAIN_Rank, 
-                                                TIO_XFER, dtype_id, buf, (void*)TIO_NULL),
-                    "Write Quad Quant Chunk Failed\n");
-
-                TIO_Call( TIO_Close_Quant(file_id, object_id),
-                    "Close Quant Failed\n");
-            }
-
-            free(x_coord_root);
-            free(y_coord_root);
-            free(z_coord_root);
-        }
-    }
-
-    TIO_Call( TIO_Close_Mesh(file_id, mesh_id),
-          "Close Mesh Failed\n");
-
-}
-
-/*!
-\brief Write all unstructured mesh parts to a SIF file
-
-This method serializes the JSON object for all mesh parts and then
-appends/writes to the end of the shared file.
-
-This method is used for both Unstructured Zoo and Arbitraty 
-Unstructured meshes.
-*/ 
-static void write_ucd_mesh_whole(
-    TIO_File_t file_id,     /**< [in] The file id being used in SIF dump */
-    TIO_Object_t state_id,  /**< [in] The state id of the current dump */
-    json_object *main_obj,  /**< [in] The main JSON object containing mesh data */
-    char *mesh_type)        /**< [in] Type of mesh [TIO_MESH_QUAD_COLINEAR/TIO_MESH_QUAD_NONCOLINEAR] */ 
-{
-    TIO_Object_t mesh_id;
-    TIO_Object_t object_id;
-    int i, v, p;
-    int use_part_count;
-    const TIO_Xfer_t TIO_XFER = no_collective ? TIO_XFER_INDEPENDENT : TIO_XFER_COLLECTIVE;
-    TIO_File_t dims[3];
-    int nnodes = 1, nzones = 1;
-    TIO_Size_t nconnectivity = 1;
-
-    int ndims = json_object_path_get_int(main_obj, "clargs/part_dim");
-    json_object *global_log_dims_array = json_object_path_get_array(main_obj, "problem/global/LogDims");
-    json_object *global_parts_log_dims_array = json_object_path_get_array(main_obj, "problem/global/PartsLogDims");
-
-    for (i = 0; i < ndims; i++)
-    {
-        dims[i] = (TIO_Size_t) JsonGetInt(global_log_dims_array, "", i);
-        nnodes *= dims[i];
-        nzones *= dims[i]-JsonGetInt(global_parts_log_dims_array,"", i);
-    }
-
-    /* Get the list of vars on the first part as a guide to loop over vars */
-    json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
-    json_object *first_part_obj = json_object_array_get_idx(part_array, 0);
-    json_object *first_part_vars_array = json_object_path_get_array(first_part_obj, "Vars");
-
-    /* Loop over vars and then over parts */
-    /* currently assumes all vars exist on all ranks. but not all parts */
-    for (v = -1; v < json_object_array_length(first_part_vars_array); v++) /* -1 start is for Mesh */
-    {
-        /* Inspect the first part's var object for name, datatype, etc. */
-        json_object *var_obj = json_object_array_get_idx(first_part_vars_array, v);
-
-        char *centering = (char*)malloc(sizeof(char)*5);
-        TIO_Data_t dtype_id;
-        int nshapes =  strcmp(mesh_type, "ucdzoo") ? MACSIO_MAIN_Size : 1;
-
-        if (v == -1){
- 
-            char const *shape = JsonGetStr(first_part_obj, "Mesh/Topology/ElemType");
-
-            if (!strcmp(shape, "Beam2"))
-            {
-                nconnectivity = nzones * 2;
-            }
-            else if (!strcmp(shape, "Quad4"))
-            {
-                nconnectivity = nzones * 4;
-            }
-            else if (!strcmp(shape, "Hex8"))
-            {
-                nconnectivity = nzones * 8;
-            } 
-            else if (!strcmp(shape, "Arbitrary"))
-            {
-                nconnectivity = nzones * 4;
-            }
-
-            TIO_Call( TIO_Create_Mesh(file_id, state_id, "mesh", &mesh_id, TIO_MESH_UNSTRUCT,
-                                    TIO_COORD_CARTESIAN, TIO_FALSE, "mesh_group", (TIO_Size_t)1,
-                                    TIO_INT, TIO_DOUBLE, (TIO_Dims_t)ndims, 
-                                    (TIO_Size_t)nnodes, (TIO_Size_t)nzones, nshapes,//nzones,
-                                    nconnectivity, (TIO_Size_t)MACSIO_MAIN_Size,
-                                    NULL, NULL, NULL,
-                                    NULL, NULL, NULL),
-                "Mesh Create Failed\n");
-        } else {
-            char const *varName = json_object_path_get_string(var_obj, "name");
-            centering = strdup(json_object_path_get_string(var_obj, "centering"));
-            TIO_Centre_t tio_centering = strcmp(centering, "zone") ? TIO_CENTRE_NODE : TIO_CENTRE_CELL;
-            json_object *dataobj = json_object_path_get_extarr(var_obj, "data");
-            dtype_id = json_object_extarr_type(dataobj) == json_extarr_type_flt64 ? TIO_DOUBLE : TIO_INT;
-            
-            TIO_Call( TIO_Create_Quant(file_id, mesh_id, varName, &object_id, dtype_id, tio_centering,
-                                        TIO_GHOSTS_NONE, TIO_FALSE, "qunits"),
-                    "Quant Create Failed\n");
-
-            free(centering);
-        }
-
-        use_part_count = (int) ceil(json_object_path_get_double(main_obj, "clargs/avg_num_parts"));
-        for (p = 0; p < use_part_count; p++)
-        {
-            json_object *part_obj = json_object_array_get_idx(part_array, p);
-            json_object *var_obj = 0;
-
-            void const *buf = 0;
-            void const *x_coord = 0;
-            void const *y_coord = 0;
-            void const *z_coord = 0;
-
-            if(part_obj)
-            {
-                if (v == -1){
-                    json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
-                    json_object *global_log_origin_array = json_object_path_get_array(part_obj, "GlobalLogOrigin");
-                    json_object *global_log_indices_array = json_object_path_get_array(part_obj, "GlobalLogIndices");
-                    json_object *mesh_dims_array = json_object_path_get_array(mesh_obj, "LogDims");
-                    int local_mesh_dims[3] = {0, 0, 0};
-                    int chunk_parameters[2] = {1, 1}; /* nnodes, ncells */
-
-                    /* Unused currently */
-                    TIO_Size_t nghost_nodes = TIO_GHOSTS_NONE;
-                    TIO_Size_t nghost_cells = TIO_GHOSTS_NONE;
-                    TIO_Size_t nghost_shapes = TIO_GHOSTS_NONE;
-                    TIO_Size_t nghost_connectivity = TIO_GHOSTS_NONE;
-                    TIO_Size_t nmixcell = 0;
-                    TIO_Size_t nmixcomp = 0;
-
-                    json_object *topoobj = JsonGetObj(part_obj, "Mesh/Topology");
-
-                    int chunk_cells = 1;
-                    int chunk_nodes = 1;
-
-                    for (i = 0; i < ndims; i++)
-                    {
-                        local_mesh_dims[i] = json_object_get_int(json_object_array_get_idx(mesh_dims_array, i));
-                        chunk_nodes *= local_mesh_dims[i]; // nnodes
-                        chunk_cells *= (local_mesh_dims[i]-1); // nzones/ncells
-                    }
-                    
-                    if (!strcmp(mesh_type, "ucdzoo"))
-                    {
-                        int shapesize;
-                        TIO_Shape_t shapetype = TIO_SHAPE_NULL;
-                        int ncells_per_shape = 9801;
-
-                        if (ndims == 1 || !strcmp(mesh_type, "ucdzoo")){                                             
-                             if (!strcmp(JsonGetStr(topoobj, "ElemType"), "Beam2"))
-                            {
-                                shapesize = 2;
-                                shapetype = TIO_SHAPE_BAR2;                             
-                            }
-                            else if (!strcmp(JsonGetStr(topoobj, "ElemType"), "Quad4"))
-                            {
-                                shapesize = 4;
-                                shapetype = TIO_SHAPE_QUAD4;
-                                    
-                            }
-                            else if (!strcmp(JsonGetStr(topoobj, "ElemType"), "Hex8"))
-                            {
-                                shapesize = 8;
-                                shapetype = TIO_SHAPE_HEX8;                         
-                            }
-                        }   
-
-                        int *global_nodes = (int*)malloc(sizeof(int)*MACSIO_MAIN_Size);
-                        int *global_cells = (int*)malloc(sizeof(int)*MACSIO_MAIN_Size);
-
-                        MPI_Allgather(&chunk_nodes, 1, MPI_INT, global_nodes, 1, MPI_INT, MACSIO_MAIN_Comm);
-                        MPI_Allgather(&chunk_cells, 1, MPI_INT, global_cells, 1, MPI_INT, MACSIO_MAIN_Comm);
-                
-                        for (i=0; i<MACSIO_MAIN_Size; i++)
-                        {
-                            nconnectivity = global_cells[i] * shapesize; 
-                            TIO_Call( TIO_Set_Unstr_Chunk(file_id, mesh_id, i, (TIO_Dims_t)ndims,
-                                                        global_nodes[i], global_cells[i],
-                                                        nshapes, nconnectivity,
-                                                        nghost_nodes, nghost_cells,
-                                                        nghost_shapes, nghost_connectivity,
-                                                        nmixcell, nmixcomp),
-                                    "Set UCDZOO Mesh Chunk Failed\n");
-                        }
-
-                        json_object *coords = json_object_path_get_object(mesh_obj, "Coords");
-
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"));
-
-                        int chunkID = JsonGetInt(mesh_obj, "ChunkID");
-                        void const *node_connectivity = (void const*) json_object_extarr_data(JsonGetObj(topoobj, "Nodelist"));
-                        int *nodeIDs = (int*) malloc(sizeof(int) * chunk_nodes);
-                        int *cellIDs = (int*) malloc(sizeof(int) * chunk_cells);
-
-                        for (int k = 0; k < chunk_nodes; k++){
-                            nodeIDs[k] = k + ((int)global_nodes[chunkID] * chunkID);
-                        }
-
-                        for (int cell = 0; cell < chunk_cells; cell++){
-                            cellIDs[cell] = cell + ((int)global_cells[chunkID] * chunkID);
-                        }
-
-                        void const *node_ptr = nodeIDs;
-                        void const *cell_ptr = cellIDs;
-
-                        TIO_Call( TIO_Write_UnstrMesh_Chunk(file_id, mesh_id, (TIO_Size_t)MACSIO_MAIN_Rank, TIO_XFER, 
-                                                    TIO_INT, TIO_DOUBLE, node_ptr, cell_ptr, &shapetype, 
-                                                    &ncells_per_shape, node_connectivity, x_coord, y_coord, z_coord),
-                                    "Write Unstructured Mesh Failed\n");
-
-                        free((void*)nodeIDs);
-                        free((void*)cellIDs);
-                    } else if (!strcmp(mesh_type, "arbitrary"))
-                    {       
-                        TIO_Size_t nshapes = MACSIO_MAIN_Size;
-                        int shapesize;
-                        TIO_Shape_t *shapetype = (TIO_Shape_t*)malloc(nshapes * sizeof(TIO_Shape_t));
-                        int ncells_per_shape = 9801;
-
-                        for (int s = 0; s<nshapes; s++){
-                            shapetype[s] = (TIO_Shape_t)4;
-                        }
-
-                        int *global_nodes = (int*)malloc(sizeof(int)*MACSIO_MAIN_Size);
-                        int *global_cells = (int*)malloc(sizeof(int)*MACSIO_MAIN_Size);
-
-                        MPI_Allgather(&chunk_nodes, 1, MPI_INT, global_nodes, 1, MPI_INT, MACSIO_MAIN_Comm);
-                        MPI_Allgather(&chunk_cells, 1, MPI_INT, global_cells, 1, MPI_INT, MACSIO_MAIN_Comm);
-                
-                        for (i=0; i<MACSIO_MAIN_Size; i++)
-                        {
-                            nconnectivity = global_cells[i] * shapesize; 
-                            TIO_Call( TIO_Set_Unstr_Chunk(file_id, mesh_id, i, (TIO_Dims_t)ndims,
-                                                        global_nodes[i], global_cells[i],
-                                                        nshapes, nconnectivity,
-                                                        nghost_nodes, nghost_cells,
-                                                        nghost_shapes, nghost_connectivity,
-                                                        nmixcell, nmixcomp),
-                                    "Set UCDZOO Mesh Chunk Failed\n");
-                        }
-
-                        json_object *coords = json_object_path_get_object(mesh_obj, "Coords");
-
-                        x_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "XCoords"));
-                        y_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "YCoords"));
-                        z_coord = json_object_extarr_data(json_object_path_get_extarr(coords, "ZCoords"));
-
-                        int chunkID = JsonGetInt(mesh_obj, "ChunkID");
-                        void const *node_connectivity = (void const*) json_object_extarr_data(JsonGetObj(topoobj, "Nodelist"));
-                        int *nodeIDs = (int*) malloc(sizeof(int) * chunk_nodes);
-                        int *cellIDs = (int*) malloc(sizeof(int) * chunk_cells);
-
-                        for (int k = 0; k < chunk_nodes; k++){
-                            nodeIDs[k] = k + ((int)global_nodes[chunkID] * chunkID);
-                        }
-
-                        for (int cell = 0; cell < chunk_cells; cell++){
-                            cellIDs[cell] = cell + ((int)global_cells[chunkID] * chunkID);
-                        }
-
-                        void const *node_ptr = nodeIDs;
-                        void const *cell_ptr = cellIDs;
-
-                        TIO_Call( TIO_Write_UnstrMesh_Chunk(file_id, mesh_id, (TIO_Size_t)MACSIO_MAIN_Rank, TIO_XFER, 
-                                                    TIO_INT, TIO_DOUBLE, node_ptr, cell_ptr, shapetype, 
-                                                    &ncells_per_shape, node_connectivity, x_coord, y_coord, z_coord),
-                                    "Write Unstructured Mesh Failed\n");
-
-                        free((void*)nodeIDs);
-                        free((void*)cellIDs);
-                    }
-
-                } else {
-                    json_object *vars_array = json_object_path_get_array(part_obj, "Vars");
-                    json_object *var_obj = json_object_array_get_idx(vars_array, v);
-                    json_object *extarr_obj = json_object_path_get_extarr(var_obj, "data");
-
-                    buf = json_object_extarr_data(extarr_obj);
-
-                    TIO_Call( TIO_Write_UnstrQuant_Chunk(file_id, object_id, MACSIO_MAIN_Rank, TIO_XFER,
-                                                        dtype_id, buf, (void*)TIO_NULL),
-                                        "Write UCDZOO Quant Chunk Failed\n")
-
-                    TIO_Call(TIO_Close_Quant(file_id, object_id),
-                            "Close Quant Failed");
-                }
-            }
-
-        }
-
-    }
-
-    TIO_Call( TIO_Close_Mesh(file_id, mesh_id),
-                "Close Mesh Failed");
 }
 
 /*!
@@ -1675,8 +1061,8 @@ static void write_ucd_mesh_whole(
 
 This function is called to handle SIF file dumps.
 
-The file and state is created before passing off to \ref write_quad_mesh_whole or
-\ref write_ucd_mesh_whole to handle the dump of data
+The file and state is created before passing off to \ref write_mesh_whole
+to handle the dump of data
 */
 static void main_dump_sif(
     json_object *main_obj,  /**< [in] The main JSON object containing mesh data */
@@ -1689,20 +1075,7 @@ static void main_dump_sif(
     TIO_Object_t state_id, variable_id;
     char state_name[16];
     char *date = (char*)getDate();
-    MPI_Info mpiInfo = MPI_INFO_NULL;
-
-    if (romio_cb_write || romio_ds_write || striping_factor){
-	MPI_Info_create(&mpiInfo);
-	if (strcmp(romio_cb_write,"enable") || strcmp(romio_cb_write,"disable")){
-	    MPI_Info_set(mpiInfo, "romio_cb_write", romio_cb_write);
-	}
-	if (strcmp(romio_ds_write,"enable") || strcmp(romio_ds_write,"disable")){
-	    MPI_Info_set(mpiInfo, "romio_ds_write", romio_ds_write);
-	}
-	if (striping_factor){
-	    MPI_Info_set(mpiInfo, "striping_factor", striping_factor);
-	}
-    }
+    MPI_Info mpiInfo = make_mpi_info(main_obj);
     int file_suffix = dumpn;
     sprintf(state_name, "state0");
 
@@ -1717,24 +1090,13 @@ static void main_dump_sif(
     TIO_Call( TIO_Create(fileName, &tiofile_id, TIO_ACC_REPLACE, "MACSio",
         "1.0", date, fileName, MACSIO_MAIN_Comm, mpiInfo, MACSIO_MAIN_Rank),
     "File Creation Failed\n");
-    if (romio_cb_write || romio_ds_write || striping_factor){
+    if (mpiInfo != MPI_INFO_NULL){
 	MPI_Info_free(&mpiInfo);
     }
     TIO_Call( TIO_Create_State(tiofile_id, state_name, &state_id, 1, (TIO_Time_t)0.0, "us"),
         "State Create Failed\n");
 
-    json_object *part_array = json_object_path_get_array(main_obj, "problem/parts");
-    json_object *part_obj = json_object_array_get_idx(part_array, 0);
-    json_object *mesh_obj = json_object_path_get_object(part_obj, "Mesh");
-
-    if (!strcmp(JsonGetStr(mesh_obj, "MeshType"), "rectilinear"))
-        write_quad_mesh_whole(tiofile_id, state_id, main_obj, TIO_MESH_QUAD_COLINEAR);
-    else if (!strcmp(JsonGetStr(mesh_obj, "MeshType"), "curvilinear"))
-        write_quad_mesh_whole(tiofile_id, state_id, main_obj, TIO_MESH_QUAD_NONCOLINEAR);
-    else if (!strcmp(JsonGetStr(mesh_obj, "MeshType"), "ucdzoo"))
-        write_ucd_mesh_whole(tiofile_id, state_id, main_obj, "ucdzoo");
-    else if (!strcmp(JsonGetStr(mesh_obj, "MeshType"), "arbitrary"))
-        write_ucd_mesh_whole(tiofile_id, state_id, main_obj, "arbitrary");
+    write_mesh_whole(MACSIO_MAIN_Comm, tiofile_id, state_id, main_obj);
 
     TIO_Call( TIO_Close_State(tiofile_id, state_id),
         "State Close Failed\n");
@@ -1777,19 +1139,10 @@ static void main_dump(
         json_object *filecnt = json_object_array_get_idx(parfmode_obj, 1);
 
         if (!strcmp(json_object_get_string(modestr), "SIF")) {
-            float avg_num_parts = json_object_path_get_double(main_obj, "clargs/avg_num_parts");
-            if (avg_num_parts == (float ((int) avg_num_parts))){
-                if (json_object_get_int(filecnt) > 1){
-                    main_dump_msf(main_obj, json_object_get_int(filecnt), dumpn, dumpt);
-                } else {
-                    main_dump_sif(main_obj, dumpn, dumpt);
-                }
-            } else {
-                // CURRENTLY, SIF CAN WORK ONLY ON WHOLE PART COUNTS
-                MACSIO_LOG_MSG(Die, ("TyphonIO plugin cannot currently handle SIF mode where "
-                                     "there are different numbers of parts on each MPI rank. "
-                                     "Set --avg_num_parts to an integral value." ));
-            }
+            if (json_object_get_int(filecnt) > 1)
+                main_dump_msf(main_obj, json_object_get_int(filecnt), dumpn, dumpt);
+            else
+                main_dump_sif(main_obj, dumpn, dumpt);
         }
         else {
             numFiles = json_object_get_int(filecnt);
@@ -1798,15 +1151,8 @@ static void main_dump(
     } else {
         char const * modestr = json_object_path_get_string(main_obj, "clargs/parallel_file_mode");
         if (!strcmp(modestr, "SIF")) {
-            float avg_num_parts = json_object_path_get_double(main_obj, "clargs/avg_num_parts");
-            if (avg_num_parts == (float ((int) avg_num_parts)))
-                main_dump_sif(main_obj, dumpn, dumpt);
-            else {
-                // CURRENTLY, SIF CAN WORK ONLY ON WHOLE PART COUNTS
-                MACSIO_LOG_MSG(Die, ("TyphonIO plugin cannot currently handle SIF mode where "
-                                     "there are different numbers of parts on each MPI rank. "
-                                     "Set --avg_num_parts to an integral value." ));
-            }
+            main_dump_sif(main_obj, dumpn, dumpt);
+            return;
         }
         else if (!strcmp(modestr, "MIFMAX"))
             numFiles = json_object_path_get_int(main_obj, "parallel/mpi_size");
@@ -0,0 +1,808 @@
+/*
+Copyright (c) 2015, Lawrence Livermore National Security, LLC.
+Produced at the Lawrence Livermore National Laboratory.
+
+LLNL-CODE-676051. All rights reserved.
+
+This file is part of MACSio
+
+Please also read the LICENSE file at the top of the source code directory or
+folder hierarchy.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License (as published by the Free Software
+Foundation) version 2, dated June 1991.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the IMPLIED WARRANTY OF MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the terms and conditions of the GNU General
+Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+end-of-copyright-header */
+
+#include <json-cwx/json.h>
+
+#include <macsio_clargs.h>
+#include <macsio_iface.h>
+#include <macsio_log.h>
+#include <macsio_main.h>
+#include <macsio_mif.h>
+#include <macsio_utils.h>
+#include <macsio_timing.h>
+
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+\addtogroup plugins
+@{
+*/
+
+/*!
+\addtogroup URING
+\brief A plugin writing with deep asynchronous I/O queues
+
+Every other plugin issues one write at a time and waits for it. This one keeps up
+to \c --queue_depth writes in flight. The variables of each part are submitted to
+the kernel as one batch. Completions that have arrived are reaped right after each
+submit, and the task waits for more only when the queue is full or the dump is done. With liburing, writes go through an io_uring, optionally with
+registered buffers and a registered (fixed) file. Without it, or when the kernel
+refuses to set up a ring, they go through POSIX AIO.
+
+The time spent submitting each batch and the time from submission to the
+completion of each write are reported per dump, so how much deeper queues help a
+given device or file system client can be seen directly.
+@{
+*/
+
+static char const *iface_name = "uring"; /**< Name of the interface this plugin uses */
+static char const *iface_ext = "dat";    /**< Default file extension for files generated by this plugin */
+static int queue_depth = 32;             /**< Most writes in flight at once */
+static int register_buffers = 0;         /**< Register the variables' buffers with the ring */
+static int fixed_files = 0;              /**< Register the file with the ring */
+static int use_aio = 0;                  /**< Use POSIX AIO even when io_uring is available */
+
+/*! \brief Largest single write, in bytes. Registered buffers can't be larger. */
+#define MAX_WRITE_BYTES (1<<30)
+
+/*!
+\brief Process command-line arguments specific to this plugin
+
+Uses MACSIO_CLARGS_ProcessCmdline() to do its work.
+*/
+static int process_args(
+    int argi,      /**< [in] Argument index of first argument that is specific to this plugin */
+    int argc,      /**< [in] argc as passed into main */
+    char *argv[]   /**< [in] argv as passed into main */
+)
+{
+    const MACSIO_CLARGS_ArgvFlags_t argFlags = {MACSIO_CLARGS_WARN, MACSIO_CLARGS_TOMEM};
+
+    MACSIO_CLARGS_ProcessCmdline(0, argFlags, argi, argc, argv,
+        "--queue_depth %d", "32",
+            "Most writes in flight at once on each task.",
+            &queue_depth,
+        "--register_buffers", "",
+            "Register the variables' buffers with the io_uring before writing them\n"
+            "so the kernel need not map them for every write.",
+            &register_buffers,
+        "--fixed_files", "",
+            "Register each file with the io_uring so writes skip the file table lookup.",
+            &fixed_files,
+        "--aio", "",
+            "Use POSIX AIO even when io_uring is available.",
+            &use_aio,
+           MACSIO_CLARGS_END_OF_ARGS);
+
+    if (queue_depth < 1)
+        MACSIO_LOG_MSG(Die, ("--queue_depth must be at least 1"));
+
+#ifndef HAVE_LIBURING
+    use_aio = 1;
+#endif
+    if (use_aio && (register_buffers || fixed_files))
+        MACSIO_LOG_MSG(Warn, ("--register_buffers and --fixed_files need io_uring. Ignoring them."));
+
+    return 0;
+}
+
+/*! \brief Open a file for writing and return its descriptor in malloc'd memory */
+static void *open_uring_file(
+    char const *fname, /**< [in] Name of the file */
+    int flags)         /**< [in] Flags in addition to O_WRONLY */
+{
+    int *fd = (int *) malloc(sizeof(int));
+
+    *fd = open(fname, O_WRONLY | flags, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    if (*fd < 0)
+        MACSIO_LOG_MSG(Die, ("Unable to open \"%s\": %s", fname, strerror(errno)));
+    return (void *) fd;
+}
+
+/*!
+\brief CreateFile MIF Callback
+
+\return A void pointer to the file's descriptor
+*/
+static void *CreateUringFile(
+    const char *fname,     /**< [in] Name of the MIF file to create */
+    const char *nsname,    /**< [in] Name of the namespace within the file for caller should use. */
+    void *userData         /**< [in] Optional plugin-specific user-defined data */
+)
+{
+    return open_uring_file(fname, O_CREAT|O_TRUNC);
+}
+
+/*!
+\brief OpenFile MIF Callback
+
+\return A void pointer to the file's descriptor
+*/
+static void *OpenUringFile(
+    const char *fname,            /**< [in] Name of the MIF file to open */
+    const char *nsname,           /**< [in] Name of the namespace within the file caller should use */
+    MACSIO_MIF_ioFlags_t ioFlags, /**< [in] Various flags indicating behavior/options */
+    void *userData                /**< [in] Optional plugin-specific user-defined data */
+)
+{
+    return open_uring_file(fname, 0);
+}
+
+/*! \brief CloseFile MIF Callback */
+static int CloseUringFile(
+    void *file,      /**< [in] A void pointer to the file's descriptor */
+    void *userData   /**< [in] Optional plugin specific user-defined data */
+)
+{
+    int retval = close(*((int *) file));
+    free(file);
+    return retval;
+}
+
+/*! \brief One write */
+typedef struct _write_op_t
+{
+    char const *buf;  /**< Bytes to write */
+    size_t len;       /**< Number of bytes */
+    off_t off;        /**< Offset in the file */
+    int slot;         /**< AIO control block in use, or -1 */
+    double t_submit;  /**< Time the batch holding it was submitted */
+} write_op_t;
+
+/*! \brief The writes of all the parts on a task */
+typedef struct _write_list_t
+{
+    write_op_t *ops; /**< The writes in file order */
+    int nops;        /**< Number of writes */
+    int *part_end;   /**< Index in \c ops just past each part's last write */
+    int nparts;      /**< Number of parts */
+    off_t nbytes;    /**< Total number of bytes */
+} write_list_t;
+
+/*! \brief Summary of submission and completion latencies */
+typedef struct _latency_t
+{
+    double submit_sum;   /**< Total time spent submitting batches */
+    double submit_max;   /**< Longest time to submit one batch */
+    double nbatches;     /**< Number of batches */
+    double complete_sum; /**< Total time from submission to completion of each write */
+    double complete_max; /**< Longest time from submission to completion of one write */
+    double nwrites;      /**< Number of writes */
+} latency_t;
+
+/*! \brief A queue of asynchronous writes to one file */
+typedef struct _write_queue_t
+{
+    int fd;                 /**< Descriptor of the file */
+    char const *fileName;   /**< Name of the file */
+    write_list_t *list;     /**< The writes */
+    int nstaged;            /**< Writes queued but not yet submitted */
+    int inflight;           /**< Writes submitted but not yet reaped */
+    int use_ring;           /**< Writes go through an io_uring rather than POSIX AIO */
+    int registered;         /**< Each write's buffer is registered at the index of the write */
+    int fixed;              /**< The file is registered at index 0 */
+#ifdef HAVE_LIBURING
+    struct io_uring ring;   /**< The ring */
+#endif
+    struct aiocb *cbs;      /**< POSIX AIO control blocks, \c queue_depth of them */
+    int *slot_op;           /**< Write using each control block, or -1 */
+    latency_t lat;          /**< Latencies seen so far */
+} write_queue_t;
+
+/*!
+\brief List the writes of every variable of every part on this task
+
+The variables are laid out back to back in part order. Any variable larger
+than \c MAX_WRITE_BYTES is split over several writes.
+*/
+static void make_write_list(
+    json_object *main_obj, /**< [in] The main JSON object */
+    write_list_t *list)    /**< [out] The writes */
+{
+    json_object *parts = json_object_path_get_array(main_obj, "problem/parts");
+    int i, v;
+
+    list->ops = 0;
+    list->nops = 0;
+    list->nparts = json_object_array_length(parts);
+    list->part_end = (int *) malloc((list->nparts + 1) * sizeof(int));
+    list->nbytes = 0;
+    for (i = 0; i < list->nparts; i++)
+    {
+        json_object *vars_array = JsonGetObj(json_object_array_get_idx(parts, i), "Vars");
+        for (v = 0; v < json_object_array_length(vars_array); v++)
+        {
+            json_object *data_obj = JsonGetObj(json_object_array_get_idx(vars_array, v), "data");
+            char const *buf = (char const *) json_object_extarr_data(data_obj);
+            size_t len = json_object_extarr_nvals(data_obj) * MACSIO_UTILS_ExtarrValSize(json_object_extarr_type(data_obj));
+
+            while (len > 0)
+            {
+                write_op_t *op;
+                size_t n = len < MAX_WRITE_BYTES ? len : MAX_WRITE_BYTES;
+                list->ops = (write_op_t *) realloc(list->ops, (list->nops + 1) * sizeof(write_op_t));
+                op = &list->ops[list->nops++];
+                op->buf = buf;
+                op->len = n;
+                op->off = list->nbytes;
+                op->slot = -1;
+                op->t_submit = 0;
+                buf += n;
+                len -= n;
+                list->nbytes += (off_t) n;
+            }
+        }
+        list->part_end[i] = list->nops;
+    }
+}
+
+/*! \brief Free the memory of a write list */
+static void free_write_list(write_list_t *list)
+{
+    free(list->ops);
+    free(list->part_end);
+}
+
+/*!
+\brief Set up a queue of writes to a file
+
+Tries io_uring first unless \c --aio is given and falls back to POSIX AIO if a
+ring can't be set up. Failures to register buffers or the file are warned about
+and those writes proceed without them.
+*/
+static void queue_init(
+    write_queue_t *q,     /**< [out] The queue */
+    int fd,               /**< [in] Descriptor of the file */
+    char const *fileName, /**< [in] Name of the file */
+    write_list_t *list,   /**< [in] The writes, with offsets relative to \c base */
+    off_t base,           /**< [in] Offset of this task's range in the file */
+    int dumpn)            /**< [in] The number/index of this dump */
+{
+    int i;
+
+    memset(q, 0, sizeof(*q));
+    q->fd = fd;
+    q->fileName = fileName;
+    q->list = list;
+    for (i = 0; i < list->nops; i++)
+        list->ops[i].off += base;
+
+#ifdef HAVE_LIBURING
+    if (!use_aio)
+    {
+        static int warned = 0;
+        int err = io_uring_queue_init((unsigned) queue_depth, &q->ring, 0);
+
+        if (err < 0)
+        {
+            if (!warned++)
+                MACSIO_LOG_MSG(Warn, ("Unable to set up an io_uring (%s). Using POSIX AIO.", strerror(-err)));
+        }
+        else
+            q->use_ring = 1;
+    }
+
+    if (q->use_ring && register_buffers && list->nops)
+    {
+        MACSIO_TIMING_TimerId_t tid = MT_StartTimer("register", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+        struct iovec *iov = (struct iovec *) malloc(list->nops * sizeof(struct iovec));
+        int err;
+
+        for (i = 0; i < list->nops; i++)
+        {
+            iov[i].iov_base = (void *) list->ops[i].buf;
+            iov[i].iov_len = list->ops[i].len;
+        }
+        err = io_uring_register_buffers(&q->ring, iov, (unsigned) list->nops);
+        if (err < 0)
+            MACSIO_LOG_MSG(Warn, ("Unable to register %d buffers (%s)", list->nops, strerror(-err)));
+        else
+            q->registered = 1;
+        free(iov);
+        MT_StopTimer(tid);
+    }
+
+    if (q->use_ring && fixed_files)
+    {
+        int err = io_uring_register_files(&q->ring, &fd, 1);
+        if (err < 0)
+            MACSIO_LOG_MSG(Warn, ("Unable to register \"%s\" (%s)", fileName, strerror(-err)));
+        else
+            q->fixed = 1;
+    }
+#endif
+
+    if (!q->use_ring)
+    {
+        q->cbs = (struct aiocb *) calloc(queue_depth, sizeof(struct aiocb));
+        q->slot_op = (int *) malloc(queue_depth * sizeof(int));
+        for (i = 0; i < queue_depth; i++)
+            q->slot_op[i] = -1;
+    }
+}
+
+/*! \brief Finish a write that completed with \c res bytes written */
+static void complete_write(
+    write_queue_t *q, /**< [in] The queue */
+    write_op_t *op,   /**< [in] The write */
+    ssize_t res,      /**< [in] Bytes written or, if negative, the error number */
+    double now)       /**< [in] Time it was reaped */
+{
+    double dt = now - op->t_submit;
+
+    if (res < 0)
+        MACSIO_LOG_MSG(Die, ("Write to \"%s\" failed: %s", q->fileName, strerror((int) -res)));
+
+    /* Rare, but legal. Write the rest synchronously. */
+    if ((size_t) res < op->len)
+        if (MACSIO_UTILS_PwriteAll(q->fd, op->buf + res, op->len - (size_t) res, op->off + res) != 0)
+            MACSIO_LOG_MSG(Die, ("pwrite to \"%s\" failed: %s", q->fileName, strerror(errno)));
+
+    q->lat.complete_sum += dt;
+    if (dt > q->lat.complete_max)
+        q->lat.complete_max = dt;
+    q->lat.nwrites++;
+    q->inflight--;
+}
+
+/*! \brief Queue write \c i without submitting it */
+static void queue_push(
+    write_queue_t *q, /**< [in] The queue */
+    int i)            /**< [in] Index of the write */
+{
+    write_op_t *op = &q->list->ops[i];
+
+#ifdef HAVE_LIBURING
+    if (q->use_ring)
+    {
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&q->ring);
+        int fdarg = q->fixed ? 0 : q->fd;
+
+        if (q->registered)
+            io_uring_prep_write_fixed(sqe, fdarg, op->buf, (unsigned) op->len, (__u64) op->off, i);
+        else
+            io_uring_prep_write(sqe, fdarg, op->buf, (unsigned) op->len, (__u64) op->off);
+        if (q->fixed)
+            io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+        io_uring_sqe_set_data(sqe, (void *) op);
+    }
+    else
+#endif
+    {
+        int s = 0;
+        while (q->slot_op[s] >= 0)
+            s++;
+        q->slot_op[s] = i;
+        op->slot = s;
+        memset(&q->cbs[s], 0, sizeof(struct aiocb));
+        q->cbs[s].aio_fildes = q->fd;
+        q->cbs[s].aio_buf = (void *) op->buf;
+        q->cbs[s].aio_nbytes = op->len;
+        q->cbs[s].aio_offset = op->off;
+    }
+    q->nstaged++;
+}
+
+/*!
+\brief Submit every staged write as one batch
+
+With io_uring, this is one \c io_uring_submit call. With POSIX AIO, it is one
+\c aio_write per write. A write AIO refuses is done synchronously instead.
+*/
+static void queue_submit(
+    write_queue_t *q,  /**< [in] The queue */
+    int first,         /**< [in] Index of the first staged write */
+    int dumpn)         /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_TimerId_t tid;
+    double t0, dt;
+    int i;
+
+    if (q->nstaged == 0)
+        return;
+
+    tid = MT_StartTimer("submit", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+    t0 = MT_Time();
+#ifdef HAVE_LIBURING
+    if (q->use_ring)
+    {
+        int n = io_uring_submit(&q->ring);
+        if (n < 0)
+            MACSIO_LOG_MSG(Die, ("io_uring_submit failed: %s", strerror(-n)));
+    }
+    else
+#endif
+    {
+        for (i = first; i < first + q->nstaged; i++)
+        {
+            write_op_t *op = &q->list->ops[i];
+            if (aio_write(&q->cbs[op->slot]) != 0)
+            {
+                static int warned = 0;
+                if (!warned++)
+                    MACSIO_LOG_MSG(Warn, ("aio_write failed (%s). Writing synchronously.", strerror(errno)));
+                if (MACSIO_UTILS_PwriteAll(q->fd, op->buf, op->len, op->off) != 0)
+                    MACSIO_LOG_MSG(Die, ("pwrite to \"%s\" failed: %s", q->fileName, strerror(errno)));
+                q->slot_op[op->slot] = -1;
+                op->slot = -1;
+            }
+        }
+    }
+    dt = MT_Time() - t0;
+    MT_StopTimer(tid);
+
+    for (i = first; i < first + q->nstaged; i++)
+    {
+        write_op_t *op = &q->list->ops[i];
+        op->t_submit = t0;
+        q->inflight++;
+        if (!q->use_ring && op->slot < 0)
+            complete_write(q, op, (ssize_t) op->len, t0 + dt);
+    }
+    q->lat.submit_sum += dt;
+    if (dt > q->lat.submit_max)
+        q->lat.submit_max = dt;
+    q->lat.nbatches++;
+    q->nstaged = 0;
+}
+
+/*!
+\brief Reap all submitted writes that have completed
+
+With \c wait, first wait for at least one to complete. Without it, return at once
+if none has. Polling after each submit stamps completions close to when they
+arrive rather than when the queue next fills up.
+*/
+static void queue_reap(
+    write_queue_t *q, /**< [in] The queue */
+    int wait,         /**< [in] Whether to wait for at least one write to complete */
+    int dumpn)        /**< [in] The number/index of this dump */
+{
+    MACSIO_TIMING_TimerId_t tid;
+    int s;
+
+    if (!q->inflight)
+        return;
+
+    tid = MT_StartTimer("reap", MACSIO_TIMING_GroupMask("main_dump"), dumpn);
+#ifdef HAVE_LIBURING
+    if (q->use_ring)
+    {
+        struct io_uring_cqe *cqe;
+        int err = wait ? io_uring_wait_cqe(&q->ring, &cqe) : io_uring_peek_cqe(&q->ring, &cqe);
+
+        while (wait && err == -EINTR)
+            err = io_uring_wait_cqe(&q->ring, &cqe);
+        if (!wait && err == -EAGAIN)
+        {
+            MT_StopTimer(tid);
+            return;
+        }
+        if (err < 0)
+            MACSIO_LOG_MSG(Die, ("Reaping io_uring completions failed: %s", strerror(-err)));
+        do
+        {
+            complete_write(q, (write_op_t *) io_uring_cqe_get_data(cqe), (ssize_t) cqe->res, MT_Time());
+            io_uring_cqe_seen(&q->ring, cqe);
+        } while (q->inflight && io_uring_peek_cqe(&q->ring, &cqe) == 0);
+    }
+    else
+#endif
+    {
+        if (wait)
+        {
+            struct aiocb const **pending = (struct aiocb const **) malloc(queue_depth * sizeof(struct aiocb *));
+            int n = 0;
+
+            for (s = 0; s < queue_depth; s++)
+                if (q->slot_op[s] >= 0)
+                    pending[n++] = &q->cbs[s];
+            while (aio_suspend(pending, n, 0) != 0 && errno == EINTR)
+                ;
+            free(pending);
+        }
+
+        for (s = 0; s < queue_depth; s++)
+        {
+            int err;
+            ssize_t res;
+            if (q->slot_op[s] < 0 || (err = aio_error(&q->cbs[s])) == EINPROGRESS)
+                continue;
+            /* aio_return releases the control block's resources, even on failure */
+            res = aio_return(&q->cbs[s]);
+            complete_write(q, &q->list->ops[q->slot_op[s]], err ? -err : res, MT_Time());
+            q->list->ops[q->slot_op[s]].slot = -1;
+            q->slot_op[s] = -1;
+        }
+    }
+
+    MT_StopTimer(tid);
+}
+
+/*! \brief Release the ring or control blocks of a queue once it is drained */
+static void queue_finish(write_queue_t *q)
+{
+#ifdef HAVE_LIBURING
+    if (q->use_ring)
+    {
+        if (q->registered)
+            io_uring_unregister_buffers(&q->ring);
+        if (q->fixed)
+            io_uring_unregister_files(&q->ring);
+        io_uring_queue_exit(&q->ring);
+    }
+#endif
+    free(q->cbs);
+    free(q->slot_op);
+}
+
+/*!
+\brief Write a task's variables to its range of a file
+
+Each part's writes are queued and then submitted as one batch, after which any
+completed writes are reaped. If the queue fills up part way through a part, what
+is queued so far is submitted and writes are reaped until there is room. All
+writes have completed on return.
+
+\return Non-zero if the writes went through an io_uring
+*/
+static int write_all_parts(
+    int fd,               /**< [in] Descriptor of the file */
+    char const *fileName, /**< [in] Name of the file */
+    write_list_t *list,   /**< [in] The task's writes */
+    off_t base,           /**< [in] Offset of the task's range in the file */
+    int dumpn,            /**< [in] The number/index of this dump */
+    latency_t *lat)       /**< [out] The latencies seen */
+{
+    write_queue_t q;
+    int i, p, first = 0;
+
+    queue_init(&q, fd, fileName, list, base, dumpn);
+
+    for (p = 0, i = 0; p < list->nparts; p++)
+    {
+        for (; i < list->part_end[p]; i++)
+        {
+            if (q.nstaged + q.inflight == queue_depth)
+            {
+                queue_submit(&q, first, dumpn);
+                first = i;
+                queue_reap(&q, 1, dumpn);
+            }
+            queue_push(&q, i);
+        }
+        queue_submit(&q, first, dumpn);
+        first = i;
+        queue_reap(&q, 0, dumpn);
+    }
+    while (q.inflight)
+        queue_reap(&q, 1, dumpn);
+
+    *lat = q.lat;
+    queue_finish(&q);
+    return q.use_ring;
+}
+
+/*! \brief Log the mean and worst submission and completion latencies over all tasks */
+static void report_latency(
+    latency_t const *lat, /**< [in] This task's latencies */
+    int use_ring,         /**< [in] Whether the writes went through io_uring */
+    int dumpn)            /**< [in] The number/index of this dump */
+{
+    double sums[4] = {lat->submit_sum, lat->nbatches, lat->complete_sum, lat->nwrites};
+    double maxs[2] = {lat->submit_max, lat->complete_max};
+    char s1[32], s2[32], s3[32], s4[32];
+
+#ifdef HAVE_MPI
+    MPI_Reduce(MACSIO_MAIN_Rank ? sums : MPI_IN_PLACE, sums, 4, MPI_DOUBLE, MPI_SUM, 0, MACSIO_MAIN_Comm);
+    MPI_Reduce(MACSIO_MAIN_Rank ? maxs : MPI_IN_PLACE, maxs, 2, MPI_DOUBLE, MPI_MAX, 0, MACSIO_MAIN_Comm);
+    if (MACSIO_MAIN_Rank)
+        return;
+#endif
+
+    MACSIO_LOG_MSG(Info, ("Dump %02d %s, queue depth %d: submit mean %s max %s per batch, "
+        "complete mean %s max %s per write", dumpn, use_ring ? "io_uring" : "POSIX AIO", queue_depth,
+        MACSIO_UTILS_PrintSeconds(sums[1] ? sums[0]/sums[1] : 0, "%.3f", s1, sizeof(s1)),
+        MACSIO_UTILS_PrintSeconds(maxs[0], "%.3f", s2, sizeof(s2)),
+        MACSIO_UTILS_PrintSeconds(sums[3] ? sums[2]/sums[3] : 0, "%.3f", s3, sizeof(s3)),
+        MACSIO_UTILS_PrintSeconds(maxs[1], "%.3f", s4, sizeof(s4))));
+}
+
+/*!
+\brief Main dump implementation for this plugin
+
+Lists this task's writes and writes them to a MIF or SIF file. In SIF mode, all
+tasks write one shared file at offsets given by an \c MPI_Exscan. In MIF mode,
+the tasks of a group take turns appending to their file under the baton, each
+draining its queue before passing the baton on.
+*/
+static void main_dump(
+    int argi,               /**< [in] Command-line argument index at which first plugin-specific arg appears */
+    int argc,               /**< [in] argc from main */
+    char **argv,            /**< [in] argv from main */
+    json_object *main_obj,  /**< [in] The main json object representing all data to be dumped */
+    int dumpn,              /**< [in] The number/index of this dump */
+    double dumpt            /**< [in] The time to be associated with this dump (like a simulation's time) */
+)
+{
+    int rank, size, numFiles, use_sif = 0, used_ring;
+    char fileName[256];
+    write_list_t list;
+    latency_t lat;
+    off_t base;
+
+    /* process cl args */
+    process_args(argi, argc, argv);
+
+    rank = JsonGetInt(main_obj, "parallel/mpi_rank");
+    size = JsonGetInt(main_obj, "parallel/mpi_size");
+
+    /* determine the file mode and, for MIF, the file count */
+    json_object *parfmode_obj = JsonGetObj(main_obj, "clargs/parallel_file_mode");
+    if (parfmode_obj)
+    {
+        json_object *modestr = json_object_array_get_idx(parfmode_obj, 0);
+        json_object *filecnt = json_object_array_get_idx(parfmode_obj, 1);
+        if (modestr && !strcmp(json_object_get_string(modestr), "SIF"))
+            use_sif = 1;
+        numFiles = filecnt ? json_object_get_int(filecnt) : size;
+    }
+    else
+    {
+        char const * modestr = JsonGetStr(main_obj, "clargs/parallel_file_mode");
+        if (!strcmp(modestr, "SIF"))
+            use_sif = 1;
+        numFiles = size;
+    }
+
+    make_write_list(main_obj, &list);
+
+    if (use_sif)
+    {
+        MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE, 0};
+        int *fd = 0;
+
+        sprintf(fileName, "%s_uring_%03d.%s",
+            JsonGetStr(main_obj, "clargs/filebase"), dumpn, iface_ext);
+        MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
+
+        base = 0;
+#ifdef HAVE_MPI
+        base = (off_t) MACSIO_UTILS_ExscanOffset((long long) list.nbytes, MACSIO_MAIN_Comm);
+#endif
+
+        /* Rank 0 creates (truncates) the file before anyone else opens it */
+        if (rank == 0)
+            fd = (int *) CreateUringFile(fileName, 0, 0);
+#ifdef HAVE_MPI
+        MPI_Barrier(MACSIO_MAIN_Comm);
+#endif
+        if (rank != 0)
+            fd = (int *) OpenUringFile(fileName, 0, ioFlags, 0);
+        used_ring = write_all_parts(*fd, fileName, &list, base, dumpn, &lat);
+        CloseUringFile(fd, 0);
+    }
+    else
+    {
+        MACSIO_MIF_ioFlags_t ioFlags = {MACSIO_MIF_WRITE,(unsigned int) JsonGetInt(main_obj,"clargs/exercise_scr")&0x1};
+        MACSIO_MIF_baton_t *bat;
+        struct stat st;
+        int *fd;
+
+        if (numFiles < 1 || numFiles > size)
+        {
+            MACSIO_LOG_MSG(Warn, ("Using %d files instead of %d", size, numFiles));
+            numFiles = size;
+        }
+
+        bat = MACSIO_MIF_Init(numFiles, ioFlags, MACSIO_MAIN_Comm, 8,
+            CreateUringFile, OpenUringFile, CloseUringFile, 0);
+
+        MACSIO_MIF_SetBatonOrder(bat, MACSIO_MIF_ORDER_DEFAULT,
+            (unsigned long long) list.nbytes);
+
+        sprintf(fileName, "%s_uring_%05d_%03d.%s",
+            JsonGetStr(main_obj, "clargs/filebase"),
+            MACSIO_MIF_RankOfGroup(bat, rank), dumpn, iface_ext);
+        MACSIO_UTILS_RecordOutputFiles(dumpn, fileName);
+
+        fd = (int *) MACSIO_MIF_WaitForBaton(bat, fileName, 0);
+
+        if (fstat(*fd, &st) != 0)
+            MACSIO_LOG_MSG(Die, ("Unable to stat \"%s\": %s", fileName, strerror(errno)));
+        base = st.st_size;
+        used_ring = write_all_parts(*fd, fileName, &list, base, dumpn, &lat);
+
+        MACSIO_MIF_HandOffBaton(bat, fd);
+        MACSIO_MIF_Finish(bat);
+    }
+
+    report_latency(&lat, used_ring, dumpn);
+
+    free_write_list(&list);
+}
+
+/*!
+\brief Method to register this plugin with MACSio main
+
+Due to its use to initialize a file-scope, static const variable, this
+function winds up being called at load time (e.g. before main is even called).
+
+Its purpose is to add key information about this plugin to MACSio's global
+interface table.
+*/
+static int register_this_interface()
+{
+    MACSIO_IFACE_Handle_t iface;
+
+    if (strlen(iface_name) >= MACSIO_IFACE_MAX_NAME)
+        MACSIO_LOG_MSG(Die, ("Interface name \"%s\" too long", iface_name));
+
+    /* Populate information about this plugin */
+    strcpy(iface.name, iface_name);
+    strcpy(iface.ext, iface_ext);
+    iface.dumpFunc = main_dump;
+    iface.processArgsFunc = process_args;
+
+    /* Register this plugin */
+    if (!MACSIO_IFACE_Register(&iface))
+        MACSIO_LOG_MSG(Die, ("Failed to register interface \"%s\"", iface_name));
+
+    return 0;
+}
+
+/*!
+\brief Dummy initializer to trigger register_this_interface by the loader
+
+This one statement is the only statement requiring compilation by
+a C++ compiler. That is because it involves initialization and non
+constant expressions (a function call in this case). This function
+call is guaranteed to occur during *initialization* (that is before
+even 'main' is called) and so will have the effect of populating the
+iface_map array merely by virtue of the fact that this code is linked
+with a main.
+*/
+static int const dummy = register_this_interface();
+
+/*!@}*/
+
+/*!@}*/